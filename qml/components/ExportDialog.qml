@@ -12,6 +12,11 @@ Dialog {
     width: 450
 
     property bool isExporting: Exporter.exporting
+    property bool imageSequence: formatBox.currentIndex > 0
+
+    function formatLabel(format) {
+        return format === "mp4" ? qsTr("MP4 video") : qsTr("%1 image sequence").arg(format.toUpperCase())
+    }
 
     ColumnLayout {
         anchors.fill: parent
@@ -61,9 +66,130 @@ Dialog {
             }
         }
 
+        // Video or numbered stills
+        GroupBox {
+            title: qsTr("Format")
+            Layout.fillWidth: true
+
+            RowLayout {
+                anchors.fill: parent
+                spacing: Theme.spacingNormal
+
+                ComboBox {
+                    id: formatBox
+                    model: ["mp4"].concat(Exporter.imageFormats)
+                    displayText: formatLabel(currentText)
+                    enabled: !isExporting
+                    Layout.fillWidth: true
+
+                    delegate: ItemDelegate {
+                        width: formatBox.width
+                        text: formatLabel(modelData)
+                    }
+
+                    // A sequence is written into a folder next to where the video would go
+                    onActivated: {
+                        outputPath.text = imageSequence ? outputPath.text.replace(/\.mp4$/, "_frames")
+                                                        : outputPath.text.replace(/_frames$/, ".mp4")
+                    }
+                }
+                Label {
+                    text: qsTr("Compression")
+                    visible: formatBox.currentText === "png"
+                }
+                SpinBox {
+                    from: 0
+                    to: 9
+                    value: Exporter.imageCompression
+                    visible: formatBox.currentText === "png"
+                    enabled: !isExporting
+                    onValueModified: Exporter.imageCompression = value
+                }
+            }
+        }
+
+        // Parallel encoding
+        GroupBox {
+            title: qsTr("Encoding")
+            Layout.fillWidth: true
+            visible: !imageSequence
+
+            RowLayout {
+                anchors.fill: parent
+                spacing: Theme.spacingNormal
+
+                Label {
+                    text: qsTr("Parallel segments")
+                    Layout.fillWidth: true
+                }
+                SpinBox {
+                    from: 1
+                    to: 16
+                    value: Exporter.segmentCount
+                    enabled: !isExporting
+                    onValueModified: Exporter.segmentCount = value
+                }
+                CheckBox {
+                    text: qsTr("Resumable")
+                    checked: Exporter.resumable
+                    enabled: !isExporting
+                    onToggled: Exporter.resumable = checked
+                }
+                CheckBox {
+                    text: qsTr("Incremental")
+                    checked: Exporter.incremental
+                    enabled: !isExporting
+                    onToggled: Exporter.incremental = checked
+                }
+                CheckBox {
+                    text: qsTr("Keep parts")
+                    checked: Exporter.keepParts
+                    enabled: !isExporting && Exporter.incremental
+                    onToggled: Exporter.keepParts = checked
+                    ToolTip.visible: hovered
+                    ToolTip.text: qsTr("Keep encoded segments next to the video so the next export can reuse them")
+                }
+            }
+        }
+
+        // Motion blur
+        GroupBox {
+            title: qsTr("Motion Blur")
+            Layout.fillWidth: true
+
+            RowLayout {
+                anchors.fill: parent
+                spacing: Theme.spacingNormal
+
+                Label {
+                    text: qsTr("Samples per frame")
+                    Layout.fillWidth: true
+                }
+                SpinBox {
+                    from: 1
+                    to: 32
+                    value: Exporter.motionBlurSamples
+                    enabled: !isExporting
+                    onValueModified: Exporter.motionBlurSamples = value
+                }
+                Label {
+                    text: qsTr("Shutter")
+                }
+                SpinBox {
+                    from: 0
+                    to: 360
+                    stepSize: 45
+                    value: Exporter.shutterAngle
+                    enabled: !isExporting && Exporter.motionBlurSamples > 1
+                    textFromValue: function(value) { return value + "°" }
+                    onValueModified: Exporter.shutterAngle = value
+                }
+            }
+        }
+
         // Output path
         GroupBox {
-            title: qsTr("Output File")
+            title: imageSequence ? qsTr("Output Folder") : qsTr("Output File")
             Layout.fillWidth: true
 
             RowLayout {
@@ -78,7 +204,7 @@ Dialog {
 
                 Button {
                     text: qsTr("Browse...")
-                    onClicked: saveDialog.open()
+                    onClicked: imageSequence ? folderDialog.open() : saveDialog.open()
                 }
             }
         }
@@ -142,12 +268,22 @@ Dialog {
         onAccepted: outputPath.text = selectedFile.toString().replace("file:///", "")
     }
 
+    FolderDialog {
+        id: folderDialog
+        title: qsTr("Export Frames To")
+        onAccepted: outputPath.text = selectedFolder.toString().replace("file:///", "")
+    }
+
     function startExport() {
         let fps = fps24.checked ? 24 : (fps60.checked ? 60 : 30)
         let width = 1920
         let height = 1080
 
-        Exporter.startExport(outputPath.text, width, height, fps)
+        if (imageSequence) {
+            Exporter.startImageSequenceExport(outputPath.text, width, height, fps, formatBox.currentText)
+        } else {
+            Exporter.startExport(outputPath.text, width, height, fps)
+        }
     }
 
     Connections {
@@ -169,7 +305,7 @@ Dialog {
         anchors.centerIn: parent
 
         Label {
-            text: qsTr("Video exported successfully!")
+            text: imageSequence ? qsTr("Frames exported successfully!") : qsTr("Video exported successfully!")
         }
 
         standardButtons: Dialog.Ok
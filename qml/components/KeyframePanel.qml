@@ -27,6 +27,7 @@ Rectangle {
                 tiltSlider.value = kf.tilt
                 timeSpinBox.value = kf.time / 1000.0
                 easingSlider.value = kf.easing !== undefined ? kf.easing : 0.5
+                transitionCombo.currentIndex = kf.transition !== undefined ? kf.transition : 0
             }
         }
     }
@@ -288,6 +289,24 @@ Rectangle {
                                 font.pixelSize: 9
                             }
                         }
+
+                        RowLayout {
+                            Layout.fillWidth: true
+                            Text {
+                                text: qsTr("Flight")
+                                color: Theme.textColorDim
+                                font.pixelSize: 10
+                            }
+                            ComboBox {
+                                id: transitionCombo
+                                Layout.fillWidth: true
+                                // Order matches Keyframe::Transition
+                                model: [qsTr("Direct"), qsTr("Zoom out and pan")]
+                                onActivated: function(index) {
+                                    Keyframes.updateKeyframe(selectedIndex, {"transition": index})
+                                }
+                            }
+                        }
                     }
                 }
 
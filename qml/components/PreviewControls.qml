@@ -179,6 +179,35 @@ Rectangle {
             }
         }
 
+        // Camera path between keyframes
+        Text {
+            text: qsTr("Path")
+            color: Theme.textColorDim
+            font.pixelSize: 10
+        }
+
+        Rectangle {
+            width: pathCombo.width + 8
+            height: 28
+            radius: 4
+            color: Theme.surfaceColor
+            border.color: Theme.borderColor
+
+            ComboBox {
+                id: pathCombo
+                anchors.centerIn: parent
+                model: [qsTr("Linear"), qsTr("Spline"), qsTr("Spline, even speed")]
+                currentIndex: AnimController.pathMode === 0 ? 0 : (AnimController.constantSpeed ? 2 : 1)
+                implicitWidth: 130
+                flat: true
+
+                onActivated: function(index) {
+                    AnimController.pathMode = index === 0 ? 0 : 1
+                    AnimController.constantSpeed = index === 2
+                }
+            }
+        }
+
         Rectangle {
             width: 1
             height: 20
@@ -0,0 +1,144 @@
+#include "arrowgeometry.h"
+#include <QtMath>
+#include <QByteArray>
+#include <algorithm>
+
+ArrowGeometry::ArrowGeometry(QQuick3DObject* parent)
+    : QQuick3DGeometry(parent)
+{
+}
+
+void ArrowGeometry::setArrow(ArrowOverlay* arrow) {
+    if (m_arrow == arrow) return;
+    if (m_arrow) disconnect(m_arrow, nullptr, this, nullptr);
+    m_arrow = arrow;
+    if (m_arrow) {
+        connect(m_arrow, &ArrowOverlay::pathChanged, this, [this]() {
+            rebuildPath();
+            updateGeometry();
+        });
+        // QPointer clears itself; drop the route drawn from the old arrow too
+        connect(m_arrow, &QObject::destroyed, this, [this]() {
+            rebuildPath();
+            updateGeometry();
+            emit arrowChanged();
+        });
+    }
+    emit arrowChanged();
+    rebuildPath();
+    updateGeometry();
+}
+
+void ArrowGeometry::setGlobeRadius(float radius) {
+    if (qFuzzyCompare(m_globeRadius, radius)) return;
+    m_globeRadius = radius;
+    emit globeRadiusChanged();
+    updateGeometry();
+}
+
+void ArrowGeometry::setAltitude(float altitude) {
+    altitude = qMax(0.0f, altitude);
+    if (qFuzzyCompare(m_altitude, altitude)) return;
+    m_altitude = altitude;
+    emit altitudeChanged();
+    updateGeometry();
+}
+
+void ArrowGeometry::setProgress(double progress) {
+    progress = qBound(0.0, progress, 1.0);
+    if (qFuzzyCompare(m_progress, progress)) return;
+    m_progress = progress;
+    emit progressChanged();
+    updateGeometry();
+}
+
+QVector3D ArrowGeometry::latLonToPosition(double lat, double lon) const {
+    // Same axes as GlobeGeometry and CountryGeometry
+    double latRad = qDegreesToRadians(lat);
+    double lonRad = qDegreesToRadians(lon);
+
+    return QVector3D(qCos(latRad) * qSin(lonRad), qSin(latRad), qCos(latRad) * qCos(lonRad));
+}
+
+void ArrowGeometry::flatten(double t0, const QVector3D& p0, double t1, const QVector3D& p1, int depth) {
+    // Split while the route's midpoint sags away from the chord
+    const double tm = (t0 + t1) / 2.0;
+    const QPointF geo = m_arrow->pointAtT(tm);
+    const QVector3D pm = latLonToPosition(geo.x(), geo.y());
+
+    if (depth < FLATTEN_MAX_DEPTH && (pm - (p0 + p1) / 2.0f).length() > FLATTEN_TOLERANCE) {
+        flatten(t0, p0, tm, pm, depth + 1);
+        flatten(tm, pm, t1, p1, depth + 1);
+        return;
+    }
+    m_points.append(p1);
+}
+
+void ArrowGeometry::rebuildPath() {
+    m_points.clear();
+    m_lengths.clear();
+    if (!m_arrow) return;
+
+    // Flattened once per shape; radius, altitude and progress only rescale
+    // and trim it
+    QPointF geo = m_arrow->pointAtT(0.0);
+    QVector3D previous = latLonToPosition(geo.x(), geo.y());
+    m_points.append(previous);
+    for (int i = 1; i <= FLATTEN_SEGMENTS; ++i) {
+        const double t = static_cast<double>(i) / FLATTEN_SEGMENTS;
+        geo = m_arrow->pointAtT(t);
+        const QVector3D next = latLonToPosition(geo.x(), geo.y());
+        flatten(static_cast<double>(i - 1) / FLATTEN_SEGMENTS, previous, t, next, 0);
+        previous = next;
+    }
+
+    m_lengths.reserve(m_points.size());
+    m_lengths.append(0.0);
+    for (int i = 1; i < m_points.size(); ++i) {
+        m_lengths.append(m_lengths.last() + (m_points[i] - m_points[i - 1]).length());
+    }
+}
+
+void ArrowGeometry::updateGeometry() {
+    clear();
+
+    if (m_points.size() < 2 || m_progress <= 0.0) {
+        update();
+        return;
+    }
+
+    // Whole vertices up to the revealed length, then the point inside the
+    // segment it ends in
+    const double reveal = m_progress * m_lengths.last();
+    QVector<QVector3D> strip;
+    strip.append(m_points.first());
+    for (int i = 1; i < m_points.size(); ++i) {
+        if (m_lengths[i] >= reveal) {
+            const double segment = m_lengths[i] - m_lengths[i - 1];
+            const float f = segment > 0.0 ? static_cast<float>((reveal - m_lengths[i - 1]) / segment) : 0.0f;
+            strip.append((m_points[i - 1] + (m_points[i] - m_points[i - 1]) * f).normalized());
+            break;
+        }
+        strip.append(m_points[i]);
+    }
+
+    const float radius = m_globeRadius + m_altitude;
+    QVector<float> vertexData;
+    vertexData.reserve(strip.size() * 3);
+    for (const QVector3D& p : strip) {
+        vertexData.append(p.x() * radius);
+        vertexData.append(p.y() * radius);
+        vertexData.append(p.z() * radius);
+    }
+
+    setStride(3 * sizeof(float));
+    setVertexData(QByteArray(reinterpret_cast<const char*>(vertexData.data()),
+                             vertexData.size() * sizeof(float)));
+    setPrimitiveType(QQuick3DGeometry::PrimitiveType::LineStrip);
+    setBounds(QVector3D(-radius, -radius, -radius), QVector3D(radius, radius, radius));
+
+    addAttribute(QQuick3DGeometry::Attribute::PositionSemantic,
+                 0, QQuick3DGeometry::Attribute::F32Type);
+
+    update();
+}
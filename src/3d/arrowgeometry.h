@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QQuick3DGeometry>
+#include <QVector3D>
+#include <QPointer>
+#include "../overlays/arrowoverlay.h"
+
+// An ArrowOverlay's route as a line strip on the globe. Points come from
+// ArrowOverlay::pointAtT, so great-circle and rhumb arrows follow the same
+// path as on the 2D map; on the sphere the antimeridian is just another
+// meridian and needs no splitting.
+class ArrowGeometry : public QQuick3DGeometry {
+    Q_OBJECT
+
+    Q_PROPERTY(ArrowOverlay* arrow READ arrow WRITE setArrow NOTIFY arrowChanged)
+    Q_PROPERTY(float globeRadius READ globeRadius WRITE setGlobeRadius NOTIFY globeRadiusChanged)
+    Q_PROPERTY(float altitude READ altitude WRITE setAltitude NOTIFY altitudeChanged)
+    Q_PROPERTY(double progress READ progress WRITE setProgress NOTIFY progressChanged)
+
+public:
+    explicit ArrowGeometry(QQuick3DObject* parent = nullptr);
+
+    ArrowOverlay* arrow() const { return m_arrow; }
+    void setArrow(ArrowOverlay* arrow);
+
+    float globeRadius() const { return m_globeRadius; }
+    void setGlobeRadius(float radius);
+
+    // Height of the line above the surface, so it doesn't z-fight the globe
+    float altitude() const { return m_altitude; }
+    void setAltitude(float altitude);
+
+    // Revealed fraction of the route's length (0.0 to 1.0)
+    double progress() const { return m_progress; }
+    void setProgress(double progress);
+
+signals:
+    void arrowChanged();
+    void globeRadiusChanged();
+    void altitudeChanged();
+    void progressChanged();
+
+private:
+    void rebuildPath();
+    void updateGeometry();
+    void flatten(double t0, const QVector3D& p0, double t1, const QVector3D& p1, int depth);
+
+    // Convert lat/lon to a point on the unit sphere
+    QVector3D latLonToPosition(double lat, double lon) const;
+
+    QPointer<ArrowOverlay> m_arrow;
+    float m_globeRadius = 100.0f;
+    float m_altitude = 0.5f;
+    double m_progress = 1.0;
+
+    // Route on the unit sphere with the arc length up to each vertex
+    QVector<QVector3D> m_points;
+    QVector<double> m_lengths;
+
+    static constexpr int FLATTEN_SEGMENTS = 8;
+    static constexpr int FLATTEN_MAX_DEPTH = 8;
+    static constexpr double FLATTEN_TOLERANCE = 0.0005;  // Chord sag on the unit sphere
+};
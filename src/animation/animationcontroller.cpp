@@ -1,14 +1,19 @@
 #include "animationcontroller.h"
 #include "keyframemodel.h"
 #include "interpolator.h"
+#include "geooverlaymodel.h"
 #include "../map/mapcamera.h"
+#include <QQuickWindow>
+#include <QScreen>
 #include <algorithm>
+#include <cmath>
 
 AnimationController::AnimationController(QObject* parent)
     : QObject(parent)
     , m_interpolator(new Interpolator(this))
     , m_timer(new QTimer(this))
 {
+    m_clock.start();
     m_timer->setInterval(TICK_INTERVAL_MS);
     connect(m_timer, &QTimer::timeout, this, &AnimationController::tick);
 
@@ -17,6 +22,11 @@ AnimationController::AnimationController(QObject* parent)
 
     // Set interpolator to linear mode since speed curve is enabled by default
     m_interpolator->setLinearMode(m_useSpeedCurve);
+
+    connect(this, &AnimationController::speedCurveChanged, this, &AnimationController::rebuildSpeedTable);
+    connect(this, &AnimationController::useSpeedCurveChanged, this, &AnimationController::rebuildSpeedTable);
+    connect(this, &AnimationController::totalDurationChanged, this, &AnimationController::rebuildSpeedTable);
+    rebuildSpeedTable();
 }
 
 void AnimationController::setKeyframeModel(KeyframeModel* model) {
@@ -27,7 +37,11 @@ void AnimationController::setKeyframeModel(KeyframeModel* model) {
     if (m_keyframes) {
         connect(m_keyframes, &KeyframeModel::totalDurationChanged,
                 this, &AnimationController::totalDurationChanged);
+        connect(m_keyframes, &KeyframeModel::dataModified, this, &AnimationController::invalidateCameraPath);
+        connect(m_keyframes, &KeyframeModel::keyframeModified, this, &AnimationController::invalidateCameraPath);
+        connect(m_keyframes, &QAbstractItemModel::modelReset, this, &AnimationController::invalidateCameraPath);
     }
+    invalidateCameraPath();
     emit totalDurationChanged();
 }
 
@@ -35,6 +49,47 @@ void AnimationController::setCamera(MapCamera* camera) {
     m_camera = camera;
 }
 
+void AnimationController::setWindow(QQuickWindow* window) {
+    if (m_window == window) return;
+
+    if (m_window) {
+        disconnect(m_window, nullptr, this, nullptr);
+    }
+    m_window = window;
+    m_lastSwapMs = -1.0;
+    setVsyncActive(false);
+
+    if (m_window) {
+        // frameSwapped arrives on the render thread with the threaded render
+        // loop: stamp it there, then advance the timeline on the GUI thread
+        connect(m_window, &QQuickWindow::frameSwapped, this, [this]() {
+            double swapMs = clockMs();
+            QMetaObject::invokeMethod(this, [this, swapMs]() {
+                onFrameSwapped(swapMs);
+            }, Qt::QueuedConnection);
+        }, Qt::DirectConnection);
+    }
+}
+
+double AnimationController::refreshInterval() const {
+    if (m_window && m_window->screen() && m_window->screen()->refreshRate() > 0) {
+        return 1000.0 / m_window->screen()->refreshRate();
+    }
+    return 1000.0 / 60.0;
+}
+
+void AnimationController::setVsyncActive(bool active) {
+    if (m_vsyncActive != active) {
+        m_vsyncActive = active;
+        emit vsyncDrivenChanged();
+    }
+}
+
+void AnimationController::resetFramePacing() {
+    m_pacing.reset();
+    emit framePacingChanged();
+}
+
 double AnimationController::totalDuration() const {
     if (m_useExplicitDuration) {
         return m_explicitDuration;
@@ -67,9 +122,13 @@ void AnimationController::play() {
     // Duration comes from explicit duration or keyframes
 
     m_playing = true;
-    m_elapsed.start();
-    m_lastTickTime = 0;
+    m_lastPresentMs = clockMs();
+    m_lastSwapMs = -1.0;
+    m_pacing.reset();
     m_timer->start();
+    if (m_window) {
+        m_window->update();  // Kick off the frameSwapped loop
+    }
     emit playingChanged();
 }
 
@@ -78,12 +137,15 @@ void AnimationController::pause() {
 
     m_playing = false;
     m_timer->stop();
+    setVsyncActive(false);
     emit playingChanged();
+    emit framePacingChanged();
 }
 
 void AnimationController::stop() {
     m_playing = false;
     m_timer->stop();
+    setVsyncActive(false);
     m_currentTimeMs = 0.0;
     m_currentKeyframeIndex = 0;
 
@@ -126,6 +188,10 @@ void AnimationController::setCurrentTime(double timeMs) {
     }
 }
 
+void AnimationController::setPresentationTime(double wallTimeMs) {
+    setCurrentTime(animationTimeAt(wallTimeMs));
+}
+
 void AnimationController::setPlaybackSpeed(double speed) {
     speed = qBound(0.1, speed, 4.0);
     if (!qFuzzyCompare(m_playbackSpeed, speed)) {
@@ -152,6 +218,32 @@ void AnimationController::setUseSpeedCurve(bool use) {
     }
 }
 
+void AnimationController::setPathMode(PathMode mode) {
+    if (m_pathMode != mode) {
+        m_pathMode = mode;
+        emit pathModeChanged();
+        updateCameraFromTime(m_currentTimeMs);
+    }
+}
+
+void AnimationController::setConstantSpeed(bool constant) {
+    if (m_constantSpeed != constant) {
+        m_constantSpeed = constant;
+        emit constantSpeedChanged();
+        updateCameraFromTime(m_currentTimeMs);
+    }
+}
+
+void AnimationController::setViewWidth(double width) {
+    if (width <= 0.0 || qFuzzyCompare(m_viewWidth, width)) return;
+    m_viewWidth = width;
+    updateCameraFromTime(m_currentTimeMs);
+}
+
+void AnimationController::invalidateCameraPath() {
+    m_cameraPathDirty = true;
+}
+
 void AnimationController::addSpeedPoint(double timeMs, double speed) {
     SpeedPoint point{timeMs, qBound(0.0, speed, 1.0)};
 
@@ -204,22 +296,24 @@ QVariantList AnimationController::getSpeedCurve() const {
 }
 
 double AnimationController::getSpeedAtTime(double timeMs) const {
-    if (m_speedCurve.isEmpty()) return 0.5;  // Default normal speed
-    if (m_speedCurve.size() == 1) return m_speedCurve[0].speed;
-
-    // Find surrounding points and interpolate
-    for (int i = 0; i < m_speedCurve.size() - 1; i++) {
-        if (timeMs >= m_speedCurve[i].time && timeMs <= m_speedCurve[i+1].time) {
-            double duration = m_speedCurve[i+1].time - m_speedCurve[i].time;
-            if (duration <= 0) return m_speedCurve[i].speed;
-            double t = (timeMs - m_speedCurve[i].time) / duration;
-            return m_speedCurve[i].speed + t * (m_speedCurve[i+1].speed - m_speedCurve[i].speed);
-        }
-    }
+    return SpeedCurveTable::speedAt(m_speedCurve, timeMs);
+}
 
-    // Before first point or after last point
-    if (timeMs < m_speedCurve.first().time) return m_speedCurve.first().speed;
-    return m_speedCurve.last().speed;
+double AnimationController::animationTimeAt(double wallTimeMs) const {
+    return m_speedTable.animationTimeAt(wallTimeMs);
+}
+
+double AnimationController::wallTimeAt(double animationTimeMs) const {
+    return m_speedTable.wallTimeAt(animationTimeMs);
+}
+
+void AnimationController::rebuildSpeedTable() {
+    if (m_useSpeedCurve && !m_speedCurve.isEmpty()) {
+        m_speedTable.rebuild(m_speedCurve, totalDuration());
+    } else {
+        m_speedTable.clear();
+    }
+    emit playbackDurationChanged();
 }
 
 void AnimationController::stepForward() {
@@ -251,20 +345,55 @@ void AnimationController::tick() {
         return;
     }
 
-    qint64 currentTick = m_elapsed.elapsed();
-    qint64 deltaMs = currentTick - m_lastTickTime;
-    m_lastTickTime = currentTick;
+    // While the window keeps presenting frames, onFrameSwapped() drives playback
+    double now = clockMs();
+    if (m_window && m_lastSwapMs >= 0.0 && now - m_lastSwapMs < VSYNC_TIMEOUT_MS) {
+        return;
+    }
 
-    // Get effective speed multiplier
-    double speedMultiplier = m_playbackSpeed;
-    if (m_useSpeedCurve && !m_speedCurve.isEmpty()) {
-        // Speed curve: 0 = stopped, 0.5 = normal (1x), 1.0 = fast (2x)
-        double curveSpeed = getSpeedAtTime(m_currentTimeMs);
-        speedMultiplier *= curveSpeed * 2.0;  // Map 0-1 to 0-2x speed
+    setVsyncActive(false);
+    if (m_window && m_window->isExposed()) {
+        m_window->update();  // Try to get back onto the frameSwapped loop
     }
+    advanceTo(now);
+}
 
-    // Advance time
-    double newTime = m_currentTimeMs + deltaMs * speedMultiplier;
+void AnimationController::onFrameSwapped(double swapTimeMs) {
+    if (!m_playing) return;
+
+    double interval = refreshInterval();
+    m_pacing.setExpectedInterval(interval);
+    if (m_lastSwapMs >= 0.0) {
+        m_pacing.addInterval(swapTimeMs - m_lastSwapMs);
+    }
+    m_lastSwapMs = swapTimeMs;
+    setVsyncActive(true);
+
+    // The frame we build now is presented at the first vblank after this
+    // point, so sample the timeline there instead of at "now"
+    double now = clockMs();
+    double periods = std::max(1.0, std::ceil((now - swapTimeMs) / interval));
+    advanceTo(swapTimeMs + periods * interval);
+
+    // Keep the loop going even when the new time produced no visible change
+    if (m_playing && m_window) {
+        m_window->update();
+    }
+
+    if (now - m_lastPacingReportMs >= PACING_REPORT_MS) {
+        m_lastPacingReportMs = now;
+        emit framePacingChanged();
+    }
+}
+
+void AnimationController::advanceTo(double presentTimeMs) {
+    double deltaMs = std::max(0.0, presentTimeMs - m_lastPresentMs);
+    m_lastPresentMs = std::max(m_lastPresentMs, presentTimeMs);
+
+    // Advance in presentation time and map back through the speed curve, so
+    // the result only depends on the current position, never on tick history
+    double wallTime = wallTimeAt(m_currentTimeMs) + deltaMs * m_playbackSpeed;
+    double newTime = animationTimeAt(wallTime);
 
     // Get both durations
     double keyframeDuration = m_keyframes ? m_keyframes->totalDuration() : 0.0;
@@ -296,36 +425,32 @@ void AnimationController::updateCameraFromTime(double timeMs) {
     // Set seeking flag to prevent feedback loops
     m_seeking = true;
 
-    // Handle single keyframe case
-    if (m_keyframes->count() == 1) {
-        const auto& kf = m_keyframes->at(0);
-        m_camera->setPosition(kf.latitude, kf.longitude, kf.zoom(), kf.bearing, kf.tilt);
-        m_seeking = false;
-        return;
+    if (m_pathMode == SplinePath && m_cameraPathDirty) {
+        m_cameraPath.build(m_keyframes->keyframes());
+        m_cameraPathDirty = false;
     }
 
-    // Find which keyframe transition we're in
-    int fromIndex, toIndex;
-    double progress = m_keyframes->progressAtTime(timeMs, fromIndex, toIndex);
-
-    // If at the last keyframe or invalid, just show it
-    if (fromIndex < 0 || fromIndex == toIndex) {
-        if (fromIndex >= 0) {
-            const auto& kf = m_keyframes->at(fromIndex);
-            m_camera->setPosition(kf.latitude, kf.longitude, kf.zoom(), kf.bearing, kf.tilt);
-        }
-        m_seeking = false;
-        return;
+    CameraState state;
+    if (TimelineSnapshot::cameraAt(m_keyframes->keyframes(), m_cameraPath, pathSettings(),
+                                   timeMs, state, &m_cameraCursor)) {
+        // CameraState.zoom() derives zoom from altitude
+        m_camera->setPosition(state.latitude, state.longitude, state.zoom(),
+                              state.bearing, state.tilt);
     }
+    m_seeking = false;
+}
 
-    // Interpolate between keyframes with ease-in-out
-    const Keyframe& from = m_keyframes->at(fromIndex);
-    const Keyframe& to = m_keyframes->at(toIndex);
-
-    CameraState state = m_interpolator->interpolate(from, to, progress);
+CameraPathSettings AnimationController::pathSettings() const {
+    CameraPathSettings settings;
+    settings.spline = m_pathMode == SplinePath;
+    settings.constantSpeed = m_constantSpeed;
+    settings.linearEasing = m_interpolator->linearMode();
+    settings.viewWidth = m_viewWidth;
+    return settings;
+}
 
-    // CameraState.zoom() derives zoom from altitude
-    m_camera->setPosition(state.latitude, state.longitude, state.zoom(),
-                          state.bearing, state.tilt);
-    m_seeking = false;
+TimelineSnapshot AnimationController::snapshot(const GeoOverlayModel* overlays) const {
+    return TimelineSnapshot(m_keyframes ? m_keyframes->keyframes() : QVector<Keyframe>(),
+                            pathSettings(), m_speedTable, totalDuration(),
+                            overlays ? overlays->overlays() : QVector<GeoOverlay>());
 }
@@ -5,15 +5,16 @@
 #include <QElapsedTimer>
 #include <QVariantList>
 #include <QVector>
+#include <QPointer>
+#include "framepacing.h"
+#include "speedcurvetable.h"
+#include "timelinesnapshot.h"
 
 class KeyframeModel;
 class Interpolator;
 class MapCamera;
-
-struct SpeedPoint {
-    double time;   // milliseconds
-    double speed;  // 0.0 to 1.0 (0 = stopped, 0.5 = normal, 1.0 = 2x speed)
-};
+class GeoOverlayModel;
+class QQuickWindow;
 
 class AnimationController : public QObject {
     Q_OBJECT
@@ -21,29 +22,56 @@ class AnimationController : public QObject {
     Q_PROPERTY(bool playing READ isPlaying NOTIFY playingChanged)
     Q_PROPERTY(double currentTime READ currentTime WRITE setCurrentTime NOTIFY currentTimeChanged)
     Q_PROPERTY(double totalDuration READ totalDuration NOTIFY totalDurationChanged)
+    Q_PROPERTY(double playbackDuration READ playbackDuration NOTIFY playbackDurationChanged)
     Q_PROPERTY(double playbackSpeed READ playbackSpeed WRITE setPlaybackSpeed NOTIFY playbackSpeedChanged)
     Q_PROPERTY(bool looping READ isLooping WRITE setLooping NOTIFY loopingChanged)
     Q_PROPERTY(int currentKeyframeIndex READ currentKeyframeIndex NOTIFY currentKeyframeIndexChanged)
     Q_PROPERTY(double explicitDuration READ explicitDuration WRITE setExplicitDuration NOTIFY explicitDurationChanged)
     Q_PROPERTY(bool useExplicitDuration READ useExplicitDuration WRITE setUseExplicitDuration NOTIFY useExplicitDurationChanged)
     Q_PROPERTY(bool useSpeedCurve READ useSpeedCurve WRITE setUseSpeedCurve NOTIFY useSpeedCurveChanged)
+    Q_PROPERTY(PathMode pathMode READ pathMode WRITE setPathMode NOTIFY pathModeChanged)
+    Q_PROPERTY(bool constantSpeed READ constantSpeed WRITE setConstantSpeed NOTIFY constantSpeedChanged)
+    Q_PROPERTY(bool vsyncDriven READ isVsyncDriven NOTIFY vsyncDrivenChanged)
+    Q_PROPERTY(QVariantMap framePacing READ framePacing NOTIFY framePacingChanged)
 
 public:
+    // How the camera moves between keyframes
+    enum PathMode {
+        LinearPath = 0,   // Per-segment interpolation with per-keyframe easing
+        SplinePath        // Centripetal Catmull-Rom through all keyframes
+    };
+    Q_ENUM(PathMode)
+
     explicit AnimationController(QObject* parent = nullptr);
 
     void setKeyframeModel(KeyframeModel* model);
     void setCamera(MapCamera* camera);
 
+    // Playback advances once per presented frame of this window; without one
+    // (or while it is hidden) the timer fallback takes over
+    void setWindow(QQuickWindow* window);
+
+    // Width of the map view in pixels; zoom-pan flights are shaped for it
+    void setViewWidth(double width);
+
     bool isPlaying() const { return m_playing; }
     bool isSeeking() const { return m_seeking; }  // True when updating camera from interpolation
     double currentTime() const { return m_currentTimeMs; }
     double totalDuration() const;
+    // Wall-clock length of the timeline at 1x, including the speed curve
+    double playbackDuration() const { return wallTimeAt(totalDuration()); }
     double playbackSpeed() const { return m_playbackSpeed; }
     bool isLooping() const { return m_looping; }
     int currentKeyframeIndex() const { return m_currentKeyframeIndex; }
     double explicitDuration() const { return m_explicitDuration; }
     bool useExplicitDuration() const { return m_useExplicitDuration; }
     bool useSpeedCurve() const { return m_useSpeedCurve; }
+    PathMode pathMode() const { return m_pathMode; }
+    bool constantSpeed() const { return m_constantSpeed; }
+    bool isVsyncDriven() const { return m_vsyncActive; }
+    QVariantMap framePacing() const { return m_pacing.toVariantMap(); }
+
+    Q_INVOKABLE void resetFramePacing();
 
     // Speed curve methods
     Q_INVOKABLE void addSpeedPoint(double timeMs, double speed);
@@ -53,6 +81,14 @@ public:
     Q_INVOKABLE QVariantList getSpeedCurve() const;
     Q_INVOKABLE double getSpeedAtTime(double timeMs) const;
 
+    // Immutable copy of the timeline for batch evaluation on any thread
+    TimelineSnapshot snapshot(const GeoOverlayModel* overlays = nullptr) const;
+
+    // Presentation (wall clock at 1x) <-> animation time through the speed curve.
+    // Identity when the speed curve is disabled.
+    Q_INVOKABLE double animationTimeAt(double wallTimeMs) const;
+    Q_INVOKABLE double wallTimeAt(double animationTimeMs) const;
+
 public slots:
     void play();
     void pause();
@@ -60,6 +96,7 @@ public slots:
     void togglePlayPause();
     void seekTo(double timeMs);
     void setCurrentTime(double timeMs);
+    void setPresentationTime(double wallTimeMs);  // Used by export so it matches playback
     void setPlaybackSpeed(double speed);
     void setLooping(bool loop);
 
@@ -68,6 +105,8 @@ public slots:
     void setExplicitDuration(double durationMs);
     void setUseExplicitDuration(bool use);
     void setUseSpeedCurve(bool use);
+    void setPathMode(PathMode mode);
+    void setConstantSpeed(bool constant);
 
 signals:
     void playingChanged();
@@ -82,20 +121,39 @@ signals:
     void useExplicitDurationChanged();
     void useSpeedCurveChanged();
     void speedCurveChanged();
+    void pathModeChanged();
+    void constantSpeedChanged();
+    void playbackDurationChanged();
+    void vsyncDrivenChanged();
+    void framePacingChanged();
 
 private slots:
     void tick();
 
 private:
     void updateCameraFromTime(double timeMs);
+    void invalidateCameraPath();
+    CameraPathSettings pathSettings() const;
+    void onFrameSwapped(double swapTimeMs);
+    void advanceTo(double presentTimeMs);
+    double clockMs() const { return m_clock.nsecsElapsed() / 1e6; }
+    double refreshInterval() const;
+    void setVsyncActive(bool active);
+    void rebuildSpeedTable();
 
     KeyframeModel* m_keyframes = nullptr;
     MapCamera* m_camera = nullptr;
     Interpolator* m_interpolator = nullptr;
 
     QTimer* m_timer = nullptr;
-    QElapsedTimer m_elapsed;
-    qint64 m_lastTickTime = 0;
+    QElapsedTimer m_clock;               // Started once; read from the render thread too
+    double m_lastPresentMs = 0.0;        // Present time the current animation time was computed for
+    double m_lastSwapMs = -1.0;          // Last frameSwapped, -1 until the first one after play()
+    double m_lastPacingReportMs = 0.0;
+    bool m_vsyncActive = false;
+
+    QPointer<QQuickWindow> m_window;
+    FramePacing m_pacing;
 
     bool m_playing = false;
     bool m_seeking = false;  // True during updateCameraFromTime to prevent feedback loops
@@ -107,6 +165,15 @@ private:
     bool m_useExplicitDuration = true;    // Default to explicit duration mode
     bool m_useSpeedCurve = true;          // Use speed curve for playback
     QVector<SpeedPoint> m_speedCurve;     // Speed curve points
-
-    static constexpr int TICK_INTERVAL_MS = 16;  // ~60fps preview
+    SpeedCurveTable m_speedTable;         // Rebuilt whenever the curve or duration changes
+    PathMode m_pathMode = LinearPath;
+    bool m_constantSpeed = false;         // Spline only: constant screen-space speed per segment
+    double m_viewWidth = Interpolator::DEFAULT_VIEW_WIDTH;
+    CameraPath m_cameraPath;              // Built lazily from the keyframes
+    bool m_cameraPathDirty = true;
+    TrackCursor m_cameraCursor;
+
+    static constexpr int TICK_INTERVAL_MS = 16;  // ~60fps preview when not vsync-driven
+    static constexpr double VSYNC_TIMEOUT_MS = 100.0;  // No swap for this long -> timer fallback
+    static constexpr int PACING_REPORT_MS = 500;
 };
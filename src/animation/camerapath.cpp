@@ -0,0 +1,167 @@
+#include "camerapath.h"
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double MIN_KNOT_SPACING = 1e-6;
+}
+
+void CameraPath::clear() {
+    m_points.clear();
+    m_knotSpacing.clear();
+    m_arcLengths.clear();
+}
+
+void CameraPath::build(const QVector<Keyframe>& keyframes) {
+    clear();
+    if (keyframes.size() < 2) return;
+
+    m_points.reserve(keyframes.size());
+    double previousBearing = 0.0;
+    for (int i = 0; i < keyframes.size(); ++i) {
+        const Keyframe& kf = keyframes[i];
+        double lat = qDegreesToRadians(kf.latitude);
+        double lon = qDegreesToRadians(kf.longitude);
+
+        // Unwrap bearing so the spline turns the short way
+        double bearing = kf.bearing;
+        if (i > 0) {
+            double diff = std::remainder(bearing - previousBearing, 360.0);
+            bearing = previousBearing + diff;
+        }
+        previousBearing = bearing;
+
+        m_points.append(Point{
+            std::cos(lat) * std::cos(lon),
+            std::cos(lat) * std::sin(lon),
+            std::sin(lat),
+            std::log(qMax(kf.altitude, 1.0)),
+            bearing,
+            kf.tilt
+        });
+    }
+
+    // Centripetal knots: spacing is distance^alpha
+    m_knotSpacing.resize(m_points.size() + 1);
+    for (int i = -1; i < m_points.size(); ++i) {
+        double distance = pointDistance(pointAt(i), pointAt(i + 1));
+        m_knotSpacing[i + 1] = qMax(std::pow(distance, ALPHA), MIN_KNOT_SPACING);
+    }
+
+    m_arcLengths.resize(segmentCount());
+    for (int s = 0; s < segmentCount(); ++s) {
+        QVector<double>& table = m_arcLengths[s];
+        table.resize(ARC_SAMPLES + 1);
+        table[0] = 0.0;
+
+        CameraState previous = toState(splineAt(s, 0.0));
+        for (int j = 1; j <= ARC_SAMPLES; ++j) {
+            CameraState current = toState(splineAt(s, double(j) / ARC_SAMPLES));
+            table[j] = table[j - 1] + screenDistance(previous, current);
+            previous = current;
+        }
+    }
+}
+
+double CameraPath::segmentLength(int segment) const {
+    if (segment < 0 || segment >= m_arcLengths.size()) return 0.0;
+    return m_arcLengths[segment].last();
+}
+
+CameraState CameraPath::evaluate(int segment, double progress, bool constantSpeed) const {
+    segment = qBound(0, segment, segmentCount() - 1);
+    double u = qBound(0.0, progress, 1.0);
+
+    if (constantSpeed) {
+        const QVector<double>& table = m_arcLengths[segment];
+        double total = table.last();
+        if (total > 0.0) {
+            double target = u * total;
+            auto it = std::upper_bound(table.begin(), table.end(), target);
+            int j = qBound(1, static_cast<int>(it - table.begin()), ARC_SAMPLES);
+            double span = table[j] - table[j - 1];
+            double frac = span > 0.0 ? (target - table[j - 1]) / span : 0.0;
+            u = (j - 1 + frac) / ARC_SAMPLES;
+        }
+    }
+
+    return toState(splineAt(segment, u));
+}
+
+double CameraPath::screenDistance(const CameraState& a, const CameraState& b) {
+    // Ground distance in units of the (geometric mean) altitude approximates
+    // screen widths travelled; log altitude change is the zoom component
+    double ground = Interpolator::greatCircleDistance(a.latitude, a.longitude,
+                                                      b.latitude, b.longitude) * 1000.0;
+    double scale = std::sqrt(qMax(a.altitude, 1.0) * qMax(b.altitude, 1.0));
+    double pan = ground / scale;
+    double zoom = std::log(qMax(b.altitude, 1.0) / qMax(a.altitude, 1.0));
+    return std::sqrt(pan * pan + zoom * zoom);
+}
+
+double CameraPath::pointDistance(const Point& a, const Point& b) {
+    return screenDistance(toState(a), toState(b));
+}
+
+CameraPath::Point CameraPath::pointAt(int index) const {
+    // Reflect the neighbour across the ends so the first and last segments
+    // get a natural tangent
+    const int n = m_points.size();
+    if (index < 0) {
+        Point p;
+        for (int c = 0; c < 6; ++c) p[c] = 2.0 * m_points[0][c] - m_points[1][c];
+        return p;
+    }
+    if (index >= n) {
+        Point p;
+        for (int c = 0; c < 6; ++c) p[c] = 2.0 * m_points[n - 1][c] - m_points[n - 2][c];
+        return p;
+    }
+    return m_points[index];
+}
+
+CameraPath::Point CameraPath::splineAt(int segment, double u) const {
+    const Point p0 = pointAt(segment - 1);
+    const Point p1 = pointAt(segment);
+    const Point p2 = pointAt(segment + 1);
+    const Point p3 = pointAt(segment + 2);
+
+    const double t0 = 0.0;
+    const double t1 = t0 + m_knotSpacing[segment];
+    const double t2 = t1 + m_knotSpacing[segment + 1];
+    const double t3 = t2 + m_knotSpacing[segment + 2];
+    const double t = t1 + u * (t2 - t1);
+
+    // Barry-Goldman pyramidal evaluation
+    auto blend = [](const Point& a, const Point& b, double ta, double tb, double t) {
+        double wb = (t - ta) / (tb - ta);
+        Point r;
+        for (int c = 0; c < 6; ++c) r[c] = a[c] + (b[c] - a[c]) * wb;
+        return r;
+    };
+    Point a1 = blend(p0, p1, t0, t1, t);
+    Point a2 = blend(p1, p2, t1, t2, t);
+    Point a3 = blend(p2, p3, t2, t3, t);
+    Point b1 = blend(a1, a2, t0, t2, t);
+    Point b2 = blend(a2, a3, t1, t3, t);
+    return blend(b1, b2, t1, t2, t);
+}
+
+CameraState CameraPath::toState(const Point& p) {
+    double length = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+
+    CameraState state;
+    if (length > 0.0) {
+        state.latitude = qRadiansToDegrees(std::asin(qBound(-1.0, p[2] / length, 1.0)));
+        state.longitude = qRadiansToDegrees(std::atan2(p[1], p[0]));
+    } else {
+        state.latitude = 0.0;
+        state.longitude = 0.0;
+    }
+    state.altitude = std::exp(p[3]);
+    state.bearing = std::fmod(p[4], 360.0);
+    if (state.bearing < 0.0) state.bearing += 360.0;
+    state.tilt = p[5];
+    return state;
+}
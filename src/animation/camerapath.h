@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QVector>
+#include <array>
+#include "keyframe.h"
+#include "interpolator.h"
+
+// Centripetal Catmull-Rom camera path through every keyframe. Positions are
+// splined as Earth-centered unit vectors (no antimeridian or pole special
+// cases) and altitude as log(altitude), so zooming looks uniform. Velocity is
+// continuous across keyframes, unlike the per-segment linear interpolation.
+//
+// Each segment carries an arc-length table measured in screen-space units
+// (ground distance relative to altitude, plus zoom change), so playback can
+// request constant perceived speed within a segment. Evaluation is a table
+// lookup plus one spline evaluation.
+class CameraPath {
+public:
+    void build(const QVector<Keyframe>& keyframes);
+    void clear();
+    bool isEmpty() const { return m_points.size() < 2; }
+    int segmentCount() const { return qMax(0, m_points.size() - 1); }
+
+    // State on segment [index, index + 1] at progress 0..1. With constantSpeed
+    // the progress is read as a fraction of the segment's arc length.
+    CameraState evaluate(int segment, double progress, bool constantSpeed) const;
+
+    // Screen-space length of a segment
+    double segmentLength(int segment) const;
+
+    // Distance metric used for knot spacing and arc length
+    static double screenDistance(const CameraState& a, const CameraState& b);
+
+private:
+    // x, y, z (unit sphere), log altitude, unwrapped bearing, tilt
+    using Point = std::array<double, 6>;
+
+    Point pointAt(int index) const;
+    Point splineAt(int segment, double u) const;
+    static CameraState toState(const Point& p);
+    static double pointDistance(const Point& a, const Point& b);
+
+    QVector<Point> m_points;
+    QVector<double> m_knotSpacing;          // [i + 1] = spacing between points i and i + 1, from i = -1
+    QVector<QVector<double>> m_arcLengths;  // Cumulative length at u = j / ARC_SAMPLES
+
+    static constexpr double ALPHA = 0.5;  // Centripetal parameterization
+    static constexpr int ARC_SAMPLES = 32;
+};
@@ -1,26 +1,41 @@
 #include "framebuffer.h"
 #include <QMutexLocker>
+#include <QThread>
 #include <QtMath>
+#include <climits>
 
 FrameBuffer::FrameBuffer(QObject* parent)
     : QObject(parent)
 {
+    m_store.setMemoryBudget(m_maxMemoryBytes);
+    m_store.setSpillBudget(m_maxSpillBytes);
 }
 
 void FrameBuffer::setFrameRate(int fps) {
-    QMutexLocker locker(&m_mutex);
-    if (m_fps != fps) {
-        m_fps = qBound(1, fps, 120);
-        m_totalFrames = static_cast<int>(std::ceil(m_totalDurationMs / 1000.0 * m_fps));
-        clear();
+    setFrameRate(FrameRate(qBound(1, fps, 120), 1));
+}
+
+void FrameBuffer::setFrameRate(const FrameRate& rate) {
+    if (!rate.isValid()) return;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_rate == rate) return;
+        m_rate = rate;
+        updateTotalFrames();
     }
+    clear();
+}
+
+void FrameBuffer::updateTotalFrames() {
+    m_totalFrames = static_cast<int>(m_rate.frameCount(Timebase::fromMs(m_totalDurationMs)));
+    m_store.setLoopLength(m_totalFrames);
 }
 
 void FrameBuffer::setTotalDuration(double durationMs) {
     QMutexLocker locker(&m_mutex);
     if (!qFuzzyCompare(m_totalDurationMs, durationMs)) {
         m_totalDurationMs = durationMs;
-        m_totalFrames = static_cast<int>(std::ceil(m_totalDurationMs / 1000.0 * m_fps));
+        updateTotalFrames();
         m_complete = false;
         emit completeChanged();
     }
@@ -43,8 +58,20 @@ void FrameBuffer::setResolution(int width, int height) {
 
 void FrameBuffer::setMaxMemoryMB(int mb) {
     QMutexLocker locker(&m_mutex);
-    m_maxMemoryBytes = mb * 1024 * 1024;
-    checkMemoryLimit();
+    m_maxMemoryBytes = static_cast<qint64>(qMax(0, mb)) * 1024 * 1024;
+    m_store.setMemoryBudget(m_maxMemoryBytes);
+    updateComplete();
+    locker.unlock();
+    notifyFramesChanged();
+}
+
+void FrameBuffer::setMaxSpillMB(int mb) {
+    QMutexLocker locker(&m_mutex);
+    m_maxSpillBytes = static_cast<qint64>(qMax(0, mb)) * 1024 * 1024;
+    m_store.setSpillBudget(m_maxSpillBytes);
+    updateComplete();
+    locker.unlock();
+    notifyFramesChanged();
 }
 
 void FrameBuffer::setEnabled(bool enabled) {
@@ -57,42 +84,95 @@ void FrameBuffer::setEnabled(bool enabled) {
     }
 }
 
+int FrameBuffer::frameCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_store.count();
+}
+
 double FrameBuffer::progress() const {
     QMutexLocker locker(&m_mutex);
     if (m_totalFrames <= 0) return 0.0;
-    return static_cast<double>(m_frames.size()) / m_totalFrames;
+    return static_cast<double>(m_store.count()) / m_totalFrames;
 }
 
 bool FrameBuffer::hasFrame(double timeMs) const {
     if (!m_enabled) return false;
     QMutexLocker locker(&m_mutex);
     int frameIndex = timeToFrameIndex(timeMs);
-    return m_frames.contains(frameIndex);
+    return m_store.contains(frameIndex);
 }
 
 QImage FrameBuffer::getFrame(double timeMs) const {
-    QMutexLocker locker(&m_mutex);
-    int frameIndex = timeToFrameIndex(timeMs);
-    return m_frames.value(frameIndex, QImage());
+    QByteArray data;
+    {
+        QMutexLocker locker(&m_mutex);
+        int frameIndex = timeToFrameIndex(timeMs);
+        // Playback reads drive the loop-aware eviction order
+        m_store.setPlayhead(frameIndex);
+        data = m_store.get(frameIndex);
+    }
+    if (data.isEmpty()) return QImage();
+    return m_store.decode(data);
 }
 
 void FrameBuffer::storeFrame(double timeMs, const QImage& frame) {
-    if (!m_enabled || frame.isNull()) return;
+    storeFrame(timeMs, frame, epoch());
+}
 
+quint64 FrameBuffer::epoch() const {
     QMutexLocker locker(&m_mutex);
-    int frameIndex = timeToFrameIndex(timeMs);
+    return m_epoch;
+}
+
+bool FrameBuffer::storeFrame(double timeMs, const QImage& frame, quint64 epoch) {
+    if (!m_enabled || frame.isNull()) return false;
+
+    int frameIndex;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (epoch != m_epoch) return false;
+
+        frameIndex = timeToFrameIndex(timeMs);
+
+        // Don't store if already have this frame
+        if (m_store.contains(frameIndex)) return false;
+    }
 
-    // Don't store if already have this frame
-    if (m_frames.contains(frameIndex)) return;
+    // Compress outside the lock so playback reads are never held up
+    QByteArray data = m_store.encode(frame);
 
-    // Check memory limit before adding
-    checkMemoryLimit();
+    {
+        QMutexLocker locker(&m_mutex);
+        if (epoch != m_epoch || m_store.contains(frameIndex)) return false;
+
+        m_store.insert(frameIndex, data);
+        updateComplete();
+    }
+
+    notifyFramesChanged();
+    return true;
+}
+
+int FrameBuffer::capacity() const {
+    QMutexLocker locker(&m_mutex);
+    qint64 bytesPerFrame = m_store.averageFrameBytes();
+    if (bytesPerFrame <= 0) {
+        bytesPerFrame = static_cast<qint64>(m_width) * m_height * 4 / COMPRESSION_ESTIMATE;
+    }
+    bytesPerFrame = qMax<qint64>(1, bytesPerFrame);
+    qint64 frames = (m_store.memoryBudget() + m_store.spillBudget()) / bytesPerFrame;
+    return static_cast<int>(qMin<qint64>(frames, INT_MAX));
+}
 
-    m_frames.insert(frameIndex, frame);
+void FrameBuffer::notifyFramesChanged() {
+    // Worker threads store frames too; QML only sees notifications on our thread
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, &FrameBuffer::notifyFramesChanged, Qt::QueuedConnection);
+        return;
+    }
     emit frameCountChanged();
     emit progressChanged();
-
-    updateComplete();
+    emit completeChanged();
 }
 
 double FrameBuffer::quantizeTime(double timeMs) const {
@@ -101,22 +181,19 @@ double FrameBuffer::quantizeTime(double timeMs) const {
 }
 
 int FrameBuffer::timeToFrameIndex(double timeMs) const {
-    if (m_fps <= 0) return 0;
-    double frameInterval = 1000.0 / m_fps;
-    return static_cast<int>(std::floor(timeMs / frameInterval));
+    return static_cast<int>(m_rate.frameAt(Timebase::fromMs(timeMs)));
 }
 
 double FrameBuffer::frameIndexToTime(int index) const {
-    if (m_fps <= 0) return 0.0;
-    double frameInterval = 1000.0 / m_fps;
-    return index * frameInterval;
+    return m_rate.frameTimeMs(index);
 }
 
 void FrameBuffer::clear() {
     {
         QMutexLocker locker(&m_mutex);
-        m_frames.clear();
+        m_store.clear();
         m_complete = false;
+        m_epoch++;
     }
     emit frameCountChanged();
     emit completeChanged();
@@ -128,34 +205,29 @@ void FrameBuffer::invalidate() {
     emit bufferInvalidated();
 }
 
-void FrameBuffer::updateComplete() {
-    // Check if we have enough frames for a complete loop
-    // We consider complete if we have at least 95% of frames
-    bool wasComplete = m_complete;
-    int threshold = static_cast<int>(m_totalFrames * 0.95);
-    m_complete = (m_frames.size() >= threshold) && (m_totalFrames > 0);
+void FrameBuffer::invalidateRange(double startMs, double endMs) {
+    {
+        QMutexLocker locker(&m_mutex);
+        int first = timeToFrameIndex(qMax(0.0, startMs));
+        int last = endMs >= m_totalDurationMs ? INT_MAX : timeToFrameIndex(endMs);
+        for (int index : m_store.indices()) {
+            if (index >= first && index <= last) {
+                m_store.remove(index);
+            }
+        }
+        updateComplete();
 
-    if (m_complete != wasComplete) {
-        emit completeChanged();
+        // Renders in flight may have sampled the old timeline
+        m_epoch++;
     }
+    notifyFramesChanged();
+    emit bufferInvalidated();
 }
 
-void FrameBuffer::checkMemoryLimit() {
-    // Estimate memory usage: width * height * 4 bytes per frame (ARGB32)
-    qint64 bytesPerFrame = static_cast<qint64>(m_width) * m_height * 4;
-    qint64 currentUsage = bytesPerFrame * m_frames.size();
-
-    // If over limit, remove oldest frames (lowest indices)
-    if (currentUsage > m_maxMemoryBytes && !m_frames.isEmpty()) {
-        QList<int> keys = m_frames.keys();
-        std::sort(keys.begin(), keys.end());
-
-        while (currentUsage > m_maxMemoryBytes && !keys.isEmpty()) {
-            m_frames.remove(keys.takeFirst());
-            currentUsage = bytesPerFrame * m_frames.size();
-        }
-
-        m_complete = false;
-        emit completeChanged();
-    }
+void FrameBuffer::updateComplete() {
+    // Check if we have enough frames for a complete loop
+    // We consider complete if we have at least 95% of frames.
+    // Called under the lock; callers notify.
+    int threshold = static_cast<int>(m_totalFrames * 0.95);
+    m_complete = (m_store.count() >= threshold) && (m_totalFrames > 0);
 }
@@ -2,8 +2,9 @@
 
 #include <QObject>
 #include <QImage>
-#include <QHash>
 #include <QMutex>
+#include "framestore.h"
+#include "timebase.h"
 
 class FrameBuffer : public QObject {
     Q_OBJECT
@@ -18,11 +19,14 @@ public:
 
     // Configuration
     void setFrameRate(int fps);
+    void setFrameRate(const FrameRate& rate);
     void setTotalDuration(double durationMs);
     void setResolution(int width, int height);
     void setMaxMemoryMB(int mb);
+    void setMaxSpillMB(int mb);  // 0 keeps everything in memory
 
-    int frameRate() const { return m_fps; }
+    int frameRate() const { return qRound(m_rate.fps()); }
+    FrameRate exactFrameRate() const { return m_rate; }
     double totalDuration() const { return m_totalDurationMs; }
     int width() const { return m_width; }
     int height() const { return m_height; }
@@ -33,7 +37,7 @@ public:
 
     // Check if we have a complete buffer for looping
     bool isComplete() const { return m_complete; }
-    int frameCount() const { return m_frames.size(); }
+    int frameCount() const;
     int totalFrames() const { return m_totalFrames; }
     double progress() const;
 
@@ -42,7 +46,17 @@ public:
     QImage getFrame(double timeMs) const;
     void storeFrame(double timeMs, const QImage& frame);
 
-    // Get the frame time quantized to frame rate
+    // Bumped by every clear(). Background renderers pass the epoch their
+    // snapshot was taken in, so frames of an outdated timeline are dropped.
+    quint64 epoch() const;
+    bool storeFrame(double timeMs, const QImage& frame, quint64 epoch);
+
+    // Frames that fit in the memory and spill budgets, estimated from the
+    // compressed size of the frames stored so far
+    int capacity() const;
+
+    // Frame indices come from integer ticks, so a time and the frame time
+    // derived from it always map back to the same index
     double quantizeTime(double timeMs) const;
     int timeToFrameIndex(double timeMs) const;
     double frameIndexToTime(int index) const;
@@ -51,6 +65,9 @@ public:
     Q_INVOKABLE void clear();
     Q_INVOKABLE void invalidate();
 
+    // Drop only the frames sampled inside [startMs, endMs]; endMs may be infinite
+    void invalidateRange(double startMs, double endMs);
+
 signals:
     void completeChanged();
     void frameCountChanged();
@@ -60,18 +77,25 @@ signals:
 
 private:
     void updateComplete();
-    void checkMemoryLimit();
+    void notifyFramesChanged();
 
     mutable QMutex m_mutex;
-    QHash<int, QImage> m_frames;  // frame index -> image
+    mutable FrameStore m_store;  // frame index -> compressed frame
 
-    int m_fps = 30;
+    void updateTotalFrames();
+
+    FrameRate m_rate;
     double m_totalDurationMs = 0.0;
     int m_width = 1920;
     int m_height = 1080;
     int m_totalFrames = 0;
-    int m_maxMemoryBytes = 512 * 1024 * 1024;  // 512 MB default
+    qint64 m_maxMemoryBytes = 512LL * 1024 * 1024;  // 512 MB default
+    qint64 m_maxSpillBytes = 4096LL * 1024 * 1024;
+
+    // QOI typically gets map frames to a third of ARGB32 or better
+    static constexpr int COMPRESSION_ESTIMATE = 3;
 
     bool m_enabled = true;
     bool m_complete = false;
+    quint64 m_epoch = 0;
 };
@@ -0,0 +1,180 @@
+#include "frameinvalidator.h"
+#include "framebuffer.h"
+#include "keyframemodel.h"
+#include "regiontrackmodel.h"
+#include "geooverlaymodel.h"
+#include "../overlays/overlaymanager.h"
+#include <QJsonObject>
+
+namespace {
+
+// Lengths of the unchanged runs at both ends of two lists. Items in
+// [prefix, size - suffix) of either list were inserted, removed or edited.
+template <typename List, typename Same>
+void unchangedEnds(const List& before, const List& after, Same same, int& prefix, int& suffix) {
+    const int nb = before.size();
+    const int na = after.size();
+    prefix = 0;
+    while (prefix < nb && prefix < na && same(before.at(prefix), after.at(prefix))) {
+        prefix++;
+    }
+    suffix = 0;
+    while (suffix < nb - prefix && suffix < na - prefix
+           && same(before.at(nb - 1 - suffix), after.at(na - 1 - suffix))) {
+        suffix++;
+    }
+}
+
+// Union of the windows of every changed item on either side
+template <typename List, typename Same, typename Window>
+TimeRange changedWindows(const List& before, const List& after, Same same, Window window) {
+    int prefix, suffix;
+    unchangedEnds(before, after, same, prefix, suffix);
+
+    TimeRange range;
+    for (int i = prefix; i < before.size() - suffix; ++i) range.unite(window(before.at(i)));
+    for (int i = prefix; i < after.size() - suffix; ++i) range.unite(window(after.at(i)));
+    return range;
+}
+
+// Visible from start until end plus its fade out; end <= 0 runs to the timeline end
+TimeRange fadeWindow(double start, double end, double fadeOut) {
+    return {start, end > 0 ? end + qMax(0.0, fadeOut) : TimeRange::OPEN_END};
+}
+
+bool sameKeyframe(const Keyframe& a, const Keyframe& b) {
+    return a.latitude == b.latitude && a.longitude == b.longitude && a.altitude == b.altitude
+        && a.bearing == b.bearing && a.tilt == b.tilt && a.timeMs == b.timeMs
+        && a.easing == b.easing && a.transition == b.transition;
+}
+
+bool sameGeoOverlay(const GeoOverlay& a, const GeoOverlay& b) {
+    return a.polygons == b.polygons && a.toJson() == b.toJson();
+}
+
+TimeRange geoOverlayWindow(const GeoOverlay& overlay) {
+    return fadeWindow(overlay.startTime, overlay.endTime, overlay.fadeOutDuration);
+}
+
+TimeRange effectWindow(const OverlayEffect& effect) {
+    return {effect.startTime, effect.endTime + qMax(0.0, effect.fadeOutDuration)};
+}
+
+}  // namespace
+
+FrameInvalidator::FrameInvalidator(FrameBuffer* buffer, KeyframeModel* keyframes,
+                                   RegionTrackModel* regionTracks, GeoOverlayModel* geoOverlays,
+                                   OverlayManager* overlays, QObject* parent)
+    : QObject(parent)
+    , m_buffer(buffer)
+    , m_keyframes(keyframes)
+    , m_regionTracks(regionTracks)
+    , m_geoOverlays(geoOverlays)
+    , m_overlays(overlays)
+    , m_lastKeyframes(keyframes->keyframes())
+    , m_lastRegionTracks(regionTracks->tracks())
+    , m_lastGeoOverlays(geoOverlays->overlays())
+    , m_lastOverlays(overlays->toJson())
+{
+    connect(m_keyframes, &KeyframeModel::dataModified, this, &FrameInvalidator::onKeyframesChanged);
+    connect(m_keyframes, &KeyframeModel::countChanged, this, &FrameInvalidator::onKeyframesChanged);
+    connect(m_regionTracks, &RegionTrackModel::dataModified, this, &FrameInvalidator::onRegionTracksChanged);
+    connect(m_geoOverlays, &GeoOverlayModel::dataModified, this, &FrameInvalidator::onGeoOverlaysChanged);
+    connect(m_overlays, &OverlayManager::dataModified, this, &FrameInvalidator::onOverlaysChanged);
+}
+
+void FrameInvalidator::setTotalDuration(double durationMs) {
+    // Open-ended overlays and tracks fade out at the timeline end
+    if (m_totalDuration >= 0 && durationMs != m_totalDuration) {
+        invalidate({qMin(m_totalDuration, durationMs), TimeRange::OPEN_END});
+    }
+    m_totalDuration = durationMs;
+}
+
+TimeRange FrameInvalidator::keyframeChange(const QVector<Keyframe>& before, const QVector<Keyframe>& after) {
+    int prefix, suffix;
+    unchangedEnds(before, after, sameKeyframe, prefix, suffix);
+    if (prefix + suffix == before.size() && prefix + suffix == after.size()) return {};
+
+    // Keyframes are sorted by time and the unchanged runs are shared, so the
+    // segments touching a changed keyframe (old or new) lie between the
+    // keyframes KEYFRAME_REACH away on the unchanged side. Past the first and
+    // last keyframe the camera holds still, so those edges stay open.
+    const int first = prefix - KEYFRAME_REACH;
+    const int last = after.size() - suffix + KEYFRAME_REACH - 1;
+    TimeRange range;
+    range.start = first >= 0 ? after.at(first).timeMs : 0.0;
+    range.end = last < after.size() ? after.at(last).timeMs : TimeRange::OPEN_END;
+    return range;
+}
+
+TimeRange FrameInvalidator::geoOverlayChange(const QVector<GeoOverlay>& before, const QVector<GeoOverlay>& after) {
+    int prefix, suffix;
+    unchangedEnds(before, after, sameGeoOverlay, prefix, suffix);
+
+    // One overlay edited in place: if only its effects changed, the changed
+    // effect windows are enough
+    if (before.size() == after.size() && prefix + suffix == before.size() - 1) {
+        const GeoOverlay& a = before.at(prefix);
+        const GeoOverlay& b = after.at(prefix);
+        QJsonObject aJson = a.toJson();
+        QJsonObject bJson = b.toJson();
+        aJson.remove("effects");
+        bJson.remove("effects");
+        if (a.id == b.id && a.polygons == b.polygons && aJson == bJson) {
+            return changedWindows(a.effects, b.effects,
+                [](const OverlayEffect& x, const OverlayEffect& y) { return x.toJson() == y.toJson(); },
+                effectWindow);
+        }
+    }
+
+    return changedWindows(before, after, sameGeoOverlay, geoOverlayWindow);
+}
+
+TimeRange FrameInvalidator::regionTrackChange(const QVector<RegionTrack>& before, const QVector<RegionTrack>& after) {
+    return changedWindows(before, after,
+        [](const RegionTrack& a, const RegionTrack& b) { return a.toJson() == b.toJson(); },
+        [](const RegionTrack& track) {
+            return fadeWindow(track.startTime, track.endTime, track.fadeOutDuration);
+        });
+}
+
+TimeRange FrameInvalidator::overlayChange(const QJsonArray& before, const QJsonArray& after) {
+    return changedWindows(before, after,
+        [](const QJsonValue& a, const QJsonValue& b) { return a == b; },
+        [](const QJsonValue& value) {
+            // Legacy overlays have no fades; a negative end means until the end
+            QJsonObject obj = value.toObject();
+            double end = obj["endTime"].toDouble(-1.0);
+            return TimeRange{obj["startTime"].toDouble(0.0), end >= 0 ? end : TimeRange::OPEN_END};
+        });
+}
+
+void FrameInvalidator::onKeyframesChanged() {
+    QVector<Keyframe> current = m_keyframes->keyframes();
+    invalidate(keyframeChange(m_lastKeyframes, current));
+    m_lastKeyframes = current;
+}
+
+void FrameInvalidator::onRegionTracksChanged() {
+    QVector<RegionTrack> current = m_regionTracks->tracks();
+    invalidate(regionTrackChange(m_lastRegionTracks, current));
+    m_lastRegionTracks = current;
+}
+
+void FrameInvalidator::onGeoOverlaysChanged() {
+    QVector<GeoOverlay> current = m_geoOverlays->overlays();
+    invalidate(geoOverlayChange(m_lastGeoOverlays, current));
+    m_lastGeoOverlays = current;
+}
+
+void FrameInvalidator::onOverlaysChanged() {
+    QJsonArray current = m_overlays->toJson();
+    invalidate(overlayChange(m_lastOverlays, current));
+    m_lastOverlays = current;
+}
+
+void FrameInvalidator::invalidate(const TimeRange& range) {
+    if (range.isEmpty()) return;
+    m_buffer->invalidateRange(range.start, range.end);
+}
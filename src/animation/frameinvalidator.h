@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QObject>
+#include <QVector>
+#include <QJsonArray>
+#include <limits>
+#include "keyframe.h"
+#include "geooverlay.h"
+#include "regiontrack.h"
+
+class FrameBuffer;
+class KeyframeModel;
+class RegionTrackModel;
+class GeoOverlayModel;
+class OverlayManager;
+
+// Animation time range in ms, both ends inclusive. end may be infinite
+// ("until the end of the timeline"); end < start means empty.
+struct TimeRange {
+    double start = 0.0;
+    double end = -1.0;
+
+    static constexpr double OPEN_END = std::numeric_limits<double>::infinity();
+
+    bool isEmpty() const { return end < start; }
+    void unite(const TimeRange& other) {
+        if (other.isEmpty()) return;
+        if (isEmpty()) {
+            *this = other;
+            return;
+        }
+        start = qMin(start, other.start);
+        end = qMax(end, other.end);
+    }
+};
+
+// Keeps the frame buffer across routine edits. The content each timeline
+// model had at the last edit is kept and diffed against the new content,
+// so only frames in the time range an edit can affect are dropped; the
+// models themselves don't have to report what they touched.
+class FrameInvalidator : public QObject {
+    Q_OBJECT
+
+public:
+    FrameInvalidator(FrameBuffer* buffer, KeyframeModel* keyframes, RegionTrackModel* regionTracks,
+                     GeoOverlayModel* geoOverlays, OverlayManager* overlays, QObject* parent = nullptr);
+
+    // Open-ended overlays fade out at the timeline end, so a new duration
+    // invalidates from the earlier of the two ends
+    void setTotalDuration(double durationMs);
+
+    // Time ranges whose rendering differs between two versions of a model
+    static TimeRange keyframeChange(const QVector<Keyframe>& before, const QVector<Keyframe>& after);
+    static TimeRange geoOverlayChange(const QVector<GeoOverlay>& before, const QVector<GeoOverlay>& after);
+    static TimeRange regionTrackChange(const QVector<RegionTrack>& before, const QVector<RegionTrack>& after);
+    static TimeRange overlayChange(const QJsonArray& before, const QJsonArray& after);
+
+private:
+    void onKeyframesChanged();
+    void onRegionTracksChanged();
+    void onGeoOverlaysChanged();
+    void onOverlaysChanged();
+    void invalidate(const TimeRange& range);
+
+    FrameBuffer* m_buffer = nullptr;
+    KeyframeModel* m_keyframes = nullptr;
+    RegionTrackModel* m_regionTracks = nullptr;
+    GeoOverlayModel* m_geoOverlays = nullptr;
+    OverlayManager* m_overlays = nullptr;
+
+    QVector<Keyframe> m_lastKeyframes;
+    QVector<RegionTrack> m_lastRegionTracks;
+    QVector<GeoOverlay> m_lastGeoOverlays;
+    QJsonArray m_lastOverlays;
+    double m_totalDuration = -1.0;
+
+    // The centripetal spline reaches two keyframes either side of a segment
+    static constexpr int KEYFRAME_REACH = 2;
+};
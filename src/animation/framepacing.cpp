@@ -0,0 +1,64 @@
+#include "framepacing.h"
+#include <QVariantList>
+#include <cmath>
+
+void FramePacing::reset() {
+    m_frames = 0;
+    m_dropped = 0;
+    m_sumMs = 0.0;
+    m_sumSqMs = 0.0;
+    m_maxMs = 0.0;
+    m_histogram.fill(0);
+}
+
+void FramePacing::addInterval(double intervalMs) {
+    if (intervalMs <= 0.0) return;
+
+    m_frames++;
+    m_sumMs += intervalMs;
+    m_sumSqMs += intervalMs * intervalMs;
+    m_maxMs = qMax(m_maxMs, intervalMs);
+
+    // An interval spanning N refresh periods means N - 1 vblanks were missed
+    if (m_expectedMs > 0.0) {
+        int periods = static_cast<int>(std::lround(intervalMs / m_expectedMs));
+        if (periods > 1) {
+            m_dropped += periods - 1;
+        }
+    }
+
+    double jitter = std::abs(intervalMs - m_expectedMs);
+    int bucket = BUCKET_COUNT - 1;
+    for (int i = 0; i < BUCKET_COUNT - 1; ++i) {
+        if (jitter < BUCKET_LIMITS[i]) {
+            bucket = i;
+            break;
+        }
+    }
+    m_histogram[bucket]++;
+}
+
+QVariantMap FramePacing::toVariantMap() const {
+    double mean = meanInterval();
+    double variance = m_frames > 0 ? m_sumSqMs / m_frames - mean * mean : 0.0;
+
+    QVariantList histogram;
+    for (int count : m_histogram) {
+        histogram.append(count);
+    }
+    QVariantList limits;
+    for (double limit : BUCKET_LIMITS) {
+        limits.append(limit);
+    }
+
+    QVariantMap map;
+    map["frames"] = m_frames;
+    map["droppedFrames"] = m_dropped;
+    map["expectedInterval"] = m_expectedMs;
+    map["meanInterval"] = mean;
+    map["maxInterval"] = m_maxMs;
+    map["jitter"] = std::sqrt(qMax(0.0, variance));
+    map["jitterHistogram"] = histogram;
+    map["jitterBucketLimits"] = limits;
+    return map;
+}
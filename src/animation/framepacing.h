@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QVariantMap>
+#include <array>
+
+// Collects present-to-present intervals during playback so stutter can be
+// measured instead of eyeballed. Plain value type, owned by AnimationController.
+class FramePacing {
+public:
+    // Upper bounds (ms) of the jitter histogram buckets; the last bucket is open
+    static constexpr int BUCKET_COUNT = 6;
+    static constexpr double BUCKET_LIMITS[BUCKET_COUNT - 1] = {0.5, 1.0, 2.0, 4.0, 8.0};
+
+    void reset();
+    void setExpectedInterval(double intervalMs) { m_expectedMs = intervalMs; }
+    double expectedInterval() const { return m_expectedMs; }
+
+    // Record the time between two consecutive presented frames
+    void addInterval(double intervalMs);
+
+    int frameCount() const { return m_frames; }
+    int droppedFrames() const { return m_dropped; }
+    double meanInterval() const { return m_frames > 0 ? m_sumMs / m_frames : 0.0; }
+    double maxInterval() const { return m_maxMs; }
+
+    QVariantMap toVariantMap() const;
+
+private:
+    double m_expectedMs = 1000.0 / 60.0;
+    int m_frames = 0;
+    int m_dropped = 0;
+    double m_sumMs = 0.0;
+    double m_sumSqMs = 0.0;
+    double m_maxMs = 0.0;
+    std::array<int, BUCKET_COUNT> m_histogram = {};
+};
@@ -0,0 +1,315 @@
+#include "framestore.h"
+#include "../export/qoicodec.h"
+#include <QDebug>
+#include <QDir>
+#include <QSemaphore>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+#include <cstring>
+
+namespace {
+
+struct BandHeader {
+    quint32 width;
+    quint32 height;
+    quint32 format;
+    quint32 bandRows;
+    quint32 bandCount;
+};
+
+}  // namespace
+
+FrameStore::FrameStore()
+    : m_spillFile(QDir::tempPath() + "/kortanimator-frames-XXXXXX")
+{
+    m_pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+FrameStore::~FrameStore() {
+    closeSpillFile();
+}
+
+void FrameStore::setMemoryBudget(qint64 bytes) {
+    m_memoryBudget = qMax<qint64>(0, bytes);
+    enforceBudget(-1);
+}
+
+void FrameStore::setSpillBudget(qint64 bytes) {
+    bytes = qMax<qint64>(0, bytes);
+    if (bytes == m_spillBudget) return;
+
+    // The ring wraps at the budget; start over with a fresh file
+    dropSpilled();
+    closeSpillFile();
+    m_spillBudget = bytes;
+    m_spillFailed = false;
+}
+
+void FrameStore::dropSpilled() {
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->data.isNull()) {
+            m_totalBytes -= it->size;
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+qint64 FrameStore::averageFrameBytes() const {
+    if (m_entries.isEmpty()) return 0;
+    return m_totalBytes / m_entries.size();
+}
+
+void FrameStore::insert(int index, const QByteArray& data) {
+    remove(index);
+
+    Entry entry;
+    entry.data = data;
+    entry.size = data.size();
+    entry.lastUse = ++m_clock;
+    m_entries.insert(index, entry);
+    m_memoryBytes += entry.size;
+    m_totalBytes += entry.size;
+
+    enforceBudget(index);
+}
+
+QByteArray FrameStore::get(int index) {
+    auto it = m_entries.find(index);
+    if (it == m_entries.end()) return QByteArray();
+
+    it->lastUse = ++m_clock;
+    if (!it->data.isNull()) return it->data;
+
+    // Spilled frames are copied out of the mapping and stay where they are;
+    // promoting them would just push the next frame out in their place
+    return QByteArray(reinterpret_cast<const char*>(m_spillMap + it->spillOffset), it->size);
+}
+
+void FrameStore::remove(int index) {
+    auto it = m_entries.find(index);
+    if (it == m_entries.end()) return;
+    if (!it->data.isNull()) m_memoryBytes -= it->size;
+    m_totalBytes -= it->size;
+    m_entries.erase(it);
+}
+
+void FrameStore::clear() {
+    m_entries.clear();
+    m_memoryBytes = 0;
+    m_totalBytes = 0;
+    m_spillHead = 0;
+    m_playhead = -1;
+}
+
+void FrameStore::enforceBudget(int keep) {
+    while (m_memoryBytes > m_memoryBudget) {
+        int victim = pickVictim(keep);
+        if (victim < 0) break;
+
+        auto it = m_entries.find(victim);
+        const qint64 size = it->size;
+        m_memoryBytes -= size;
+        if (!spill(victim, *it)) {
+            // A failed spill may have dropped other entries; find it again
+            m_totalBytes -= size;
+            m_entries.remove(victim);
+        }
+    }
+}
+
+int FrameStore::pickVictim(int keep) const {
+    int victim = -1;
+    qint64 worst = -1;
+    const bool cyclic = m_playhead >= 0 && m_loopLength > 0;
+
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        if (it.key() == keep || it->data.isNull()) continue;
+
+        // Larger score = needed later
+        qint64 score;
+        if (cyclic) {
+            score = ((it.key() - m_playhead) % m_loopLength + m_loopLength) % m_loopLength;
+        } else {
+            score = static_cast<qint64>(m_clock - it->lastUse);
+        }
+        if (score > worst) {
+            worst = score;
+            victim = it.key();
+        }
+    }
+    return victim;
+}
+
+bool FrameStore::spill(int index, Entry& entry) {
+    if (entry.size > m_spillBudget || m_spillFailed) return false;
+
+    if (m_spillHead + entry.size > m_spillBudget) {
+        m_spillHead = 0;
+    }
+    const qint64 begin = m_spillHead;
+    const qint64 end = begin + entry.size;
+    if (!growSpillFile(end)) return false;
+
+    // Drop whatever the ring is about to overwrite
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it.key() != index && it->data.isNull()
+            && it->spillOffset < end && it->spillOffset + it->size > begin) {
+            m_totalBytes -= it->size;
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // erase() above may have rehashed; look the entry up again
+    Entry& spilled = m_entries[index];
+    std::memcpy(m_spillMap + begin, spilled.data.constData(), spilled.size);
+    spilled.spillOffset = begin;
+    spilled.data = QByteArray();
+    m_spillHead = end;
+    return true;
+}
+
+bool FrameStore::growSpillFile(qint64 size) {
+    if (size <= m_spillSize) return true;
+    if (m_spillFailed) return false;
+
+    if (!m_spillFile.isOpen() && !m_spillFile.open()) {
+        qWarning() << "FrameStore: cannot create spill file:" << m_spillFile.errorString();
+        m_spillFailed = true;
+        return false;
+    }
+
+    // Grown in steps rather than reserved up front, which filesystems
+    // without sparse files would allocate in full. Remapping is safe:
+    // get() copies frames out and keeps no pointers into the mapping.
+    const qint64 newSize = qMin(m_spillBudget, qMax(size, m_spillSize + SPILL_GROWTH));
+    if (m_spillMap) {
+        m_spillFile.unmap(m_spillMap);
+        m_spillMap = nullptr;
+    }
+    if (m_spillFile.resize(newSize)) {
+        m_spillMap = m_spillFile.map(0, newSize);
+    }
+    if (!m_spillMap) {
+        qWarning() << "FrameStore: cannot grow spill file:" << m_spillFile.errorString();
+        m_spillFailed = true;
+        dropSpilled();
+        closeSpillFile();
+        return false;
+    }
+    m_spillSize = newSize;
+    return true;
+}
+
+void FrameStore::closeSpillFile() {
+    if (m_spillMap) {
+        m_spillFile.unmap(m_spillMap);
+        m_spillMap = nullptr;
+    }
+    if (m_spillFile.isOpen()) {
+        m_spillFile.resize(0);
+        m_spillFile.close();
+    }
+    m_spillSize = 0;
+    m_spillHead = 0;
+}
+
+template <typename BandFn>
+void FrameStore::forEachBand(int bands, BandFn fn) const {
+    // Count our own tasks; encode and decode may share the pool concurrently
+    QSemaphore done;
+    for (int band = 0; band < bands; ++band) {
+        m_pool.start([&done, fn, band]() {
+            fn(band);
+            done.release();
+        });
+    }
+    done.acquire(bands);
+}
+
+QByteArray FrameStore::encode(const QImage& frame) const {
+    QImage img = frame;
+    if (img.depth() != 32) {
+        img = img.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    const int width = img.width();
+    const int height = img.height();
+    const int bands = (height + BAND_ROWS - 1) / BAND_ROWS;
+    const uchar* bits = img.constBits();
+    const qsizetype stride = img.bytesPerLine();
+
+    QVector<QByteArray> chunks(bands);
+    QByteArray* chunkData = chunks.data();
+    forEachBand(bands, [=](int band) {
+        const int y0 = band * BAND_ROWS;
+        const int rows = qMin(BAND_ROWS, height - y0);
+        QByteArray& out = chunkData[band];
+        out.reserve(static_cast<qsizetype>(width) * rows);
+        QoiCodec::encodeRows(out, bits + y0 * stride, stride, width, rows);
+    });
+
+    // Header, then the end offset of every band, then the bands back to back
+    BandHeader header = {quint32(width), quint32(height), quint32(img.format()),
+                         quint32(BAND_ROWS), quint32(bands)};
+    QVector<quint32> ends(bands);
+    quint32 offset = 0;
+    for (int band = 0; band < bands; ++band) {
+        offset += chunks[band].size();
+        ends[band] = offset;
+    }
+
+    QByteArray data;
+    data.reserve(sizeof(header) + bands * sizeof(quint32) + offset);
+    data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    data.append(reinterpret_cast<const char*>(ends.constData()), bands * sizeof(quint32));
+    for (const QByteArray& chunk : chunks) {
+        data.append(chunk);
+    }
+    return data;
+}
+
+QImage FrameStore::decode(const QByteArray& data) const {
+    if (data.size() < static_cast<qsizetype>(sizeof(BandHeader))) return QImage();
+
+    BandHeader header;
+    std::memcpy(&header, data.constData(), sizeof(header));
+    const int bands = static_cast<int>(header.bandCount);
+    const int bandRows = static_cast<int>(header.bandRows);
+    const int width = static_cast<int>(header.width);
+    const int height = static_cast<int>(header.height);
+    const qsizetype tableEnd = sizeof(header) + static_cast<qsizetype>(bands) * sizeof(quint32);
+    if (bandRows <= 0 || bands != (height + bandRows - 1) / bandRows || data.size() < tableEnd) {
+        return QImage();
+    }
+
+    QVector<quint32> ends(bands);
+    std::memcpy(ends.data(), data.constData() + sizeof(header), bands * sizeof(quint32));
+    const qsizetype payloadSize = data.size() - tableEnd;
+
+    QImage img(width, height, static_cast<QImage::Format>(header.format));
+    if (img.isNull()) return QImage();
+
+    uchar* bits = img.bits();
+    const qsizetype stride = img.bytesPerLine();
+    const uchar* payload = reinterpret_cast<const uchar*>(data.constData()) + tableEnd;
+    const quint32* endData = ends.constData();
+    std::atomic<bool> ok{true};
+    std::atomic<bool>* okFlag = &ok;
+
+    forEachBand(bands, [=](int band) {
+        const quint32 begin = band > 0 ? endData[band - 1] : 0;
+        const quint32 end = endData[band];
+        const int y0 = band * bandRows;
+        const int rows = qMin(bandRows, height - y0);
+        if (end < begin || end > payloadSize || !QoiCodec::decodeRows(payload + begin, end - begin,
+                                                 bits + y0 * stride, stride, width, rows)) {
+            okFlag->store(false);
+        }
+    });
+
+    return ok ? img : QImage();
+}
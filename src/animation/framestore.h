@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QTemporaryFile>
+#include <QThreadPool>
+
+// Compressed frame storage behind FrameBuffer. Frames are split into bands
+// of BAND_ROWS rows, each QOI-coded on its own so encode and decode run in
+// parallel. Memory beyond the budget spills into a memory-mapped scratch
+// file used as a ring; frames that fall off the ring are dropped. The file
+// grows with what is spilled, up to the spill budget.
+//
+// Eviction knows playback loops: with a playhead set, the frame whose next
+// use lies furthest ahead (cyclically) goes first. Without one it is LRU.
+//
+// Not locked: FrameBuffer serialises access. encode()/decode() touch no
+// state and are meant to be called outside that lock.
+class FrameStore {
+public:
+    FrameStore();
+    ~FrameStore();
+
+    void setMemoryBudget(qint64 bytes);
+    void setSpillBudget(qint64 bytes);
+    qint64 memoryBudget() const { return m_memoryBudget; }
+    qint64 spillBudget() const { return m_spillBudget; }
+
+    // Frame count of one loop, for cyclic distances
+    void setLoopLength(int frames) { m_loopLength = frames; }
+    void setPlayhead(int index) { m_playhead = index; }
+
+    bool contains(int index) const { return m_entries.contains(index); }
+    int count() const { return m_entries.size(); }
+    QList<int> indices() const { return m_entries.keys(); }
+    qint64 averageFrameBytes() const;
+
+    void insert(int index, const QByteArray& data);
+    QByteArray get(int index);
+    void remove(int index);
+    void clear();
+
+    QByteArray encode(const QImage& frame) const;
+    QImage decode(const QByteArray& data) const;
+
+private:
+    struct Entry {
+        QByteArray data;          // null while spilled
+        qint64 spillOffset = -1;
+        qint64 size = 0;
+        quint64 lastUse = 0;
+    };
+
+    void enforceBudget(int keep);
+    int pickVictim(int keep) const;
+    bool spill(int index, Entry& entry);
+    bool growSpillFile(qint64 size);
+    void dropSpilled();
+    void closeSpillFile();
+
+    template <typename BandFn>
+    void forEachBand(int bands, BandFn fn) const;
+
+    QHash<int, Entry> m_entries;
+    qint64 m_memoryBudget = 512LL * 1024 * 1024;
+    qint64 m_spillBudget = 0;
+    qint64 m_memoryBytes = 0;
+    qint64 m_totalBytes = 0;
+    quint64 m_clock = 0;
+    int m_loopLength = 0;
+    int m_playhead = -1;
+
+    QTemporaryFile m_spillFile;
+    uchar* m_spillMap = nullptr;
+    qint64 m_spillSize = 0;       // Mapped length, at most m_spillBudget
+    qint64 m_spillHead = 0;
+    bool m_spillFailed = false;
+
+    mutable QThreadPool m_pool;
+
+    static constexpr int BAND_ROWS = 64;
+    static constexpr qint64 SPILL_GROWTH = 64LL * 1024 * 1024;
+};
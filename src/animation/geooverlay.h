@@ -110,6 +110,7 @@ struct GeoOverlay {
 
     // Legacy: Unified property keyframes (deprecated, kept for compatibility)
     QVector<OverlayKeyframe> keyframes;
+    TrackCursor keyframeCursor;
 
     // New: Per-property keyframe tracks for independent animation
     OverlayPropertyTracks propertyTracks;
@@ -127,11 +128,17 @@ struct GeoOverlay {
 
         // Use per-property tracks if any have keyframes
         if (propertyTracks.hasAnyKeyframes()) {
-            kf.opacity = OverlayPropertyTracks::interpolateValue(propertyTracks.opacity, timeMs, 1.0);
-            kf.extrusion = OverlayPropertyTracks::interpolateValue(propertyTracks.extrusion, timeMs, 0.0);
-            kf.scale = OverlayPropertyTracks::interpolateValue(propertyTracks.scale, timeMs, 1.0);
-            kf.fillColor = OverlayPropertyTracks::interpolateColor(propertyTracks.fillColor, timeMs, fillColor);
-            kf.borderColor = OverlayPropertyTracks::interpolateColor(propertyTracks.borderColor, timeMs, borderColor);
+            const auto& tracks = propertyTracks;
+            kf.opacity = OverlayPropertyTracks::interpolateValue(tracks.opacity, timeMs, 1.0,
+                                                                 &tracks.cursors.opacity);
+            kf.extrusion = OverlayPropertyTracks::interpolateValue(tracks.extrusion, timeMs, 0.0,
+                                                                   &tracks.cursors.extrusion);
+            kf.scale = OverlayPropertyTracks::interpolateValue(tracks.scale, timeMs, 1.0,
+                                                               &tracks.cursors.scale);
+            kf.fillColor = OverlayPropertyTracks::interpolateColor(tracks.fillColor, timeMs, fillColor,
+                                                                   &tracks.cursors.fillColor);
+            kf.borderColor = OverlayPropertyTracks::interpolateColor(tracks.borderColor, timeMs, borderColor,
+                                                                     &tracks.cursors.borderColor);
             return kf;
         }
 
@@ -154,17 +161,7 @@ struct GeoOverlay {
         }
 
         // Find surrounding keyframes
-        int beforeIdx = -1;
-        int afterIdx = -1;
-
-        for (int i = 0; i < keyframes.size(); ++i) {
-            if (keyframes[i].timeMs <= timeMs) {
-                beforeIdx = i;
-            }
-            if (keyframes[i].timeMs > timeMs && afterIdx < 0) {
-                afterIdx = i;
-            }
-        }
+        int beforeIdx = TrackLookup::segmentAt(keyframes, timeMs, &keyframeCursor);
 
         // Before first keyframe - use first keyframe values
         if (beforeIdx < 0) {
@@ -174,7 +171,7 @@ struct GeoOverlay {
         }
 
         // After last keyframe - use last keyframe values
-        if (afterIdx < 0) {
+        if (beforeIdx == keyframes.size() - 1) {
             kf = keyframes.last();
             kf.timeMs = timeMs;
             return kf;
@@ -182,7 +179,7 @@ struct GeoOverlay {
 
         // Interpolate between keyframes
         const OverlayKeyframe& from = keyframes[beforeIdx];
-        const OverlayKeyframe& to = keyframes[afterIdx];
+        const OverlayKeyframe& to = keyframes[beforeIdx + 1];
 
         double duration = to.timeMs - from.timeMs;
         double progress = (duration > 0) ? (timeMs - from.timeMs) / duration : 0.0;
@@ -303,6 +300,8 @@ struct GeoOverlay {
             for (const auto& kfVal : kfArray) {
                 overlay.keyframes.append(OverlayKeyframe::fromJson(kfVal.toObject()));
             }
+            std::sort(overlay.keyframes.begin(), overlay.keyframes.end(),
+                      [](const OverlayKeyframe& a, const OverlayKeyframe& b) { return a.timeMs < b.timeMs; });
         }
 
         // Deserialize per-property tracks
@@ -1,6 +1,7 @@
 #include "geooverlaymodel.h"
 #include "../map/geojsonparser.h"
 #include "../map/cityboundaryfetcher.h"
+#include "../map/polygonclip.h"
 #include <QJsonArray>
 #include <QUuid>
 #include <QFile>
@@ -32,7 +33,7 @@ QVector<QPolygonF> parseNominatimCoordinates(const QJsonArray& coordinates, cons
             QJsonArray outerRing = coordinates[0].toArray();
             QPolygonF poly = parseRing(outerRing);
             if (!poly.isEmpty()) {
-                result.append(poly);
+                result += PolygonClip::splitGeoRing(poly);
             }
         }
     } else if (geometryType == "MultiPolygon") {
@@ -43,7 +44,7 @@ QVector<QPolygonF> parseNominatimCoordinates(const QJsonArray& coordinates, cons
                 QJsonArray outerRing = polygonCoords[0].toArray();
                 QPolygonF poly = parseRing(outerRing);
                 if (!poly.isEmpty()) {
-                    result.append(poly);
+                    result += PolygonClip::splitGeoRing(poly);
                 }
             }
         }
@@ -55,6 +56,14 @@ QVector<QPolygonF> parseNominatimCoordinates(const QJsonArray& coordinates, cons
 GeoOverlayModel::GeoOverlayModel(QObject* parent)
     : QAbstractListModel(parent)
 {
+    // Any structural or content change outdates the active-window index
+    auto staleIndex = [this]() { m_activeIndexDirty = true; };
+    connect(this, &GeoOverlayModel::dataModified, this, staleIndex);
+    connect(this, &QAbstractListModel::dataChanged, this, staleIndex);
+    connect(this, &QAbstractListModel::rowsInserted, this, staleIndex);
+    connect(this, &QAbstractListModel::rowsRemoved, this, staleIndex);
+    connect(this, &QAbstractListModel::rowsMoved, this, staleIndex);
+    connect(this, &QAbstractListModel::modelReset, this, staleIndex);
 }
 
 int GeoOverlayModel::rowCount(const QModelIndex& parent) const {
@@ -475,11 +484,29 @@ double GeoOverlayModel::overlayOpacityAtTime(int index, double timeMs, double to
     return m_overlays.at(index).opacityAtTime(timeMs, totalDuration);
 }
 
+const IntervalIndex& GeoOverlayModel::activeIndex() const {
+    if (m_activeIndexDirty || m_activeIndex.itemCount() != m_overlays.size()) {
+        // Open-ended windows depend on the timeline length; leaving them
+        // unbounded keeps the index valid when the duration changes
+        m_activeIndex.clear();
+        for (const auto& overlay : m_overlays) {
+            double end = overlay.endTime > 0 ? overlay.endTime + qMax(0.0, overlay.fadeOutDuration)
+                                             : IntervalIndex::OPEN_END;
+            m_activeIndex.add(overlay.startTime, end);
+        }
+        m_activeIndex.build();
+        m_activeIndexDirty = false;
+    }
+    return m_activeIndex;
+}
+
 QVector<QPair<const GeoOverlay*, double>> GeoOverlayModel::visibleOverlaysAtTime(
         double timeMs, double totalDuration) const {
     QVector<QPair<const GeoOverlay*, double>> result;
 
-    for (const auto& overlay : m_overlays) {
+    activeIndex().query(timeMs, m_activeItems);
+    for (int index : m_activeItems) {
+        const GeoOverlay& overlay = m_overlays.at(index);
         double opacity = overlay.opacityAtTime(timeMs, totalDuration);
         if (opacity > 0.0) {
             result.append({&overlay, opacity});
@@ -497,6 +524,13 @@ QJsonArray GeoOverlayModel::toJson() const {
     return array;
 }
 
+void GeoOverlayModel::setOverlays(const QVector<GeoOverlay>& overlays) {
+    beginResetModel();
+    m_overlays = overlays;
+    endResetModel();
+    emit countChanged();
+}
+
 void GeoOverlayModel::fromJson(const QJsonArray& array) {
     beginResetModel();
     m_overlays.clear();
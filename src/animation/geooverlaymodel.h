@@ -4,6 +4,7 @@
 #include <QVector>
 #include <QColor>
 #include "geooverlay.h"
+#include "intervalindex.h"
 
 class GeoJsonParser;
 class CityBoundaryFetcher;
@@ -85,6 +86,7 @@ public:
     Q_INVOKABLE double overlayOpacityAtTime(int index, double timeMs, double totalDuration) const;
 
     // Get all visible overlays at a given time with their opacities
+    // Only overlays whose window (fades included) covers timeMs are evaluated
     QVector<QPair<const GeoOverlay*, double>> visibleOverlaysAtTime(double timeMs, double totalDuration) const;
 
     // Legacy keyframe management
@@ -122,6 +124,7 @@ public:
 
     int count() const { return m_overlays.size(); }
     const QVector<GeoOverlay>& overlays() const { return m_overlays; }
+    void setOverlays(const QVector<GeoOverlay>& overlays);  // Geometry must already be resolved
 
     // Selection
     int selectedIndex() const { return m_selectedIndex; }
@@ -152,7 +155,12 @@ private:
     void sortKeyframes(int overlayIndex);
     void loadCityBoundaryFromCache(GeoOverlay& overlay);  // Load boundary from stored JSON
 
+    const IntervalIndex& activeIndex() const;
+
     QVector<GeoOverlay> m_overlays;
+    mutable IntervalIndex m_activeIndex;
+    mutable QVector<int> m_activeItems;
+    mutable bool m_activeIndexDirty = true;
     GeoJsonParser* m_geoJson = nullptr;
     CityBoundaryFetcher* m_boundaryFetcher = nullptr;
     double m_currentTime = 0.0;
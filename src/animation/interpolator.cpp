@@ -1,4 +1,5 @@
 #include "interpolator.h"
+#include "../map/mapcamera.h"
 #include <QtMath>
 #include <cmath>
 
@@ -7,9 +8,14 @@ Interpolator::Interpolator(QObject* parent)
 {
 }
 
-CameraState Interpolator::interpolate(const Keyframe& from, const Keyframe& to, double t) {
+CameraState Interpolator::interpolate(const Keyframe& from, const Keyframe& to, double t, bool linearMode,
+                                      double viewWidth) {
     // Apply easing unless in linear mode (speed curve handles timing)
-    double easedT = m_linearMode ? t : adaptiveEaseInOut(t, from.easing, from.altitude, to.altitude);
+    double easedT = linearMode ? t : adaptiveEaseInOut(t, from.easing, from.altitude, to.altitude);
+
+    if (from.transition == Keyframe::ZoomPanFlight) {
+        return zoomPan(from, to, easedT, viewWidth);
+    }
 
     CameraState state;
 
@@ -25,6 +31,72 @@ CameraState Interpolator::interpolate(const Keyframe& from, const Keyframe& to,
     return state;
 }
 
+double Interpolator::groundWidth(double altitude, double viewWidth) {
+    // The world is 2^zoom tiles wide and zoom = log2(ALTITUDE_BASE / altitude)
+    return viewWidth * EARTH_CIRCUMFERENCE * altitude / (MapCamera::TILE_SIZE * Keyframe::ALTITUDE_BASE);
+}
+
+CameraState Interpolator::zoomPan(const Keyframe& from, const Keyframe& to, double t, double viewWidth) {
+    const double rho = ZOOM_PAN_RHO;
+    const double rho2 = rho * rho;
+
+    // Work in ground metres: u is distance along the great circle, w the view width
+    const double u1 = greatCircleDistance(from.latitude, from.longitude, to.latitude, to.longitude) * 1000.0;
+    const double widthPerAltitude = groundWidth(1.0, qMax(viewWidth, 1.0));
+    const double w0 = qMax(from.altitude, 1.0) * widthPerAltitude;
+    const double w1 = qMax(to.altitude, 1.0) * widthPerAltitude;
+
+    double u = 0.0;
+    double w = w0;
+
+    if (u1 < 1.0) {
+        // Pure zoom: exponential in width
+        w = w0 * std::pow(w1 / w0, t);
+    } else {
+        const double b0 = (w1 * w1 - w0 * w0 + rho2 * rho2 * u1 * u1) / (2.0 * w0 * rho2 * u1);
+        const double b1 = (w1 * w1 - w0 * w0 - rho2 * rho2 * u1 * u1) / (2.0 * w1 * rho2 * u1);
+        const double r0 = std::log(-b0 + std::sqrt(b0 * b0 + 1.0));
+        const double r1 = std::log(-b1 + std::sqrt(b1 * b1 + 1.0));
+        const double S = (r1 - r0) / rho;
+
+        const double s = t * S;
+        const double coshR0 = std::cosh(r0);
+        u = w0 / rho2 * (coshR0 * std::tanh(rho * s + r0) - std::sinh(r0));
+        w = w0 * coshR0 / std::cosh(rho * s + r0);
+    }
+
+    CameraState state;
+
+    // Position: slerp along the great circle by the travelled fraction
+    double f = u1 < 1.0 ? 0.0 : qBound(0.0, u / u1, 1.0);
+    double lat0 = qDegreesToRadians(from.latitude), lon0 = qDegreesToRadians(from.longitude);
+    double lat1 = qDegreesToRadians(to.latitude), lon1 = qDegreesToRadians(to.longitude);
+    double angle = u1 / 6371000.0;
+    if (angle > 1e-9) {
+        double a = std::sin((1.0 - f) * angle) / std::sin(angle);
+        double b = std::sin(f * angle) / std::sin(angle);
+        double x = a * std::cos(lat0) * std::cos(lon0) + b * std::cos(lat1) * std::cos(lon1);
+        double y = a * std::cos(lat0) * std::sin(lon0) + b * std::cos(lat1) * std::sin(lon1);
+        double z = a * std::sin(lat0) + b * std::sin(lat1);
+        state.latitude = qRadiansToDegrees(std::atan2(z, std::sqrt(x * x + y * y)));
+        state.longitude = qRadiansToDegrees(std::atan2(y, x));
+    } else {
+        state.latitude = from.latitude;
+        state.longitude = from.longitude;
+    }
+
+    state.altitude = w / widthPerAltitude;
+
+    // Orientation follows the path parameter
+    double diff = to.bearing - from.bearing;
+    while (diff > 180.0) diff -= 360.0;
+    while (diff < -180.0) diff += 360.0;
+    state.bearing = std::fmod(from.bearing + diff * t + 360.0, 360.0);
+    state.tilt = from.tilt + (to.tilt - from.tilt) * t;
+
+    return state;
+}
+
 double Interpolator::adaptiveEaseInOut(double t, double smoothness, double fromAlt, double toAlt) {
     // Calculate altitude factor: closer to ground = higher factor
     // Use minimum altitude of the transition for smoothness
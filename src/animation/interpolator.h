@@ -24,7 +24,14 @@ public:
     explicit Interpolator(QObject* parent = nullptr);
 
     // Main interpolation function - simple ease-in-out between keyframes
-    CameraState interpolate(const Keyframe& from, const Keyframe& to, double t);
+    CameraState interpolate(const Keyframe& from, const Keyframe& to, double t) const {
+        return interpolate(from, to, t, m_linearMode);
+    }
+
+    // Reentrant form for evaluation off the GUI thread. viewWidth is the map
+    // view's width in pixels, which zoom-pan flights are shaped for.
+    static CameraState interpolate(const Keyframe& from, const Keyframe& to, double t, bool linearMode,
+                                   double viewWidth = DEFAULT_VIEW_WIDTH);
 
     // Linear mode: skip per-keyframe easing (use with speed curve)
     bool linearMode() const { return m_linearMode; }
@@ -34,15 +41,29 @@ public:
     static double easeInOut(double t);
     static double adaptiveEaseInOut(double t, double smoothness, double fromAlt, double toAlt);
 
+    // Van Wijk & Nuij "smooth and efficient zooming and panning" between two
+    // views at path parameter t (0..1); zooms out first on long hops
+    static CameraState zoomPan(const Keyframe& from, const Keyframe& to, double t,
+                               double viewWidth = DEFAULT_VIEW_WIDTH);
+
+    // Ground width in metres a view viewWidth pixels wide shows at the
+    // equator from this altitude, as MapCamera projects it
+    static double groundWidth(double altitude, double viewWidth);
+
+    static constexpr double DEFAULT_VIEW_WIDTH = 1920.0;
+
     // Utility functions
     static double greatCircleDistance(double lat1, double lon1, double lat2, double lon2);
 
 private:
     // Helper for longitude wrapping (handles crossing 180/-180)
-    double interpolateLongitude(double from, double to, double t);
+    static double interpolateLongitude(double from, double to, double t);
 
     // Bearing interpolation (shortest path around circle)
-    double interpolateBearing(double from, double to, double t);
+    static double interpolateBearing(double from, double to, double t);
 
     bool m_linearMode = false;
+
+    static constexpr double ZOOM_PAN_RHO = 1.42;  // Zoom/pan trade-off recommended by Van Wijk & Nuij
+    static constexpr double EARTH_CIRCUMFERENCE = 40075016.686;  // Web Mercator equator in metres
 };
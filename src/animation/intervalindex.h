@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QVector>
+#include <algorithm>
+#include <limits>
+
+// Static interval tree answering "which items are active at time t".
+// Windows are sorted by start and an implicit binary tree over that order
+// keeps the latest end in each subtree, so a query only descends where an
+// active window can still be: O(log n + k) for k hits instead of a scan of
+// every item. Hits come back in item order (the order of add() calls),
+// which the models use as draw order.
+class IntervalIndex {
+public:
+    static constexpr double OPEN_END = std::numeric_limits<double>::infinity();
+
+    void clear() {
+        m_windows.clear();
+        m_maxEnd.clear();
+        m_items = 0;
+    }
+
+    // Item ids are assigned in call order. Empty windows (end < start) are
+    // counted but never returned.
+    void add(double start, double end) {
+        if (end >= start) {
+            m_windows.append({start, end, m_items});
+        }
+        m_items++;
+    }
+
+    void build() {
+        std::sort(m_windows.begin(), m_windows.end(),
+                  [](const Window& a, const Window& b) { return a.start < b.start; });
+        m_maxEnd.fill(-OPEN_END, qMax(1, 4 * static_cast<int>(m_windows.size())));
+        if (!m_windows.isEmpty()) {
+            buildNode(1, 0, m_windows.size());
+        }
+    }
+
+    int itemCount() const { return m_items; }
+
+    // Items whose window contains timeMs (both ends inclusive), ascending
+    void query(double timeMs, QVector<int>& out) const {
+        out.clear();
+        auto it = std::upper_bound(m_windows.begin(), m_windows.end(), timeMs,
+                                   [](double t, const Window& w) { return t < w.start; });
+        const int limit = static_cast<int>(it - m_windows.begin());
+        if (limit > 0) {
+            collect(1, 0, m_windows.size(), limit, timeMs, out);
+            std::sort(out.begin(), out.end());
+        }
+    }
+
+private:
+    struct Window {
+        double start;
+        double end;
+        int item;
+    };
+
+    double buildNode(int node, int lo, int hi) {
+        if (hi - lo == 1) {
+            return m_maxEnd[node] = m_windows[lo].end;
+        }
+        int mid = (lo + hi) / 2;
+        return m_maxEnd[node] = qMax(buildNode(2 * node, lo, mid), buildNode(2 * node + 1, mid, hi));
+    }
+
+    // Windows [lo, hi) all start at or before timeMs when hi <= limit
+    void collect(int node, int lo, int hi, int limit, double timeMs, QVector<int>& out) const {
+        if (lo >= limit || m_maxEnd[node] < timeMs) return;
+        if (hi - lo == 1) {
+            out.append(m_windows[lo].item);
+            return;
+        }
+        int mid = (lo + hi) / 2;
+        collect(2 * node, lo, mid, limit, timeMs, out);
+        collect(2 * node + 1, mid, hi, limit, timeMs, out);
+    }
+
+    QVector<Window> m_windows;
+    QVector<double> m_maxEnd;  // Per tree node, heap layout from node 1
+    int m_items = 0;
+};
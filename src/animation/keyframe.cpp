@@ -11,6 +11,7 @@ QJsonObject Keyframe::toJson() const {
     obj["tilt"] = tilt;
     obj["timeMs"] = timeMs;
     obj["easing"] = easing;
+    obj["transition"] = transition == ZoomPanFlight ? "zoomPan" : "direct";
     return obj;
 }
 
@@ -26,6 +27,7 @@ Keyframe Keyframe::fromJson(const QJsonObject& obj) {
         kf.tilt = obj["tilt"].toDouble();
         kf.timeMs = obj["timeMs"].toDouble(0.0);
         kf.easing = obj["easing"].toDouble(0.5);  // Default to medium smoothness
+        kf.transition = obj["transition"].toString() == "zoomPan" ? ZoomPanFlight : DirectFlight;
     } else {
         // Old format with zoom - refuse to load
         qWarning() << "Old keyframe format detected (uses 'zoom' instead of 'altitude'). Please create a new project.";
@@ -18,8 +18,16 @@ class Keyframe {
     Q_PROPERTY(double tilt MEMBER tilt)
     Q_PROPERTY(double timeMs MEMBER timeMs)
     Q_PROPERTY(double easing MEMBER easing)
+    Q_PROPERTY(int transition MEMBER transition)
 
 public:
+    // How the camera travels FROM this keyframe to the next
+    enum Transition {
+        DirectFlight = 0,   // Interpolate position and altitude together
+        ZoomPanFlight       // Van Wijk-Nuij: zoom out, pan, zoom in (for long hops)
+    };
+    Q_ENUM(Transition)
+
     double latitude = 0.0;
     double longitude = 0.0;
     double altitude = 1000000.0;  // Default ~1000km (roughly zoom 5)
@@ -27,6 +35,7 @@ public:
     double tilt = 0.0;
     double timeMs = 0.0;  // Position on timeline (milliseconds)
     double easing = 0.5;  // Easing smoothness for transition FROM this keyframe (0=snappy, 1=very smooth)
+    int transition = DirectFlight;
 
     // Convert between altitude and zoom level
     // Formula: altitude = 2^(25 - zoom) meters
@@ -26,6 +26,7 @@ QVariant KeyframeModel::data(const QModelIndex& index, int role) const {
         case TiltRole: return kf.tilt;
         case TimeRole: return kf.timeMs;
         case EasingRole: return kf.easing;
+        case TransitionRole: return kf.transition;
         default: return QVariant();
     }
 }
@@ -82,6 +83,12 @@ bool KeyframeModel::setData(const QModelIndex& index, const QVariant& value, int
                 changed = true;
             }
             break;
+        case TransitionRole:
+            if (kf.transition != value.toInt()) {
+                kf.transition = value.toInt();
+                changed = true;
+            }
+            break;
     }
 
     if (changed) {
@@ -101,7 +108,8 @@ QHash<int, QByteArray> KeyframeModel::roleNames() const {
         {BearingRole, "bearing"},
         {TiltRole, "tilt"},
         {TimeRole, "time"},
-        {EasingRole, "easing"}
+        {EasingRole, "easing"},
+        {TransitionRole, "transition"}
     };
 }
 
@@ -211,6 +219,7 @@ void KeyframeModel::updateKeyframe(int index, const QVariantMap& data) {
     if (data.contains("bearing")) kf.bearing = data["bearing"].toDouble();
     if (data.contains("tilt")) kf.tilt = data["tilt"].toDouble();
     if (data.contains("easing")) kf.easing = qBound(0.0, data["easing"].toDouble(), 1.0);
+    if (data.contains("transition")) kf.transition = data["transition"].toInt();
     if (data.contains("time")) {
         kf.timeMs = data["time"].toDouble();
         sortByTime();
@@ -235,7 +244,8 @@ QVariantMap KeyframeModel::getKeyframe(int index) const {
         {"bearing", kf.bearing},
         {"tilt", kf.tilt},
         {"time", kf.timeMs},
-        {"easing", kf.easing}
+        {"easing", kf.easing},
+        {"transition", kf.transition}
     };
 }
 
@@ -313,12 +323,8 @@ void KeyframeModel::updateCurrentPosition(double lat, double lon, double zoom, d
 int KeyframeModel::keyframeIndexAtTime(double timeMs) const {
     if (m_keyframes.isEmpty()) return -1;
 
-    for (int i = m_keyframes.size() - 1; i >= 0; i--) {
-        if (timeMs >= m_keyframes[i].timeMs) {
-            return i;
-        }
-    }
-    return 0;
+    // Times before the first keyframe map to it
+    return qMax(0, TrackLookup::segmentAt(m_keyframes, timeMs, &m_lookupCursor));
 }
 
 double KeyframeModel::progressAtTime(double timeMs, int& outFromIndex, int& outToIndex) const {
@@ -362,10 +368,14 @@ int KeyframeModel::keyframeNearTime(double timeMs, double toleranceMs) const {
     return -1;
 }
 
-double KeyframeModel::snapToFrame(double timeMs, int fps) {
-    if (fps <= 0) fps = 30;
-    double frameMs = 1000.0 / fps;
-    return qRound(timeMs / frameMs) * frameMs;
+void KeyframeModel::setFrameRate(const FrameRate& rate) {
+    if (rate.isValid()) {
+        m_frameRate = rate;
+    }
+}
+
+double KeyframeModel::snapToFrame(double timeMs) const {
+    return m_frameRate.frameTimeMs(m_frameRate.nearestFrame(Timebase::fromMs(timeMs)));
 }
 
 void KeyframeModel::sortByTime() {
@@ -4,6 +4,8 @@
 #include <QVector>
 #include <QSet>
 #include "keyframe.h"
+#include "tracklookup.h"
+#include "timebase.h"
 
 class KeyframeModel : public QAbstractListModel {
     Q_OBJECT
@@ -22,7 +24,8 @@ public:
         BearingRole,
         TiltRole,
         TimeRole,
-        EasingRole
+        EasingRole,
+        TransitionRole
     };
 
     explicit KeyframeModel(QObject* parent = nullptr);
@@ -68,8 +71,12 @@ public:
     double progressAtTime(double timeMs, int& outFromIndex, int& outToIndex) const;
     Q_INVOKABLE int keyframeNearTime(double timeMs, double toleranceMs) const;
 
+    // Keyframe times are snapped to exact frame boundaries of this rate
+    void setFrameRate(const FrameRate& rate);
+    FrameRate frameRate() const { return m_frameRate; }
+
     // Snap time to frame boundary
-    Q_INVOKABLE static double snapToFrame(double timeMs, int fps = 30);
+    Q_INVOKABLE double snapToFrame(double timeMs) const;
 
     // Navigation
     Q_INVOKABLE void goToNextKeyframe();
@@ -102,7 +109,9 @@ private:
     void sortByTime();
 
     QVector<Keyframe> m_keyframes;
+    TrackCursor m_lookupCursor;  // Last segment found by keyframeIndexAtTime()
     QSet<int> m_selectedIndices;
+    FrameRate m_frameRate;
     int m_currentIndex = 0;
     bool m_editMode = false;
 
@@ -77,31 +77,22 @@ OverlayKeyframe OverlayKeyframe::fromJson(const QJsonObject& obj) {
 // ============ OverlayPropertyTracks Implementation ============
 
 double OverlayPropertyTracks::interpolateValue(const QVector<PropertyKeyframe>& track,
-                                                double timeMs, double defaultVal) {
+                                                double timeMs, double defaultVal,
+                                                const TrackCursor* cursor) {
     if (track.isEmpty()) return defaultVal;
     if (track.size() == 1) return track.first().value;
 
     // Find surrounding keyframes
-    int beforeIdx = -1;
-    int afterIdx = -1;
-
-    for (int i = 0; i < track.size(); ++i) {
-        if (track[i].timeMs <= timeMs) {
-            beforeIdx = i;
-        }
-        if (track[i].timeMs > timeMs && afterIdx < 0) {
-            afterIdx = i;
-        }
-    }
+    int beforeIdx = TrackLookup::segmentAt(track, timeMs, cursor);
 
     // Before first keyframe
     if (beforeIdx < 0) return track.first().value;
     // After last keyframe
-    if (afterIdx < 0) return track.last().value;
+    if (beforeIdx == track.size() - 1) return track.last().value;
 
     // Interpolate
     const auto& from = track[beforeIdx];
-    const auto& to = track[afterIdx];
+    const auto& to = track[beforeIdx + 1];
     double duration = to.timeMs - from.timeMs;
     double progress = (duration > 0) ? (timeMs - from.timeMs) / duration : 0.0;
 
@@ -112,31 +103,22 @@ double OverlayPropertyTracks::interpolateValue(const QVector<PropertyKeyframe>&
 }
 
 QColor OverlayPropertyTracks::interpolateColor(const QVector<ColorKeyframe>& track,
-                                                double timeMs, const QColor& defaultVal) {
+                                                double timeMs, const QColor& defaultVal,
+                                                const TrackCursor* cursor) {
     if (track.isEmpty()) return defaultVal;
     if (track.size() == 1) return track.first().color;
 
     // Find surrounding keyframes
-    int beforeIdx = -1;
-    int afterIdx = -1;
-
-    for (int i = 0; i < track.size(); ++i) {
-        if (track[i].timeMs <= timeMs) {
-            beforeIdx = i;
-        }
-        if (track[i].timeMs > timeMs && afterIdx < 0) {
-            afterIdx = i;
-        }
-    }
+    int beforeIdx = TrackLookup::segmentAt(track, timeMs, cursor);
 
     // Before first keyframe
     if (beforeIdx < 0) return track.first().color;
     // After last keyframe
-    if (afterIdx < 0) return track.last().color;
+    if (beforeIdx == track.size() - 1) return track.last().color;
 
     // Interpolate
     const auto& from = track[beforeIdx];
-    const auto& to = track[afterIdx];
+    const auto& to = track[beforeIdx + 1];
     double duration = to.timeMs - from.timeMs;
     double progress = (duration > 0) ? (timeMs - from.timeMs) / duration : 0.0;
 
@@ -216,5 +198,7 @@ OverlayPropertyTracks OverlayPropertyTracks::fromJson(const QJsonObject& obj) {
     if (obj.contains("fillColor")) tracks.fillColor = deserializeColorTrack(obj["fillColor"].toArray());
     if (obj.contains("borderColor")) tracks.borderColor = deserializeColorTrack(obj["borderColor"].toArray());
 
+    // Lookups binary-search the tracks, so never trust file order
+    tracks.sortAll();
     return tracks;
 }
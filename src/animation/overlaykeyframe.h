@@ -6,6 +6,7 @@
 #include <QJsonArray>
 #include <QVector>
 #include "../animation/keyframe.h"  // For EasingType
+#include "tracklookup.h"
 
 // Simple keyframe for a single numeric property
 struct PropertyKeyframe {
@@ -64,9 +65,16 @@ struct OverlayPropertyTracks {
     QVector<ColorKeyframe> fillColor;
     QVector<ColorKeyframe> borderColor;
 
+    // Last-segment hints for each track, see TrackCursor
+    struct Cursors {
+        TrackCursor opacity, extrusion, scale, fillColor, borderColor;
+    } cursors;
+
     // Get interpolated value at time
-    static double interpolateValue(const QVector<PropertyKeyframe>& track, double timeMs, double defaultVal);
-    static QColor interpolateColor(const QVector<ColorKeyframe>& track, double timeMs, const QColor& defaultVal);
+    static double interpolateValue(const QVector<PropertyKeyframe>& track, double timeMs, double defaultVal,
+                                   const TrackCursor* cursor = nullptr);
+    static QColor interpolateColor(const QVector<ColorKeyframe>& track, double timeMs, const QColor& defaultVal,
+                                   const TrackCursor* cursor = nullptr);
 
     // Sort all tracks by time
     void sortAll();
@@ -4,6 +4,14 @@
 RegionTrackModel::RegionTrackModel(QObject* parent)
     : QAbstractListModel(parent)
 {
+    // Any structural or content change outdates the active-window index
+    auto staleIndex = [this]() { m_activeIndexDirty = true; };
+    connect(this, &RegionTrackModel::dataModified, this, staleIndex);
+    connect(this, &QAbstractListModel::dataChanged, this, staleIndex);
+    connect(this, &QAbstractListModel::rowsInserted, this, staleIndex);
+    connect(this, &QAbstractListModel::rowsRemoved, this, staleIndex);
+    connect(this, &QAbstractListModel::rowsMoved, this, staleIndex);
+    connect(this, &QAbstractListModel::modelReset, this, staleIndex);
 }
 
 int RegionTrackModel::rowCount(const QModelIndex& parent) const {
@@ -234,11 +242,29 @@ double RegionTrackModel::trackOpacityAtTime(int index, double timeMs, double tot
     return m_tracks.at(index).opacityAtTime(timeMs, totalDuration);
 }
 
+const IntervalIndex& RegionTrackModel::activeIndex() const {
+    if (m_activeIndexDirty || m_activeIndex.itemCount() != m_tracks.size()) {
+        // endTime 0 means "until the timeline end"; unbounded keeps the index
+        // valid when the duration changes
+        m_activeIndex.clear();
+        for (const auto& track : m_tracks) {
+            double end = track.endTime > 0 ? track.endTime + qMax(0.0, track.fadeOutDuration)
+                                           : IntervalIndex::OPEN_END;
+            m_activeIndex.add(track.startTime, end);
+        }
+        m_activeIndex.build();
+        m_activeIndexDirty = false;
+    }
+    return m_activeIndex;
+}
+
 QVector<QPair<const RegionTrack*, double>> RegionTrackModel::visibleTracksAtTime(
         double timeMs, double totalDuration) const {
     QVector<QPair<const RegionTrack*, double>> result;
 
-    for (const auto& track : m_tracks) {
+    activeIndex().query(timeMs, m_activeItems);
+    for (int index : m_activeItems) {
+        const RegionTrack& track = m_tracks.at(index);
         double opacity = track.opacityAtTime(timeMs, totalDuration);
         if (opacity > 0.0) {
             result.append({&track, opacity});
@@ -256,6 +282,13 @@ QJsonArray RegionTrackModel::toJson() const {
     return array;
 }
 
+void RegionTrackModel::setTracks(const QVector<RegionTrack>& tracks) {
+    beginResetModel();
+    m_tracks = tracks;
+    endResetModel();
+    emit countChanged();
+}
+
 void RegionTrackModel::fromJson(const QJsonArray& array) {
     beginResetModel();
     m_tracks.clear();
@@ -4,6 +4,7 @@
 #include <QVector>
 #include <QColor>
 #include "regiontrack.h"
+#include "intervalindex.h"
 
 class RegionTrackModel : public QAbstractListModel {
     Q_OBJECT
@@ -50,10 +51,12 @@ public:
     Q_INVOKABLE double trackOpacityAtTime(int index, double timeMs, double totalDuration) const;
 
     // Get all visible tracks at a given time with their opacities
+    // Only tracks whose window (fades included) covers timeMs are evaluated
     QVector<QPair<const RegionTrack*, double>> visibleTracksAtTime(double timeMs, double totalDuration) const;
 
     int count() const { return m_tracks.size(); }
     const QVector<RegionTrack>& tracks() const { return m_tracks; }
+    void setTracks(const QVector<RegionTrack>& tracks);
 
     // Serialization
     QJsonArray toJson() const;
@@ -65,5 +68,10 @@ signals:
     void dataModified();
 
 private:
+    const IntervalIndex& activeIndex() const;
+
     QVector<RegionTrack> m_tracks;
+    mutable IntervalIndex m_activeIndex;
+    mutable QVector<int> m_activeItems;
+    mutable bool m_activeIndexDirty = true;
 };
@@ -0,0 +1,86 @@
+#include "speedcurvetable.h"
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+
+double SpeedCurveTable::speedAt(const QVector<SpeedPoint>& curve, double timeMs) {
+    if (curve.isEmpty()) return 0.5;  // Default normal speed
+    if (timeMs <= curve.first().time) return curve.first().speed;
+    if (timeMs >= curve.last().time) return curve.last().speed;
+
+    // First point after timeMs; the one before it starts the segment
+    auto it = std::upper_bound(curve.begin(), curve.end(), timeMs,
+                               [](double t, const SpeedPoint& p) { return t < p.time; });
+    const SpeedPoint& to = *it;
+    const SpeedPoint& from = *(it - 1);
+
+    double duration = to.time - from.time;
+    if (duration <= 0) return from.speed;
+    double t = (timeMs - from.time) / duration;
+    return from.speed + t * (to.speed - from.speed);
+}
+
+double SpeedCurveTable::rateAt(const QVector<SpeedPoint>& curve, double timeMs) {
+    // Map 0-1 to 0-2x speed
+    return std::max(MIN_RATE, speedAt(curve, timeMs) * 2.0);
+}
+
+void SpeedCurveTable::clear() {
+    m_wallTimes.clear();
+    m_stepMs = 0.0;
+    m_tailRate = 1.0;
+}
+
+void SpeedCurveTable::rebuild(const QVector<SpeedPoint>& curve, double endTimeMs) {
+    clear();
+
+    double end = endTimeMs;
+    if (!curve.isEmpty()) {
+        end = std::max(end, curve.last().time);
+    }
+    if (end <= 0) return;
+
+    m_stepMs = std::max(SAMPLE_STEP_MS, end / MAX_SAMPLES);
+    int samples = static_cast<int>(std::ceil(end / m_stepMs)) + 1;
+
+    // Integrate dt_wall = dt_anim / rate with the midpoint rule
+    m_wallTimes.resize(samples);
+    m_wallTimes[0] = 0.0;
+    for (int i = 1; i < samples; ++i) {
+        double mid = (i - 0.5) * m_stepMs;
+        m_wallTimes[i] = m_wallTimes[i - 1] + m_stepMs / rateAt(curve, mid);
+    }
+    m_tailRate = rateAt(curve, (samples - 1) * m_stepMs);
+}
+
+double SpeedCurveTable::wallTimeAt(double animationTimeMs) const {
+    if (m_wallTimes.isEmpty()) return animationTimeMs;
+    if (animationTimeMs <= 0) return 0.0;
+
+    double position = animationTimeMs / m_stepMs;
+    int last = m_wallTimes.size() - 1;
+    if (position >= last) {
+        return m_wallTimes[last] + (animationTimeMs - last * m_stepMs) / m_tailRate;
+    }
+
+    int i = static_cast<int>(position);
+    double frac = position - i;
+    return m_wallTimes[i] + frac * (m_wallTimes[i + 1] - m_wallTimes[i]);
+}
+
+double SpeedCurveTable::animationTimeAt(double wallTimeMs) const {
+    if (m_wallTimes.isEmpty()) return wallTimeMs;
+    if (wallTimeMs <= 0) return 0.0;
+
+    int last = m_wallTimes.size() - 1;
+    if (wallTimeMs >= m_wallTimes[last]) {
+        return last * m_stepMs + (wallTimeMs - m_wallTimes[last]) * m_tailRate;
+    }
+
+    // Wall times are strictly increasing because the rate is floored
+    auto it = std::upper_bound(m_wallTimes.begin(), m_wallTimes.end(), wallTimeMs);
+    int i = static_cast<int>(it - m_wallTimes.begin()) - 1;
+    double span = m_wallTimes[i + 1] - m_wallTimes[i];
+    double frac = span > 0 ? (wallTimeMs - m_wallTimes[i]) / span : 0.0;
+    return (i + frac) * m_stepMs;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QVector>
+
+struct SpeedPoint {
+    double time;   // milliseconds
+    double speed;  // 0.0 to 1.0 (0 = stopped, 0.5 = normal, 1.0 = 2x speed)
+};
+
+// Cumulative integral of the speed curve, mapping animation time to the
+// presentation (wall clock) time at which playback reaches it, and back.
+// Both directions interpolate linearly between the same samples, so they are
+// exact inverses and seeking does not depend on how playback got there.
+class SpeedCurveTable {
+public:
+    // Speed at an animation time, interpolated linearly between points
+    static double speedAt(const QVector<SpeedPoint>& curve, double timeMs);
+
+    // An empty table is the identity mapping (speed curve disabled)
+    void clear();
+    void rebuild(const QVector<SpeedPoint>& curve, double endTimeMs);
+
+    double wallTimeAt(double animationTimeMs) const;
+    double animationTimeAt(double wallTimeMs) const;
+
+private:
+    static double rateAt(const QVector<SpeedPoint>& curve, double timeMs);
+
+    QVector<double> m_wallTimes;     // Wall time at animation time i * m_stepMs
+    double m_stepMs = 0.0;
+    double m_tailRate = 1.0;         // Animation ms per wall ms past the last sample
+
+    static constexpr double MIN_RATE = 0.01;      // Floor so a 0-speed point cannot stall forever
+    static constexpr double SAMPLE_STEP_MS = 10.0;
+    static constexpr int MAX_SAMPLES = 100000;
+};
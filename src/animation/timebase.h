@@ -0,0 +1,112 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <cmath>
+
+// Integer timeline clock. One tick is a "flick" (1/705600000 s), which
+// divides every common frame rate exactly, including the NTSC x/1001 rates,
+// so frame boundaries never drift the way accumulated double milliseconds do.
+using Ticks = qint64;
+
+namespace Timebase {
+
+static constexpr Ticks TICKS_PER_SECOND = 705600000;
+static constexpr Ticks TICKS_PER_MS = TICKS_PER_SECOND / 1000;
+
+inline Ticks fromMs(double timeMs) {
+    return static_cast<Ticks>(std::llround(timeMs * TICKS_PER_MS));
+}
+
+inline double toMs(Ticks ticks) {
+    return static_cast<double>(ticks) / TICKS_PER_MS;
+}
+
+}  // namespace Timebase
+
+// Exact frame rate as num/den frames per second (30000/1001 for 29.97)
+struct FrameRate {
+    int num = 30;
+    int den = 1;
+
+    FrameRate() = default;
+    FrameRate(int numerator, int denominator = 1)
+        : num(numerator), den(denominator) {}
+
+    bool isValid() const { return num > 0 && den > 0; }
+    double fps() const { return isValid() ? static_cast<double>(num) / den : 0.0; }
+
+    bool operator==(const FrameRate& other) const {
+        return static_cast<qint64>(num) * other.den == static_cast<qint64>(other.num) * den;
+    }
+    bool operator!=(const FrameRate& other) const { return !(*this == other); }
+
+    // Start of a frame: floor(frame * den * TICKS_PER_SECOND / num), split so
+    // the product cannot overflow for long timelines
+    Ticks frameStart(qint64 frame) const {
+        if (!isValid()) return 0;
+        const Ticks perFrame = static_cast<Ticks>(den) * Timebase::TICKS_PER_SECOND;
+        const qint64 q = frame / num;
+        const qint64 r = frame % num;
+        return q * perFrame + (r * perFrame) / num;
+    }
+
+    Ticks frameDuration() const { return frameStart(1); }
+
+    // Frame containing a tick (floor)
+    qint64 frameAt(Ticks ticks) const {
+        if (!isValid()) return 0;
+        const Ticks perFrame = static_cast<Ticks>(den) * Timebase::TICKS_PER_SECOND;
+        qint64 frame = static_cast<qint64>(std::floor(static_cast<double>(ticks) * num / perFrame));
+        // Correct the double estimate against the exact boundaries
+        while (frame > 0 && frameStart(frame) > ticks) frame--;
+        while (frameStart(frame + 1) <= ticks) frame++;
+        return frame;
+    }
+
+    qint64 nearestFrame(Ticks ticks) const {
+        qint64 frame = frameAt(ticks);
+        return (ticks - frameStart(frame)) * 2 >= frameStart(frame + 1) - frameStart(frame)
+            ? frame + 1 : frame;
+    }
+
+    // Frames needed to cover a duration (ceil)
+    qint64 frameCount(Ticks duration) const {
+        if (duration <= 0) return 0;
+        qint64 frame = frameAt(duration);
+        return frameStart(frame) == duration ? frame : frame + 1;
+    }
+
+    double frameTimeMs(qint64 frame) const { return Timebase::toMs(frameStart(frame)); }
+    double frameDurationMs() const { return Timebase::toMs(frameDuration()); }
+
+    // "30" or "30000/1001"; the form ffmpeg accepts for -r
+    QString toString() const {
+        return den == 1 ? QString::number(num) : QString("%1/%2").arg(num).arg(den);
+    }
+
+    // Accepts "30", "30000/1001" and the usual decimal NTSC spellings ("29.97")
+    static FrameRate fromString(const QString& text) {
+        const QString s = text.trimmed();
+        if (s.contains('/')) {
+            const QStringList parts = s.split('/');
+            bool okNum = false, okDen = false;
+            FrameRate rate(parts.value(0).toInt(&okNum), parts.value(1).toInt(&okDen));
+            return (parts.size() == 2 && okNum && okDen && rate.isValid()) ? rate : FrameRate(0, 1);
+        }
+
+        bool ok = false;
+        const double fps = s.toDouble(&ok);
+        if (!ok || fps <= 0.0) return FrameRate(0, 1);
+
+        const int whole = static_cast<int>(std::lround(fps));
+        if (std::abs(fps - whole) < 1e-6) return FrameRate(whole, 1);
+
+        // 23.976, 29.97, 59.94, 119.88 are x/1001 rates
+        const int ntsc = static_cast<int>(std::lround(fps * 1.001));
+        if (std::abs(fps - ntsc / 1.001) < 0.01) return FrameRate(ntsc * 1000, 1001);
+
+        return FrameRate(static_cast<int>(std::lround(fps * 1000)), 1000);
+    }
+};
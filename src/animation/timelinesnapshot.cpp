@@ -0,0 +1,76 @@
+#include "timelinesnapshot.h"
+
+namespace {
+CameraState stateOf(const Keyframe& kf) {
+    return CameraState{kf.latitude, kf.longitude, kf.altitude, kf.bearing, kf.tilt};
+}
+}
+
+TimelineSnapshot::TimelineSnapshot(const QVector<Keyframe>& keyframes, const CameraPathSettings& settings,
+                                   const SpeedCurveTable& speedTable, double totalDuration,
+                                   const QVector<GeoOverlay>& overlays)
+    : m_keyframes(keyframes)
+    , m_settings(settings)
+    , m_speedTable(speedTable)
+    , m_totalDuration(totalDuration)
+    , m_overlays(overlays)
+{
+    if (m_settings.spline) {
+        m_path.build(m_keyframes);
+    }
+}
+
+bool TimelineSnapshot::cameraAt(const QVector<Keyframe>& keyframes, const CameraPath& path,
+                                const CameraPathSettings& settings, double timeMs, CameraState& out,
+                                const TrackCursor* cursor) {
+    const int count = keyframes.size();
+    if (count == 0) return false;
+
+    // Times before the first keyframe hold it
+    int fromIndex = qMax(0, TrackLookup::segmentAt(keyframes, timeMs, cursor));
+    if (fromIndex >= count - 1) {
+        out = stateOf(keyframes[count - 1]);
+        return true;
+    }
+
+    const Keyframe& from = keyframes[fromIndex];
+    const Keyframe& to = keyframes[fromIndex + 1];
+    double duration = to.timeMs - from.timeMs;
+    double progress = duration > 0 ? qBound(0.0, (timeMs - from.timeMs) / duration, 1.0) : 0.0;
+
+    // Zoom-pan keyframes keep their own flight path in spline mode too
+    if (settings.spline && from.transition != Keyframe::ZoomPanFlight && !path.isEmpty()) {
+        // No per-keyframe easing: the spline keeps velocity continuous
+        out = path.evaluate(fromIndex, progress, settings.constantSpeed);
+    } else {
+        out = Interpolator::interpolate(from, to, progress, settings.linearEasing, settings.viewWidth);
+    }
+    return true;
+}
+
+CameraState TimelineSnapshot::cameraAt(double timeMs) const {
+    CameraState state{0.0, 0.0, Keyframe().altitude, 0.0, 0.0};
+    cameraAt(m_keyframes, m_path, m_settings, timeMs, state);
+    return state;
+}
+
+void TimelineSnapshot::evaluateCameras(const double* timesMs, int count, CameraState* out) const {
+    // Local cursor: concurrent callers never share lookup state
+    TrackCursor cursor;
+    for (int i = 0; i < count; ++i) {
+        out[i] = CameraState{0.0, 0.0, Keyframe().altitude, 0.0, 0.0};
+        cameraAt(m_keyframes, m_path, m_settings, timesMs[i], out[i], &cursor);
+    }
+}
+
+void TimelineSnapshot::evaluateOverlays(const double* timesMs, int count, OverlayState* out) const {
+    const int overlays = m_overlays.size();
+    for (int i = 0; i < count; ++i) {
+        OverlayState* row = out + static_cast<qsizetype>(i) * overlays;
+        for (int j = 0; j < overlays; ++j) {
+            const GeoOverlay& overlay = m_overlays[j];
+            row[j].visibility = overlay.opacityAtTime(timesMs[i], m_totalDuration);
+            row[j].properties = overlay.propertiesAtTime(timesMs[i]);
+        }
+    }
+}
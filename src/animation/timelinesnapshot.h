@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QVector>
+#include "keyframe.h"
+#include "interpolator.h"
+#include "camerapath.h"
+#include "speedcurvetable.h"
+#include "geooverlay.h"
+
+// How the camera moves between keyframes
+struct CameraPathSettings {
+    bool spline = false;          // Centripetal spline instead of per-segment interpolation
+    bool constantSpeed = false;   // Spline only: constant screen-space speed per segment
+    bool linearEasing = false;    // Speed curve active: skip per-keyframe easing
+    double viewWidth = Interpolator::DEFAULT_VIEW_WIDTH;  // Map view pixels, shapes zoom-pan flights
+};
+
+// Evaluated state of one geo overlay at one time
+struct OverlayState {
+    double visibility = 0.0;      // Fade in/out factor, 0 = hidden
+    OverlayKeyframe properties;   // Animated opacity, extrusion, scale and colors
+};
+
+// Immutable copy of everything that decides camera and overlay state over
+// the timeline. Evaluation is const and touches no QObject, so a snapshot can
+// be sampled from worker threads (export, prefetch, thumbnails, motion blur
+// subframes) while the live models keep changing on the GUI thread.
+class TimelineSnapshot {
+public:
+    TimelineSnapshot() = default;
+    TimelineSnapshot(const QVector<Keyframe>& keyframes, const CameraPathSettings& settings,
+                     const SpeedCurveTable& speedTable, double totalDuration,
+                     const QVector<GeoOverlay>& overlays = {});
+
+    // The camera evaluation shared with live playback. Returns false without keyframes.
+    static bool cameraAt(const QVector<Keyframe>& keyframes, const CameraPath& path,
+                         const CameraPathSettings& settings, double timeMs, CameraState& out,
+                         const TrackCursor* cursor = nullptr);
+
+    bool hasCamera() const { return !m_keyframes.isEmpty(); }
+    double totalDuration() const { return m_totalDuration; }
+    int overlayCount() const { return m_overlays.size(); }
+    const GeoOverlay& overlay(int index) const { return m_overlays[index]; }
+
+    // Presentation (wall clock) time to animation time, as in playback
+    double animationTimeAt(double wallTimeMs) const { return m_speedTable.animationTimeAt(wallTimeMs); }
+
+    CameraState cameraAt(double timeMs) const;
+
+    // Evaluate count animation times into caller-provided arrays. Times in
+    // ascending order are cheapest (segment lookups hit the cursor).
+    void evaluateCameras(const double* timesMs, int count, CameraState* out) const;
+
+    // out must hold count * overlayCount() entries: one row of overlays per time
+    void evaluateOverlays(const double* timesMs, int count, OverlayState* out) const;
+
+private:
+    QVector<Keyframe> m_keyframes;
+    CameraPath m_path;
+    CameraPathSettings m_settings;
+    SpeedCurveTable m_speedTable;
+    double m_totalDuration = 0.0;
+    QVector<GeoOverlay> m_overlays;
+};
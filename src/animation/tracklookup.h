@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+
+// Remembers the segment found by the previous lookup on a track. Playback and
+// export walk time forwards, so the next lookup almost always lands in the
+// same or the following segment and skips the binary search. The hint is
+// validated before use, so a stale value after an edit is harmless, and it is
+// atomic so concurrent evaluation of the same track stays well-defined.
+class TrackCursor {
+public:
+    TrackCursor() = default;
+    TrackCursor(const TrackCursor& other) : m_index(other.hint()) {}
+    TrackCursor& operator=(const TrackCursor& other) {
+        setHint(other.hint());
+        return *this;
+    }
+
+    int hint() const { return m_index.load(std::memory_order_relaxed); }
+    void setHint(int index) const { m_index.store(index, std::memory_order_relaxed); }
+
+private:
+    mutable std::atomic<int> m_index{0};
+};
+
+namespace TrackLookup {
+
+// Index of the last key with timeMs <= timeMs, or -1 when the time lies before
+// the first key. Keys must be sorted by timeMs; equal times resolve to the last.
+template <typename Track>
+int segmentAt(const Track& keys, double timeMs, const TrackCursor* cursor = nullptr) {
+    const int count = static_cast<int>(keys.size());
+    if (count == 0 || timeMs < keys[0].timeMs) {
+        return -1;
+    }
+
+    auto covers = [&keys, count, timeMs](int i) {
+        return keys[i].timeMs <= timeMs && (i + 1 == count || timeMs < keys[i + 1].timeMs);
+    };
+
+    if (cursor) {
+        int hint = cursor->hint();
+        if (hint >= 0 && hint < count) {
+            if (covers(hint)) return hint;
+            if (hint + 1 < count && covers(hint + 1)) {
+                cursor->setHint(hint + 1);
+                return hint + 1;
+            }
+        }
+    }
+
+    auto it = std::upper_bound(keys.begin(), keys.end(), timeMs,
+                               [](double t, const auto& key) { return t < key.timeMs; });
+    int index = static_cast<int>(it - keys.begin()) - 1;
+    if (cursor) {
+        cursor->setHint(index);
+    }
+    return index;
+}
+
+}  // namespace TrackLookup
@@ -11,10 +11,15 @@
 #include "../animation/geooverlaymodel.h"
 #include "../animation/animationcontroller.h"
 #include "../animation/framebuffer.h"
+#include "../animation/frameinvalidator.h"
+#include "../map/framebufferfiller.h"
+#include "../map/rendersnapshot.h"
 #include "../overlays/overlaymanager.h"
 #include "../export/videoexporter.h"
 #include "../map/cityboundaryfetcher.h"
 #include <QtMath>
+#include <QTimer>
+#include <QQuickWindow>
 
 MainController::MainController(QObject* parent)
     : QObject(parent)
@@ -32,6 +37,11 @@ MainController::MainController(QObject* parent)
     m_animation = new AnimationController(this);
     m_exporter = new VideoExporter(this);
     m_frameBuffer = new FrameBuffer(this);
+    m_bufferFiller = new FrameBufferFiller(m_frameBuffer, m_tileCache, this);
+    m_bufferFillTimer = new QTimer(this);
+    m_bufferFillTimer->setSingleShot(true);
+    m_frameInvalidator = new FrameInvalidator(m_frameBuffer, m_keyframes, m_regionTracks,
+                                              m_geoOverlays, m_overlays, this);
     m_cityBoundaryFetcher = new CityBoundaryFetcher(this);
 
     // ProjectManager needs keyframes and overlays for save/load
@@ -48,6 +58,7 @@ MainController::MainController(QObject* parent)
 
     // Setup exporter
     m_exporter->setAnimationController(m_animation);
+    m_exporter->setProjectManager(m_projectManager);
 
     // Setup tile cache
     m_tileCache->setMaxDiskCacheMB(m_settings->diskCacheMaxMB());
@@ -87,16 +98,43 @@ void MainController::setupConnections() {
         m_tileCache->setMaxDiskCacheMB(m_settings->diskCacheMaxMB());
     });
 
+    // Keyframe snapping and the preview buffer share the export frame grid
+    auto applyFrameRate = [this]() {
+        FrameRate rate(m_settings->exportFramerate());
+        m_keyframes->setFrameRate(rate);
+        m_frameBuffer->setFrameRate(rate);
+    };
+    applyFrameRate();
+    connect(m_settings, &Settings::exportFramerateChanged, this, applyFrameRate);
+
     // Track data modifications for unsaved changes
     connect(m_keyframes, &KeyframeModel::dataModified, m_projectManager, &ProjectManager::markModified);
     connect(m_overlays, &OverlayManager::dataModified, m_projectManager, &ProjectManager::markModified);
 
-    // Frame buffer connections - invalidate cache when content changes
-    connect(m_keyframes, &KeyframeModel::dataModified, m_frameBuffer, &FrameBuffer::invalidate);
-    connect(m_keyframes, &KeyframeModel::countChanged, m_frameBuffer, &FrameBuffer::invalidate);
-    connect(m_overlays, &OverlayManager::dataModified, m_frameBuffer, &FrameBuffer::invalidate);
-    connect(m_keyframes, &KeyframeModel::totalDurationChanged, this, [this]() {
-        m_frameBuffer->setTotalDuration(m_keyframes->totalDuration());
+    // Frame buffer connections - model edits invalidate only the frames they
+    // affect (see FrameInvalidator); path settings change every frame
+    connect(m_animation, &AnimationController::pathModeChanged, m_frameBuffer, &FrameBuffer::invalidate);
+    connect(m_animation, &AnimationController::constantSpeedChanged, m_frameBuffer, &FrameBuffer::invalidate);
+    connect(m_animation, &AnimationController::totalDurationChanged, this, [this]() {
+        m_frameBuffer->setTotalDuration(m_animation->totalDuration());
+        m_frameInvalidator->setTotalDuration(m_animation->totalDuration());
+    });
+    m_frameBuffer->setTotalDuration(m_animation->totalDuration());
+    m_frameInvalidator->setTotalDuration(m_animation->totalDuration());
+
+    // Background frame buffer fill: restarted after edits while the timeline
+    // plays, and again later for frames whose tiles had not arrived yet
+    connect(m_bufferFillTimer, &QTimer::timeout, this, &MainController::fillFrameBuffer);
+    connect(m_frameBuffer, &FrameBuffer::bufferInvalidated, this, [this]() {
+        m_bufferFiller->cancel();
+        if (m_animation->isPlaying()) {
+            m_bufferFillTimer->start(BUFFER_FILL_DELAY_MS);
+        }
+    });
+    connect(m_bufferFiller, &FrameBufferFiller::fillFinished, this, [this](int, int skipped) {
+        if (skipped > 0 && m_animation->isPlaying()) {
+            m_bufferFillTimer->start(BUFFER_TILE_RETRY_MS);
+        }
     });
 
     // Keyframe selection - load position to camera when a keyframe is selected
@@ -245,6 +283,13 @@ void MainController::ensureKeyframeAtCurrentTime() {
 }
 
 void MainController::setMapRenderer(MapRenderer* renderer) {
+    if (m_renderer == renderer) return;
+    if (m_renderer) {
+        // Connections below go both ways; drop the previous renderer's
+        disconnect(m_renderer, nullptr, this, nullptr);
+        disconnect(m_renderer, nullptr, m_animation, nullptr);
+        disconnect(m_animation, nullptr, m_renderer, nullptr);
+    }
     m_renderer = renderer;
     if (m_renderer) {
         m_renderer->setTileProvider(m_tileProvider);
@@ -256,16 +301,45 @@ void MainController::setMapRenderer(MapRenderer* renderer) {
         m_renderer->setGeoOverlayModel(m_geoOverlays);
         m_renderer->setFrameBuffer(m_frameBuffer);
         m_exporter->setMapRenderer(m_renderer);
+        m_projectManager->setMapRenderer(m_renderer);
+
+        // Pace playback to the window the renderer is shown in
+        m_animation->setWindow(m_renderer->window());
+        connect(m_renderer, &QQuickItem::windowChanged, m_animation, &AnimationController::setWindow);
+
+        // Buffered frames are shown, and filled, once the timeline plays
+        m_renderer->setTimelinePlaying(m_animation->isPlaying());
+        connect(m_animation, &AnimationController::playingChanged, m_renderer, [this]() {
+            m_renderer->setTimelinePlaying(m_animation->isPlaying());
+            if (m_animation->isPlaying()) {
+                m_bufferFillTimer->start(0);
+            }
+        });
+
+        // Buffered frames are in device pixels, like the live layer images,
+        // so HiDPI playback isn't upscaled
+        auto updateResolution = [this]() {
+            const qreal dpr = m_renderer->window() ? m_renderer->window()->effectiveDevicePixelRatio() : 1.0;
+            m_animation->setViewWidth(m_renderer->width());
+            m_frameBuffer->setResolution(qRound(m_renderer->width() * dpr),
+                                         qRound(m_renderer->height() * dpr));
+            if (m_animation->isPlaying()) {
+                m_bufferFillTimer->start(BUFFER_FILL_DELAY_MS);
+            }
+        };
+        connect(m_renderer, &QQuickItem::widthChanged, this, updateResolution);
+        connect(m_renderer, &QQuickItem::heightChanged, this, updateResolution);
+        connect(m_renderer, &QQuickItem::windowChanged, this, updateResolution);
 
         // Update animation time in renderer
-        connect(m_animation, &AnimationController::currentTimeChanged, this, [this]() {
+        connect(m_animation, &AnimationController::currentTimeChanged, m_renderer, [this]() {
             if (m_renderer) {
                 m_renderer->setCurrentAnimationTime(m_animation->currentTime());
             }
         });
 
         // Update total duration in renderer (use AnimationController's duration which supports explicit mode)
-        connect(m_animation, &AnimationController::totalDurationChanged, this, [this]() {
+        connect(m_animation, &AnimationController::totalDurationChanged, m_renderer, [this]() {
             if (m_renderer) {
                 m_renderer->setTotalDuration(m_animation->totalDuration());
             }
@@ -273,11 +347,25 @@ void MainController::setMapRenderer(MapRenderer* renderer) {
         // Set initial duration
         m_renderer->setTotalDuration(m_animation->totalDuration());
 
-        m_frameBuffer->setResolution(static_cast<int>(m_renderer->width()),
-                                     static_cast<int>(m_renderer->height()));
+        updateResolution();
     }
 }
 
+void MainController::fillFrameBuffer() {
+    if (!m_renderer || !m_renderer->useFrameBuffer() || !m_frameBuffer->isEnabled()) return;
+
+    RenderSnapshot snapshot = m_renderer->captureSnapshot();
+    snapshot.timeline = m_animation->snapshot();
+    snapshot.regionTracks = m_regionTracks->tracks();
+    snapshot.geoOverlays = m_geoOverlays->overlays();
+    snapshot.overlays = m_overlays->toJson();
+
+    // The live label fade follows camera speed; buffered frames use the resting opacity
+    snapshot.labelOpacity = 1.0;
+
+    m_bufferFiller->fill(snapshot);
+}
+
 void MainController::precacheTilesForKeyframe(int index) {
     if (index < 0 || index >= m_keyframes->count()) return;
 
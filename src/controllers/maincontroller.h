@@ -17,7 +17,10 @@ class GeoJsonParser;
 class AnimationController;
 class VideoExporter;
 class FrameBuffer;
+class FrameBufferFiller;
+class FrameInvalidator;
 class CityBoundaryFetcher;
+class QTimer;
 
 Q_DECLARE_OPAQUE_POINTER(Settings*)
 Q_DECLARE_OPAQUE_POINTER(FrameBuffer*)
@@ -92,11 +95,15 @@ private:
     void setupConnections();
     void loadGeoJsonData();
     void precacheTilesForPosition(double lat, double lon, double zoom);
+    void fillFrameBuffer();
 
     // Viewport size for precaching (1080p)
     static constexpr int PRECACHE_WIDTH = 1920;
     static constexpr int PRECACHE_HEIGHT = 1080;
 
+    static constexpr int BUFFER_FILL_DELAY_MS = 250;     // Let edits settle before re-rendering
+    static constexpr int BUFFER_TILE_RETRY_MS = 2000;    // Retry frames that were waiting for tiles
+
     Settings* m_settings = nullptr;
     ProjectManager* m_projectManager = nullptr;
     KeyframeModel* m_keyframes = nullptr;
@@ -111,5 +118,8 @@ private:
     AnimationController* m_animation = nullptr;
     VideoExporter* m_exporter = nullptr;
     FrameBuffer* m_frameBuffer = nullptr;
+    FrameBufferFiller* m_bufferFiller = nullptr;
+    FrameInvalidator* m_frameInvalidator = nullptr;
+    QTimer* m_bufferFillTimer = nullptr;
     CityBoundaryFetcher* m_cityBoundaryFetcher = nullptr;
 };
@@ -4,11 +4,13 @@
 #include "../animation/geooverlaymodel.h"
 #include "../animation/animationcontroller.h"
 #include "../overlays/overlaymanager.h"
+#include "../map/maprenderer.h"
 #include <QFile>
 #include <QFileInfo>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QCryptographicHash>
 
 ProjectManager::ProjectManager(KeyframeModel* keyframes, OverlayManager* overlays, QObject* parent)
     : QObject(parent)
@@ -33,6 +35,8 @@ bool ProjectManager::newProject() {
     if (m_animation) {
         m_animation->setExplicitDuration(60000.0);  // 60 seconds default
         m_animation->setUseExplicitDuration(true);
+        m_animation->setPathMode(AnimationController::LinearPath);
+        m_animation->setConstantSpeed(false);
         m_animation->stop();
     }
 
@@ -195,6 +199,10 @@ bool ProjectManager::loadFromFile(const QString& path) {
         QJsonObject animObj = root["animation"].toObject();
         m_animation->setExplicitDuration(animObj["explicitDuration"].toDouble(60000.0));
         m_animation->setUseExplicitDuration(animObj["useExplicitDuration"].toBool(true));
+        m_animation->setPathMode(animObj["pathMode"].toString() == "spline"
+                                     ? AnimationController::SplinePath
+                                     : AnimationController::LinearPath);
+        m_animation->setConstantSpeed(animObj["constantSpeed"].toBool(false));
 
         // Restore playhead position (must be done after keyframes are loaded)
         if (animObj.contains("currentTime")) {
@@ -205,7 +213,7 @@ bool ProjectManager::loadFromFile(const QString& path) {
     return true;
 }
 
-bool ProjectManager::saveToFile(const QString& path) {
+QJsonObject ProjectManager::toJson() const {
     QJsonObject root;
     root["version"] = "1.1";  // Bumped version for new format
     root["name"] = projectName();
@@ -226,10 +234,34 @@ bool ProjectManager::saveToFile(const QString& path) {
         QJsonObject animObj;
         animObj["explicitDuration"] = m_animation->explicitDuration();
         animObj["useExplicitDuration"] = m_animation->useExplicitDuration();
+        animObj["pathMode"] = m_animation->pathMode() == AnimationController::SplinePath
+                                  ? "spline" : "linear";
+        animObj["constantSpeed"] = m_animation->constantSpeed();
         animObj["currentTime"] = m_animation->currentTime();  // Save playhead position
         root["animation"] = animObj;
     }
 
+    return root;
+}
+
+QString ProjectManager::contentHash() const {
+    QJsonObject root = toJson();
+    root.remove("name");
+
+    QJsonObject animObj = root["animation"].toObject();
+    animObj.remove("currentTime");
+    root["animation"] = animObj;
+
+    QByteArray data = QJsonDocument(root).toJson(QJsonDocument::Compact);
+    if (m_renderer) {
+        data += m_renderer->settingsSignature();
+    }
+    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+}
+
+bool ProjectManager::saveToFile(const QString& path) {
+    QJsonObject root = toJson();
+
     QJsonDocument doc(root);
     QByteArray data = doc.toJson(QJsonDocument::Indented);
 
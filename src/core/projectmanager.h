@@ -3,12 +3,14 @@
 #include <QObject>
 #include <QString>
 #include <QUrl>
+#include <QJsonObject>
 
 class KeyframeModel;
 class OverlayManager;
 class GeoOverlayModel;
 class AnimationController;
 class Settings;
+class MapRenderer;
 
 class ProjectManager : public QObject {
     Q_OBJECT
@@ -23,6 +25,7 @@ public:
     void setGeoOverlayModel(GeoOverlayModel* geoOverlays) { m_geoOverlays = geoOverlays; }
     void setAnimationController(AnimationController* anim) { m_animation = anim; }
     void setSettings(Settings* settings) { m_settings = settings; }
+    void setMapRenderer(MapRenderer* renderer) { m_renderer = renderer; }
 
     QString projectPath() const { return m_projectPath; }
     QString projectName() const;
@@ -36,6 +39,10 @@ public:
     // Auto-load last project on startup
     Q_INVOKABLE bool loadLastProject();
 
+    // Hash of everything that affects rendered output: the project plus the
+    // renderer's styling and tile source (ignores playhead and name)
+    QString contentHash() const;
+
 public slots:
     void markModified();
     void clearModified();
@@ -51,6 +58,7 @@ signals:
 private:
     bool loadFromFile(const QString& path);
     bool saveToFile(const QString& path);
+    QJsonObject toJson() const;
 
     QString m_projectPath;
     bool m_hasUnsavedChanges = false;
@@ -59,4 +67,5 @@ private:
     GeoOverlayModel* m_geoOverlays = nullptr;
     AnimationController* m_animation = nullptr;
     Settings* m_settings = nullptr;
+    MapRenderer* m_renderer = nullptr;
 };
@@ -0,0 +1,161 @@
+#include "batchrenderer.h"
+#include "videoexporter.h"
+#include "../controllers/maincontroller.h"
+#include "../core/projectmanager.h"
+#include "../core/settings.h"
+#include "../map/maprenderer.h"
+#include "../map/tileprovider.h"
+#include "../map/mapcamera.h"
+#include "../animation/animationcontroller.h"
+#include <QUrl>
+#include <QFileInfo>
+#include <QDebug>
+
+BatchRenderer::BatchRenderer(MainController* controller, QObject* parent)
+    : QObject(parent)
+    , m_controller(controller)
+    , m_renderer(new MapRenderer())
+    , m_tileWaitTimer(new QTimer(this))
+{
+    // The renderer never joins a scene; it only serves renderToImage()
+    m_renderer->setParent(this);
+    m_renderer->setUseFrameBuffer(false);
+    m_renderer->setShadeNonHighlighted(controller->settings()->shadeNonHighlighted());
+    m_renderer->setNonHighlightedOpacity(controller->settings()->nonHighlightedOpacity());
+    controller->setMapRenderer(m_renderer);
+
+    m_tileWaitTimer->setInterval(100);
+    connect(m_tileWaitTimer, &QTimer::timeout, this, &BatchRenderer::checkTilePrefetch);
+
+    VideoExporter* exporter = controller->exporter();
+    connect(exporter, &VideoExporter::exportComplete, this, &BatchRenderer::onExportComplete);
+    connect(exporter, &VideoExporter::exportError, this, &BatchRenderer::onExportError);
+    connect(exporter, &VideoExporter::statusChanged, this, [exporter]() {
+        qInfo().noquote() << exporter->status();
+    });
+}
+
+void BatchRenderer::setOffline(bool offline) {
+    m_offline = offline;
+    m_controller->tileProvider()->setOffline(offline);
+}
+
+void BatchRenderer::start() {
+    m_currentJob = -1;
+    m_failures = 0;
+    QTimer::singleShot(0, this, &BatchRenderer::startNextJob);
+}
+
+void BatchRenderer::startNextJob() {
+    m_currentJob++;
+    if (m_currentJob >= m_jobs.size()) {
+        qInfo() << "Batch render finished:" << (m_jobs.size() - m_failures) << "of"
+                << m_jobs.size() << "succeeded";
+        emit finished(m_failures > 0 ? 1 : 0);
+        return;
+    }
+
+    const Job& job = m_jobs[m_currentJob];
+    qInfo().noquote() << QString("[%1/%2] Rendering %3 -> %4")
+        .arg(m_currentJob + 1).arg(m_jobs.size()).arg(job.projectPath, job.outputPath);
+
+    m_jobActive = true;
+
+    if (!QFileInfo::exists(job.projectPath)
+        || !m_controller->projectManager()->openProject(QUrl::fromLocalFile(job.projectPath))) {
+        finishJob(false, "Cannot load project " + job.projectPath);
+        return;
+    }
+
+    m_renderer->setSize(QSizeF(job.width, job.height));
+    m_controller->animation()->stop();
+
+    if (m_offline) {
+        beginExport();
+    } else {
+        prefetchTiles(job);
+    }
+}
+
+void BatchRenderer::prefetchTiles(const Job& job) {
+    // Evaluate the camera for the whole timeline in one batch and queue every
+    // tile it will need, so frames are not rendered with placeholder tiles
+    AnimationController* animation = m_controller->animation();
+    TimelineSnapshot timeline = animation->snapshot();
+    double duration = animation->playbackDuration();
+    int frames = static_cast<int>(job.framerate.frameCount(Timebase::fromMs(duration)));
+
+    QVector<double> times;
+    for (int frame = 0; frame < frames; frame += PREFETCH_STEP_FRAMES) {
+        times.append(timeline.animationTimeAt(job.framerate.frameTimeMs(frame)));
+    }
+    times.append(timeline.animationTimeAt(duration));
+
+    QVector<CameraState> cameras(times.size());
+    timeline.evaluateCameras(times.constData(), times.size(), cameras.data());
+
+    MapCamera* camera = m_controller->camera();
+    if (timeline.hasCamera()) {
+        for (const CameraState& state : cameras) {
+            camera->setPosition(state.latitude, state.longitude, state.zoom(), state.bearing, state.tilt);
+            m_renderer->requestVisibleTiles();
+        }
+
+        // Put the camera back where the playhead is; the export starts from there
+        CameraState current = timeline.cameraAt(animation->currentTime());
+        camera->setPosition(current.latitude, current.longitude, current.zoom(),
+                            current.bearing, current.tilt);
+    }
+
+    qInfo() << "Prefetching" << m_controller->tileProvider()->pendingCount() << "tiles";
+    m_tileWaitElapsed.start();
+    m_tileWaitTimer->start();
+}
+
+void BatchRenderer::checkTilePrefetch() {
+    int pending = m_controller->tileProvider()->pendingCount();
+    if (pending > 0 && m_tileWaitElapsed.elapsed() < TILE_WAIT_TIMEOUT_MS) {
+        return;
+    }
+
+    m_tileWaitTimer->stop();
+    if (pending > 0) {
+        qWarning() << "Tile prefetch timed out with" << pending << "tiles outstanding";
+    }
+    beginExport();
+}
+
+void BatchRenderer::beginExport() {
+    const Job& job = m_jobs[m_currentJob];
+    VideoExporter* exporter = m_controller->exporter();
+
+    if (job.imageFormat.isEmpty()) {
+        exporter->startExport(job.outputPath, job.width, job.height, job.framerate);
+    } else {
+        exporter->startImageSequenceExport(job.outputPath, job.width, job.height, job.framerate,
+                                           job.imageFormat);
+    }
+}
+
+void BatchRenderer::onExportComplete(const QString& path) {
+    finishJob(true, "Wrote " + path);
+}
+
+void BatchRenderer::onExportError(const QString& error) {
+    finishJob(false, error);
+}
+
+void BatchRenderer::finishJob(bool success, const QString& message) {
+    // The exporter may report a failure more than once
+    if (!m_jobActive) return;
+    m_jobActive = false;
+
+    if (success) {
+        qInfo().noquote() << message;
+    } else {
+        m_failures++;
+        qWarning().noquote() << "Render failed:" << message;
+    }
+
+    QTimer::singleShot(0, this, &BatchRenderer::startNextJob);
+}
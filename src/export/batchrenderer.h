@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "../animation/timebase.h"
+
+class MainController;
+class MapRenderer;
+
+// Drives VideoExporter without the QML UI: loads each queued project through
+// ProjectManager, renders it with an offscreen MapRenderer and reports a
+// process exit code when the queue is empty.
+class BatchRenderer : public QObject {
+    Q_OBJECT
+
+public:
+    struct Job {
+        QString projectPath;
+        QString outputPath;
+        int width = 1920;
+        int height = 1080;
+        FrameRate framerate;    // 30/1 unless --fps says otherwise
+        QString imageFormat;    // Empty = video, otherwise an image sequence format
+    };
+
+    explicit BatchRenderer(MainController* controller, QObject* parent = nullptr);
+
+    void addJob(const Job& job) { m_jobs.append(job); }
+    int jobCount() const { return m_jobs.size(); }
+
+    // Offline renders use only tiles already in the disk cache
+    void setOffline(bool offline);
+
+    void start();
+
+signals:
+    void finished(int exitCode);
+
+private slots:
+    void startNextJob();
+    void checkTilePrefetch();
+    void onExportComplete(const QString& path);
+    void onExportError(const QString& error);
+
+private:
+    void prefetchTiles(const Job& job);
+    void beginExport();
+    void finishJob(bool success, const QString& message);
+
+    static constexpr int TILE_WAIT_TIMEOUT_MS = 120000;
+    static constexpr int PREFETCH_STEP_FRAMES = 2;  // Sample every other frame for tiles
+
+    MainController* m_controller = nullptr;
+    MapRenderer* m_renderer = nullptr;
+
+    QVector<Job> m_jobs;
+    int m_currentJob = -1;
+    int m_failures = 0;
+    bool m_offline = false;
+    bool m_jobActive = false;
+
+    QTimer* m_tileWaitTimer = nullptr;
+    QElapsedTimer m_tileWaitElapsed;
+};
@@ -2,6 +2,8 @@
 #include <QStandardPaths>
 #include <QFileInfo>
 #include <QDir>
+#include <QFile>
+#include <QTextStream>
 
 FFmpegPipeline::FFmpegPipeline(QObject* parent)
     : QObject(parent)
@@ -14,6 +16,10 @@ FFmpegPipeline::~FFmpegPipeline() {
 }
 
 bool FFmpegPipeline::start(const QString& outputPath, int width, int height, int framerate) {
+    return start(outputPath, width, height, FrameRate(framerate));
+}
+
+bool FFmpegPipeline::start(const QString& outputPath, int width, int height, const FrameRate& rate) {
     if (m_running) return false;
 
     if (m_ffmpegPath.isEmpty()) {
@@ -29,15 +35,72 @@ bool FFmpegPipeline::start(const QString& outputPath, int width, int height, int
          << "-f" << "rawvideo"                // Input format
          << "-pix_fmt" << "rgba"              // Input pixel format
          << "-s" << QString("%1x%2").arg(width).arg(height)  // Input size
-         << "-r" << QString::number(framerate)               // Input framerate
+         << "-r" << rate.toString()                          // Input framerate, exact rational
          << "-i" << "-"                       // Read from stdin
          << "-c:v" << "libx264"               // H.264 codec
          << "-preset" << "medium"             // Encoding speed/quality tradeoff
-         << "-crf" << "18"                    // Quality (lower = better, 18 is visually lossless)
-         << "-pix_fmt" << "yuv420p"           // Output pixel format for compatibility
+         << "-crf" << "18";                   // Quality (lower = better, 18 is visually lossless)
+
+    if (m_gopSize > 0) {
+        // Fixed GOP with no scene-cut keyframes so segments join cleanly
+        args << "-g" << QString::number(m_gopSize)
+             << "-keyint_min" << QString::number(m_gopSize)
+             << "-sc_threshold" << "0";
+    }
+    if (m_threadCount > 0) {
+        args << "-threads" << QString::number(m_threadCount);
+    }
+
+    args << "-pix_fmt" << "yuv420p"           // Output pixel format for compatibility
          << "-movflags" << "+faststart"       // Enable streaming
          << outputPath;
 
+    return launch(args);
+}
+
+bool FFmpegPipeline::concat(const QStringList& inputPaths, const QString& outputPath) {
+    if (m_running) return false;
+
+    if (m_ffmpegPath.isEmpty()) {
+        emit error("FFmpeg not found. Please install FFmpeg and add it to PATH.");
+        return false;
+    }
+    if (inputPaths.isEmpty()) {
+        emit error("No segments to join");
+        return false;
+    }
+
+    m_framesWritten = 0;
+    m_errorOutput.clear();
+
+    // Concat demuxer list lives next to the first segment
+    QString listPath = QFileInfo(inputPaths.first()).absoluteDir().filePath("concat.txt");
+    QFile listFile(listPath);
+    if (!listFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        emit error("Failed to write concat list: " + listPath);
+        return false;
+    }
+    QTextStream out(&listFile);
+    for (const QString& path : inputPaths) {
+        QString escaped = QFileInfo(path).absoluteFilePath();
+        escaped.replace("'", "'\\''");
+        out << "file '" << escaped << "'\n";
+    }
+    listFile.close();
+
+    QStringList args;
+    args << "-y"
+         << "-f" << "concat"
+         << "-safe" << "0"
+         << "-i" << listPath
+         << "-c" << "copy"                    // No re-encode
+         << "-movflags" << "+faststart"
+         << outputPath;
+
+    return launch(args);
+}
+
+bool FFmpegPipeline::launch(const QStringList& args) {
     m_process = new QProcess(this);
     m_process->setProcessChannelMode(QProcess::MergedChannels);
 
@@ -47,12 +110,15 @@ bool FFmpegPipeline::start(const QString& outputPath, int width, int height, int
     connect(m_process, &QProcess::errorOccurred, this, &FFmpegPipeline::onProcessError);
     connect(m_process, &QProcess::readyReadStandardError, this, &FFmpegPipeline::onReadyReadStandardError);
 
-    m_process->start(m_ffmpegPath, args);
+    // onProcessError() may detach the process while it starts
+    QProcess* process = m_process;
+    process->start(m_ffmpegPath, args);
 
-    if (!m_process->waitForStarted(5000)) {
+    if (!process->waitForStarted(5000)) {
+        if (m_process == process) {
+            detachProcess();
+        }
         emit error("Failed to start FFmpeg process");
-        delete m_process;
-        m_process = nullptr;
         return false;
     }
 
@@ -87,23 +153,42 @@ void FFmpegPipeline::finish() {
     // Close stdin to signal end of input
     m_process->closeWriteChannel();
 
-    // Wait for process to finish (with timeout)
-    if (!m_process->waitForFinished(30000)) {
+    // Wait for process to finish (with timeout). A timeout is reported
+    // through onProcessError(), which detaches the process.
+    if (!m_process->waitForFinished(30000) && m_process) {
         emit error("FFmpeg timed out while finishing");
         abort();
     }
 }
 
+void FFmpegPipeline::closeInput() {
+    if (!m_running || !m_process) return;
+    m_process->closeWriteChannel();
+}
+
+qint64 FFmpegPipeline::pendingBytes() const {
+    return m_process ? m_process->bytesToWrite() : 0;
+}
+
 void FFmpegPipeline::abort() {
     if (!m_process) return;
 
-    m_process->kill();
-    m_process->waitForFinished(5000);
+    // Detached first, so killing it doesn't re-enter our finished() handlers
+    QProcess* process = detachProcess();
+    process->kill();
+    process->waitForFinished(5000);
+}
 
-    delete m_process;
+QProcess* FFmpegPipeline::detachProcess() {
+    QProcess* process = m_process;
     m_process = nullptr;
+    disconnect(process, nullptr, this, nullptr);
+    // Deferred: this may run inside one of the process's own signals
+    process->deleteLater();
+
     m_running = false;
     emit runningChanged();
+    return process;
 }
 
 bool FFmpegPipeline::isFFmpegAvailable() {
@@ -155,8 +240,10 @@ void FFmpegPipeline::onProcessStarted() {
 }
 
 void FFmpegPipeline::onProcessFinished(int exitCode, QProcess::ExitStatus status) {
-    m_running = false;
-    emit runningChanged();
+    // Detach first: handlers of error() and finished() may call abort() or start() again
+    if (m_process) {
+        detachProcess();
+    }
 
     bool success = (exitCode == 0 && status == QProcess::NormalExit);
     if (!success && !m_errorOutput.isEmpty()) {
@@ -164,9 +251,6 @@ void FFmpegPipeline::onProcessFinished(int exitCode, QProcess::ExitStatus status
     }
 
     emit finished(success);
-
-    m_process->deleteLater();
-    m_process = nullptr;
 }
 
 void FFmpegPipeline::onProcessError(QProcess::ProcessError error) {
@@ -191,6 +275,12 @@ void FFmpegPipeline::onProcessError(QProcess::ProcessError error) {
             errorStr = "Unknown FFmpeg error";
     }
 
+    // Every error ends the run. Detach before reporting it, as handlers may
+    // abort() or start() again; a crashed process has finished() still to come.
+    if (m_process) {
+        detachProcess()->kill();
+    }
+
     emit this->error(errorStr);
 }
 
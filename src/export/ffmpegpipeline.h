@@ -3,6 +3,7 @@
 #include <QObject>
 #include <QProcess>
 #include <QImage>
+#include "../animation/timebase.h"
 
 class FFmpegPipeline : public QObject {
     Q_OBJECT
@@ -14,10 +15,24 @@ public:
     ~FFmpegPipeline();
 
     Q_INVOKABLE bool start(const QString& outputPath, int width, int height, int framerate);
+    bool start(const QString& outputPath, int width, int height, const FrameRate& rate);
     Q_INVOKABLE void writeFrame(const QImage& frame);
     Q_INVOKABLE void finish();
     Q_INVOKABLE void abort();
 
+    // Close stdin without waiting; completion is reported through finished()
+    void closeInput();
+
+    // Losslessly join already-encoded files with the concat demuxer
+    bool concat(const QStringList& inputPaths, const QString& outputPath);
+
+    // Encoder tuning for segmented exports (0 = FFmpeg default)
+    void setGopSize(int frames) { m_gopSize = frames; }
+    void setThreadCount(int threads) { m_threadCount = threads; }
+
+    // Bytes queued to FFmpeg's stdin but not yet consumed
+    qint64 pendingBytes() const;
+
     Q_INVOKABLE static bool isFFmpegAvailable();
     Q_INVOKABLE static QString findFFmpegPath();
     Q_INVOKABLE void setFFmpegPath(const QString& path);
@@ -38,9 +53,14 @@ private slots:
     void onReadyReadStandardError();
 
 private:
+    bool launch(const QStringList& args);
+    QProcess* detachProcess();
+
     QProcess* m_process = nullptr;
     QString m_ffmpegPath;
     int m_framesWritten = 0;
+    int m_gopSize = 0;
+    int m_threadCount = 0;
     bool m_running = false;
     QString m_errorOutput;
 };
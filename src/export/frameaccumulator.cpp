@@ -0,0 +1,117 @@
+#include "frameaccumulator.h"
+#include <QtMath>
+#include <QThread>
+#include <array>
+#include <cmath>
+
+namespace {
+
+constexpr int LINEAR_BITS = 12;  // Resolution of the linear -> sRGB table
+
+struct ColorTables {
+    std::array<quint16, 256> toLinear;                 // sRGB byte -> linear 0..65535
+    std::array<quint8, (1 << LINEAR_BITS)> toSrgb;     // linear >> 4 -> sRGB byte
+
+    ColorTables() {
+        for (int i = 0; i < 256; ++i) {
+            double c = i / 255.0;
+            double l = c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+            toLinear[i] = static_cast<quint16>(std::lround(l * 65535.0));
+        }
+        for (int i = 0; i < (1 << LINEAR_BITS); ++i) {
+            double l = (i + 0.5) / (1 << LINEAR_BITS);
+            double c = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+            toSrgb[i] = static_cast<quint8>(qBound(0L, std::lround(c * 255.0), 255L));
+        }
+    }
+};
+
+const ColorTables& tables() {
+    static const ColorTables instance;
+    return instance;
+}
+
+}  // namespace
+
+FrameAccumulator::FrameAccumulator() {
+    m_pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+void FrameAccumulator::reset(int width, int height) {
+    m_width = width;
+    m_height = height;
+    m_count = 0;
+    m_sum.fill(0, width * height * 4);
+}
+
+template <typename RowFn>
+void FrameAccumulator::forEachRowBlock(RowFn fn) const {
+    for (int y0 = 0; y0 < m_height; y0 += ROWS_PER_TASK) {
+        int y1 = qMin(m_height, y0 + ROWS_PER_TASK);
+        m_pool.start([fn, y0, y1]() { fn(y0, y1); });
+    }
+    m_pool.waitForDone();
+}
+
+void FrameAccumulator::add(const QImage& subframe) {
+    if (subframe.width() != m_width || subframe.height() != m_height) return;
+
+    // RGBA8888 gives a fixed byte order on every platform
+    const QImage src = subframe.convertToFormat(QImage::Format_RGBA8888);
+    const uchar* bits = src.constBits();
+    const qsizetype stride = src.bytesPerLine();
+    const quint16* toLinear = tables().toLinear.data();
+    quint32* sum = m_sum.data();
+    const int width = m_width;
+
+    forEachRowBlock([bits, stride, toLinear, sum, width](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const uchar* in = bits + y * stride;
+            quint32* acc = sum + static_cast<qsizetype>(y) * width * 4;
+            for (int x = 0; x < width * 4; x += 4) {
+                acc[x + 0] += toLinear[in[x + 0]];
+                acc[x + 1] += toLinear[in[x + 1]];
+                acc[x + 2] += toLinear[in[x + 2]];
+                acc[x + 3] += in[x + 3] * 257u;
+            }
+        }
+    });
+    m_count++;
+}
+
+QImage FrameAccumulator::result() const {
+    QImage out(m_width, m_height, QImage::Format_RGBA8888);
+    if (m_count == 0) {
+        out.fill(Qt::black);
+        return out;
+    }
+
+    // Rounded 32-bit fixed-point reciprocal of the sample count, so
+    // (sum * inv + HALF) >> 32 is sum / count rounded to nearest. A 16-bit
+    // truncated one came out low for counts that don't divide 65536.
+    const quint64 inv = ((quint64(1) << 32) + m_count / 2) / m_count;
+    constexpr quint64 HALF = quint64(1) << 31;
+    const quint8* toSrgb = tables().toSrgb.data();
+    const quint32* sum = m_sum.data();
+    const int width = m_width;
+    constexpr int shift = 32 + (16 - LINEAR_BITS);  // Average, then down to table resolution
+    constexpr quint64 maxIndex = (1 << LINEAR_BITS) - 1;
+
+    // Take the pointer once; calling scanLine() from workers would race on detach
+    uchar* bits = out.bits();
+    const qsizetype stride = out.bytesPerLine();
+
+    forEachRowBlock([bits, stride, inv, toSrgb, sum, width](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            uchar* dst = bits + y * stride;
+            const quint32* acc = sum + static_cast<qsizetype>(y) * width * 4;
+            for (int x = 0; x < width * 4; x += 4) {
+                dst[x + 0] = toSrgb[qMin((acc[x + 0] * inv + HALF) >> shift, maxIndex)];
+                dst[x + 1] = toSrgb[qMin((acc[x + 1] * inv + HALF) >> shift, maxIndex)];
+                dst[x + 2] = toSrgb[qMin((acc[x + 2] * inv + HALF) >> shift, maxIndex)];
+                dst[x + 3] = static_cast<uchar>((qMin<quint64>((acc[x + 3] * inv + HALF) >> 32, 65535) + 128) / 257);
+            }
+        }
+    });
+    return out;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QImage>
+#include <QVector>
+#include <QThreadPool>
+
+// Averages subframes into one motion-blurred frame. Colour channels are
+// summed in linear light (sRGB decoded through a lookup table) so bright
+// streaks keep their energy instead of darkening; alpha is summed as-is.
+// Rows are split across a private thread pool. The inner loops are a table
+// lookup per channel, which compilers don't vectorise; the speed comes from
+// the threads and from staying in integers.
+class FrameAccumulator {
+public:
+    FrameAccumulator();
+
+    void reset(int width, int height);
+    void add(const QImage& subframe);
+    QImage result() const;
+
+    int count() const { return m_count; }
+
+private:
+    template <typename RowFn>
+    void forEachRowBlock(RowFn fn) const;
+
+    QVector<quint32> m_sum;    // 4 channels per pixel, linear 16-bit units
+    int m_width = 0;
+    int m_height = 0;
+    int m_count = 0;
+    mutable QThreadPool m_pool;
+
+    static constexpr int ROWS_PER_TASK = 32;
+};
@@ -0,0 +1,115 @@
+#include "framecache.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDirIterator>
+#include <QDateTime>
+#include <QImageWriter>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+#include <algorithm>
+
+FrameCache::FrameCache(QObject* parent)
+    : QObject(parent)
+{
+    // Two writers keep up with the render loop without starving the encoder
+    m_writer.setMaxThreadCount(2);
+    setDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/frames");
+}
+
+FrameCache::~FrameCache() {
+    m_writer.waitForDone();
+}
+
+void FrameCache::setDirectory(const QString& path) {
+    m_directory = path;
+    QDir().mkpath(path);
+}
+
+QString FrameCache::pathFor(const QByteArray& signature) const {
+    // Two-level fan-out keeps directories small
+    QString hex = QString::fromLatin1(signature.toHex());
+    return QString("%1/%2/%3.png").arg(m_directory, hex.left(2), hex);
+}
+
+bool FrameCache::contains(const QByteArray& signature) const {
+    return QFile::exists(pathFor(signature));
+}
+
+QImage FrameCache::load(const QByteArray& signature) const {
+    QString path = pathFor(signature);
+
+    // Touch for LRU; opening the file alone does not change its mtime
+    if (QFile::exists(path)) {
+        QFile::setFileTime(path, QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+
+    return QImage(path);
+}
+
+void FrameCache::store(const QByteArray& signature, const QImage& image) {
+    QString path = pathFor(signature);
+    if (QFile::exists(path)) return;
+
+    m_writer.start([path, image]() {
+        QFileInfo(path).dir().mkpath(".");
+
+        // Write via QSaveFile so a partial file is never visible under the final name
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) return;
+
+        QImageWriter writer(&file, "png");
+        writer.setCompression(1);  // Favour speed; frames are re-read, not archived
+        if (writer.write(image)) {
+            file.commit();
+        } else {
+            file.cancelWriting();
+        }
+    });
+}
+
+void FrameCache::waitForWrites() {
+    m_writer.waitForDone();
+}
+
+void FrameCache::enforceDiskLimit() {
+    struct CacheEntry {
+        QString path;
+        qint64 size;
+        QDateTime lastModified;
+    };
+    QVector<CacheEntry> entries;
+    qint64 totalSize = 0;
+
+    QDirIterator it(m_directory, {"*.png"}, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        QFileInfo info = it.fileInfo();
+        entries.append({info.filePath(), info.size(), info.lastModified()});
+        totalSize += info.size();
+    }
+
+    qint64 maxBytes = static_cast<qint64>(m_maxDiskMB) * 1024 * 1024;
+    if (totalSize <= maxBytes) {
+        return;
+    }
+
+    // Oldest first, trim to 90% of the limit
+    std::sort(entries.begin(), entries.end(), [](const CacheEntry& a, const CacheEntry& b) {
+        return a.lastModified < b.lastModified;
+    });
+
+    qint64 targetSize = maxBytes * 9 / 10;
+    int deletedCount = 0;
+    for (const auto& entry : entries) {
+        if (totalSize <= targetSize) break;
+        if (QFile::remove(entry.path)) {
+            totalSize -= entry.size;
+            deletedCount++;
+        }
+    }
+
+    qDebug() << "Frame cache cleanup: removed" << deletedCount << "frames,"
+             << "new size:" << (totalSize / (1024 * 1024)) << "MB";
+}
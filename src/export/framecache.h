@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QObject>
+#include <QImage>
+#include <QThreadPool>
+
+// Content-addressed disk cache of rendered export frames, keyed by
+// MapRenderer::frameSignature(). Shared between exports and projects.
+class FrameCache : public QObject {
+    Q_OBJECT
+
+public:
+    explicit FrameCache(QObject* parent = nullptr);
+    ~FrameCache();
+
+    void setDirectory(const QString& path);
+    QString directory() const { return m_directory; }
+
+    void setMaxDiskMB(int megabytes) { m_maxDiskMB = megabytes; }
+    int maxDiskMB() const { return m_maxDiskMB; }
+
+    bool contains(const QByteArray& signature) const;
+    QImage load(const QByteArray& signature) const;
+
+    // Encoding and writing happen on a background thread
+    void store(const QByteArray& signature, const QImage& image);
+    void waitForWrites();
+
+    // Evict least recently used frames beyond the size limit
+    void enforceDiskLimit();
+
+private:
+    QString pathFor(const QByteArray& signature) const;
+
+    QThreadPool m_writer;
+    QString m_directory;
+    int m_maxDiskMB = 4096;
+};
@@ -2,6 +2,8 @@
 #include "../map/maprenderer.h"
 #include "../map/mapcamera.h"
 #include "../animation/animationcontroller.h"
+#include "framecache.h"
+#include <QCryptographicHash>
 
 FrameCapturer::FrameCapturer(QObject* parent)
     : QObject(parent)
@@ -33,14 +35,91 @@ QImage FrameCapturer::captureFrame() {
     return m_renderer->renderToImage(m_width, m_height);
 }
 
+void FrameCapturer::setMotionBlur(int samples, double shutterAngle, double frameDurationMs) {
+    m_blurSamples = qMax(1, samples);
+    m_shutterAngle = qBound(0.0, shutterAngle, 360.0);
+    m_frameDurationMs = frameDurationMs;
+}
+
+QVector<double> FrameCapturer::subframeTimes(double timeMs) const {
+    if (m_blurSamples <= 1 || m_shutterAngle <= 0.0) {
+        return {timeMs};
+    }
+
+    // Sample the middle of K equal slices of the open shutter
+    double shutterMs = m_frameDurationMs * m_shutterAngle / 360.0;
+    QVector<double> times;
+    times.reserve(m_blurSamples);
+    for (int k = 0; k < m_blurSamples; ++k) {
+        double offset = ((k + 0.5) / m_blurSamples - 0.5) * shutterMs;
+        times.append(qMax(0.0, timeMs + offset));
+    }
+    return times;
+}
+
+QImage FrameCapturer::renderAtTime(double timeMs) {
+    if (m_controller) {
+        m_controller->setPresentationTime(timeMs);
+    }
+    return captureFrame();
+}
+
+QByteArray FrameCapturer::signatureAtTime(double timeMs) {
+    if (m_controller) {
+        m_controller->setPresentationTime(timeMs);
+    }
+    return m_renderer->frameSignature(m_width, m_height);
+}
+
 QImage FrameCapturer::captureFrameAtTime(double timeMs) {
     if (!m_controller) {
         return captureFrame();
     }
 
-    // Set animation to specific time
-    m_controller->setCurrentTime(timeMs);
+    // Reuse an identical frame from an earlier export if there is one
+    if (m_frameCache && m_renderer) {
+        m_lastSignature = frameSignatureAtTime(timeMs);
+        if (m_frameCache->contains(m_lastSignature)) {
+            QImage cached = m_frameCache->load(m_lastSignature);
+            if (cached.size() == QSize(m_width, m_height)) {
+                return cached;
+            }
+        }
+    } else {
+        m_lastSignature.clear();
+    }
 
-    // Capture the frame
-    return captureFrame();
+    QImage frame;
+    QVector<double> times = subframeTimes(timeMs);
+    if (times.size() == 1) {
+        frame = renderAtTime(timeMs);
+    } else {
+        m_accumulator.reset(m_width, m_height);
+        for (double t : times) {
+            m_accumulator.add(renderAtTime(t));
+        }
+        frame = m_accumulator.result();
+    }
+
+    if (!m_lastSignature.isEmpty()) {
+        m_frameCache->store(m_lastSignature, frame);
+    }
+    return frame;
+}
+
+QByteArray FrameCapturer::frameSignatureAtTime(double timeMs) {
+    if (!m_renderer) return QByteArray();
+
+    QVector<double> times = subframeTimes(timeMs);
+    if (times.size() == 1) {
+        return signatureAtTime(timeMs);
+    }
+
+    // A blurred frame is identified by all of its subframes plus the shutter
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(m_blurSamples) + '/' + QByteArray::number(m_shutterAngle));
+    for (double t : times) {
+        hash.addData(signatureAtTime(t));
+    }
+    return hash.result();
 }
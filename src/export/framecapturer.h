@@ -2,10 +2,12 @@
 
 #include <QObject>
 #include <QImage>
+#include "frameaccumulator.h"
 
 class MapRenderer;
 class MapCamera;
 class AnimationController;
+class FrameCache;
 
 class FrameCapturer : public QObject {
     Q_OBJECT
@@ -18,19 +20,44 @@ public:
     void setAnimationController(AnimationController* controller);
     void setOutputSize(int width, int height);
 
+    // When set, frames whose signature is cached are loaded instead of rendered
+    void setFrameCache(FrameCache* cache) { m_frameCache = cache; }
+
+    // Motion blur: average `samples` subframes spread over the shutter
+    // (in degrees of the frame interval, 360 = whole frame), centred on the
+    // frame time. samples <= 1 disables it.
+    void setMotionBlur(int samples, double shutterAngle, double frameDurationMs);
+
     // Capture current state to image
     QImage captureFrame();
 
-    // Capture frame at specific time
+    // Capture frame at a presentation time (speed curve applied, as in playback)
     QImage captureFrameAtTime(double timeMs);
 
+    // Signature of the frame at a time, without rendering it
+    QByteArray frameSignatureAtTime(double timeMs);
+
+    // Signature of the most recent captureFrameAtTime() (empty without a cache)
+    QByteArray lastSignature() const { return m_lastSignature; }
+
     int outputWidth() const { return m_width; }
     int outputHeight() const { return m_height; }
 
 private:
+    QImage renderAtTime(double timeMs);
+    QByteArray signatureAtTime(double timeMs);
+    QVector<double> subframeTimes(double timeMs) const;
+
     MapRenderer* m_renderer = nullptr;
     MapCamera* m_camera = nullptr;
     AnimationController* m_controller = nullptr;
+    FrameCache* m_frameCache = nullptr;
+    QByteArray m_lastSignature;
     int m_width = 1920;
     int m_height = 1080;
+
+    int m_blurSamples = 1;
+    double m_shutterAngle = 180.0;
+    double m_frameDurationMs = 1000.0 / 30.0;
+    FrameAccumulator m_accumulator;
 };
@@ -0,0 +1,209 @@
+#include "imagesequencewriter.h"
+#include "qoicodec.h"
+#include <QDir>
+#include <QFile>
+#include <QImageWriter>
+#include <QThread>
+#include <cstring>
+
+ImageSequenceWriter::ImageSequenceWriter(QObject* parent)
+    : QObject(parent)
+{
+}
+
+ImageSequenceWriter::~ImageSequenceWriter() {
+    abort();
+}
+
+void ImageSequenceWriter::setThreadCount(int threads) {
+    m_pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+}
+
+QStringList ImageSequenceWriter::supportedFormats() {
+    QStringList formats = {"png", "tga", "qoi"};
+    if (QImageWriter::supportedImageFormats().contains("tiff")) {
+        formats.append("tiff");
+    }
+    return formats;
+}
+
+bool ImageSequenceWriter::start(const QString& directory, const QString& format) {
+    if (m_running) return false;
+
+    QString fmt = format.toLower();
+    if (fmt == "png") {
+        m_format = Format::Png;
+    } else if (fmt == "tiff" || fmt == "tif") {
+        if (!QImageWriter::supportedImageFormats().contains("tiff")) {
+            emit error("TIFF export requires the Qt TIFF image plugin");
+            return false;
+        }
+        m_format = Format::Tiff;
+    } else if (fmt == "tga") {
+        m_format = Format::Tga;
+    } else if (fmt == "qoi") {
+        m_format = Format::Qoi;
+    } else {
+        emit error(QString("Unsupported image sequence format: %1").arg(format));
+        return false;
+    }
+
+    if (!QDir().mkpath(directory)) {
+        emit error(QString("Cannot create output directory: %1").arg(directory));
+        return false;
+    }
+
+    m_directory = directory;
+    m_pending = 0;
+    m_failed = false;
+    m_finishing = false;
+    m_firstError.clear();
+
+    m_running = true;
+    emit runningChanged();
+    return true;
+}
+
+QString ImageSequenceWriter::framePath(int frameIndex) const {
+    static const char* extensions[] = {"png", "tif", "tga", "qoi"};
+    return QDir(m_directory).filePath(QString("%1_%2.%3")
+        .arg(m_baseName)
+        .arg(frameIndex, 6, 10, QChar('0'))
+        .arg(extensions[static_cast<int>(m_format)]));
+}
+
+void ImageSequenceWriter::writeFrame(int frameIndex, const QImage& frame) {
+    if (!m_running) return;
+
+    if (m_failed) {
+        m_errorMutex.lock();
+        QString message = m_firstError;
+        m_errorMutex.unlock();
+        emit error(message);
+        return;
+    }
+
+    QString path = framePath(frameIndex);
+    m_pending++;
+
+    // QImage is implicitly shared, so the copy handed to the worker is cheap
+    m_pool.start([this, path, frame]() {
+        if (!m_failed && !encodeFrame(path, frame)) {
+            reportFailure(QString("Failed to write %1").arg(path));
+        }
+        // After finish(), the last write completes it on the writer's thread
+        if (--m_pending == 0 && m_finishing) {
+            QMetaObject::invokeMethod(this, &ImageSequenceWriter::completeFinish, Qt::QueuedConnection);
+        }
+    });
+}
+
+void ImageSequenceWriter::finish() {
+    if (!m_running || m_finishing) return;
+
+    m_finishing = true;
+    if (m_pending == 0) {
+        QMetaObject::invokeMethod(this, &ImageSequenceWriter::completeFinish, Qt::QueuedConnection);
+    }
+}
+
+void ImageSequenceWriter::completeFinish() {
+    // Both finish() and the last write may queue this; abort() cancels it
+    if (!m_running || !m_finishing) return;
+
+    m_finishing = false;
+    m_running = false;
+    emit runningChanged();
+
+    if (m_failed) {
+        m_errorMutex.lock();
+        QString message = m_firstError;
+        m_errorMutex.unlock();
+        emit error(message);
+    }
+    emit finished(!m_failed);
+}
+
+void ImageSequenceWriter::abort() {
+    if (!m_running) return;
+
+    m_finishing = false;
+    m_pool.clear();
+    m_pool.waitForDone();
+    m_pending = 0;
+
+    m_running = false;
+    emit runningChanged();
+}
+
+void ImageSequenceWriter::reportFailure(const QString& message) {
+    QMutexLocker lock(&m_errorMutex);
+    if (!m_failed) {
+        m_firstError = message;
+        m_failed = true;
+    }
+}
+
+bool ImageSequenceWriter::encodeFrame(const QString& path, const QImage& frame) const {
+    switch (m_format) {
+        case Format::Tga:
+            return writeTga(path, frame);
+        case Format::Qoi:
+            return writeQoi(path, frame);
+        case Format::Tiff: {
+            QImageWriter writer(path, "tiff");
+            writer.setCompression(1);  // LZW
+            return writer.write(frame);
+        }
+        case Format::Png:
+        default: {
+            QImageWriter writer(path, "png");
+            writer.setCompression(m_compressionLevel);  // zlib level
+            return writer.write(frame);
+        }
+    }
+}
+
+bool ImageSequenceWriter::writeTga(const QString& path, const QImage& frame) {
+    QImage img = frame.convertToFormat(QImage::Format_ARGB32);
+    const int w = img.width();
+    const int h = img.height();
+
+    // Uncompressed true-color, 32 bpp, 8 alpha bits, top-left origin
+    unsigned char header[18] = {};
+    header[2] = 2;
+    header[12] = w & 0xFF;
+    header[13] = (w >> 8) & 0xFF;
+    header[14] = h & 0xFF;
+    header[15] = (h >> 8) & 0xFF;
+    header[16] = 32;
+    header[17] = 0x28;
+
+    QByteArray data;
+    data.resize(18 + w * h * 4);
+    std::memcpy(data.data(), header, 18);
+
+    unsigned char* out = reinterpret_cast<unsigned char*>(data.data()) + 18;
+    for (int y = 0; y < h; ++y) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(img.constScanLine(y));
+        for (int x = 0; x < w; ++x) {
+            QRgb px = line[x];
+            *out++ = qBlue(px);
+            *out++ = qGreen(px);
+            *out++ = qRed(px);
+            *out++ = qAlpha(px);
+        }
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    return file.write(data) == data.size();
+}
+
+bool ImageSequenceWriter::writeQoi(const QString& path, const QImage& frame) {
+    QByteArray data = QoiCodec::encode(frame);
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    return file.write(data) == data.size();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QObject>
+#include <QImage>
+#include <QMutex>
+#include <QThreadPool>
+#include <atomic>
+
+// Writes numbered still frames (e.g. frame_001200.png) as an alternative to
+// FFmpegPipeline. Encoding and disk writes run on a private thread pool so
+// compression does not stall the render loop.
+class ImageSequenceWriter : public QObject {
+    Q_OBJECT
+
+    Q_PROPERTY(bool running READ isRunning NOTIFY runningChanged)
+
+public:
+    enum class Format {
+        Png,    // Lossless, compression level 0-9
+        Tiff,   // Requires the Qt TIFF image plugin
+        Tga,    // Uncompressed 32-bit, fastest to write
+        Qoi     // Lossless, several times faster than PNG
+    };
+
+    explicit ImageSequenceWriter(QObject* parent = nullptr);
+    ~ImageSequenceWriter();
+
+    // Format name is "png", "tiff", "tga" or "qoi"
+    bool start(const QString& directory, const QString& format);
+    void writeFrame(int frameIndex, const QImage& frame);
+
+    // Returns at once; finished() follows when the queued frames are written
+    void finish();
+    void abort();
+
+    void setBaseName(const QString& name) { m_baseName = name; }
+    void setCompressionLevel(int level) { m_compressionLevel = qBound(0, level, 9); }
+    int compressionLevel() const { return m_compressionLevel; }
+    void setThreadCount(int threads);
+
+    // Frames queued or being encoded; callers throttle on this
+    int pendingFrames() const { return m_pending.load(); }
+    int maxPendingFrames() const { return m_pool.maxThreadCount() * 2; }
+
+    QString framePath(int frameIndex) const;
+    bool isRunning() const { return m_running; }
+
+    static QStringList supportedFormats();
+
+signals:
+    void finished(bool success);
+    void error(const QString& message);
+    void runningChanged();
+
+private:
+    void completeFinish();
+    bool encodeFrame(const QString& path, const QImage& frame) const;
+    void reportFailure(const QString& message);
+
+    static bool writeTga(const QString& path, const QImage& frame);
+    static bool writeQoi(const QString& path, const QImage& frame);
+
+    QThreadPool m_pool;
+    QString m_directory;
+    QString m_baseName = "frame";
+    Format m_format = Format::Png;
+    int m_compressionLevel = 6;
+    bool m_running = false;
+
+    std::atomic<int> m_pending{0};
+    std::atomic<bool> m_failed{false};
+    std::atomic<bool> m_finishing{false};
+    mutable QMutex m_errorMutex;
+    QString m_firstError;
+};
@@ -0,0 +1,184 @@
+#include "qoicodec.h"
+
+namespace {
+
+struct Px { uchar r, g, b, a; };
+
+inline int qoiHash(const Px& px) {
+    return (px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64;
+}
+
+inline bool samePx(const Px& a, const Px& b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+constexpr char QOI_PADDING[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+constexpr int QOI_HEADER_SIZE = 14;
+
+}  // namespace
+
+void QoiCodec::encodeRows(QByteArray& out, const uchar* bits, qsizetype stride, int width, int rows) {
+    Px index[64] = {};
+    Px prev = {0, 0, 0, 255};
+    int run = 0;
+
+    for (int y = 0; y < rows; ++y) {
+        const uchar* line = bits + y * stride;
+        for (int x = 0; x < width; ++x) {
+            const uchar* p = line + x * 4;
+            Px px = {p[0], p[1], p[2], p[3]};
+            bool last = (y == rows - 1 && x == width - 1);
+
+            if (samePx(px, prev)) {
+                run++;
+                if (run == 62 || last) {
+                    out.append(char(0xC0 | (run - 1)));
+                    run = 0;
+                }
+                continue;
+            }
+
+            if (run > 0) {
+                out.append(char(0xC0 | (run - 1)));
+                run = 0;
+            }
+
+            int hash = qoiHash(px);
+            if (samePx(index[hash], px)) {
+                out.append(char(hash));
+            } else {
+                index[hash] = px;
+
+                if (px.a == prev.a) {
+                    signed char vr = static_cast<signed char>(px.r - prev.r);
+                    signed char vg = static_cast<signed char>(px.g - prev.g);
+                    signed char vb = static_cast<signed char>(px.b - prev.b);
+                    int vgr = vr - vg;
+                    int vgb = vb - vg;
+
+                    if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                        out.append(char(0x40 | ((vr + 2) << 4) | ((vg + 2) << 2) | (vb + 2)));
+                    } else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8) {
+                        out.append(char(0x80 | (vg + 32)));
+                        out.append(char(((vgr + 8) << 4) | (vgb + 8)));
+                    } else {
+                        out.append(char(0xFE));
+                        out.append(char(px.r));
+                        out.append(char(px.g));
+                        out.append(char(px.b));
+                    }
+                } else {
+                    out.append(char(0xFF));
+                    out.append(char(px.r));
+                    out.append(char(px.g));
+                    out.append(char(px.b));
+                    out.append(char(px.a));
+                }
+            }
+            prev = px;
+        }
+    }
+}
+
+bool QoiCodec::decodeRows(const uchar* data, qsizetype size, uchar* bits, qsizetype stride,
+                          int width, int rows) {
+    Px index[64] = {};
+    Px px = {0, 0, 0, 255};
+    int run = 0;
+    qsizetype pos = 0;
+
+    for (int y = 0; y < rows; ++y) {
+        uchar* line = bits + y * stride;
+        for (int x = 0; x < width; ++x) {
+            if (run > 0) {
+                run--;
+            } else {
+                if (pos >= size) return false;
+                const uchar b1 = data[pos++];
+
+                if (b1 == 0xFE) {
+                    if (pos + 3 > size) return false;
+                    px.r = data[pos++];
+                    px.g = data[pos++];
+                    px.b = data[pos++];
+                } else if (b1 == 0xFF) {
+                    if (pos + 4 > size) return false;
+                    px.r = data[pos++];
+                    px.g = data[pos++];
+                    px.b = data[pos++];
+                    px.a = data[pos++];
+                } else if ((b1 & 0xC0) == 0x00) {
+                    px = index[b1];
+                } else if ((b1 & 0xC0) == 0x40) {
+                    px.r += ((b1 >> 4) & 0x03) - 2;
+                    px.g += ((b1 >> 2) & 0x03) - 2;
+                    px.b += (b1 & 0x03) - 2;
+                } else if ((b1 & 0xC0) == 0x80) {
+                    if (pos >= size) return false;
+                    const uchar b2 = data[pos++];
+                    int vg = (b1 & 0x3F) - 32;
+                    px.r += vg - 8 + ((b2 >> 4) & 0x0F);
+                    px.g += vg;
+                    px.b += vg - 8 + (b2 & 0x0F);
+                } else {
+                    run = b1 & 0x3F;
+                }
+                index[qoiHash(px)] = px;
+            }
+
+            uchar* out = line + x * 4;
+            out[0] = px.r;
+            out[1] = px.g;
+            out[2] = px.b;
+            out[3] = px.a;
+        }
+    }
+    return true;
+}
+
+QByteArray QoiCodec::encode(const QImage& image) {
+    QImage img = image.convertToFormat(QImage::Format_RGBA8888);
+    const quint32 w = img.width();
+    const quint32 h = img.height();
+
+    QByteArray data;
+    data.reserve(QOI_HEADER_SIZE + w * h * 5 + 8);
+
+    auto put32 = [&data](quint32 v) {
+        data.append(char(v >> 24));
+        data.append(char(v >> 16));
+        data.append(char(v >> 8));
+        data.append(char(v));
+    };
+
+    data.append("qoif", 4);
+    put32(w);
+    put32(h);
+    data.append(char(4));   // RGBA
+    data.append(char(0));   // sRGB with linear alpha
+
+    encodeRows(data, img.constBits(), img.bytesPerLine(), img.width(), img.height());
+
+    data.append(QOI_PADDING, 8);
+    return data;
+}
+
+QImage QoiCodec::decode(const QByteArray& data) {
+    if (data.size() < QOI_HEADER_SIZE || !data.startsWith("qoif")) return QImage();
+
+    const uchar* p = reinterpret_cast<const uchar*>(data.constData());
+    auto get32 = [p](int offset) {
+        return (quint32(p[offset]) << 24) | (quint32(p[offset + 1]) << 16)
+             | (quint32(p[offset + 2]) << 8) | quint32(p[offset + 3]);
+    };
+    const quint32 w = get32(4);
+    const quint32 h = get32(8);
+    if (w == 0 || h == 0 || w > 32768 || h > 32768) return QImage();
+
+    QImage img(static_cast<int>(w), static_cast<int>(h), QImage::Format_RGBA8888);
+    if (!decodeRows(p + QOI_HEADER_SIZE, data.size() - QOI_HEADER_SIZE, img.bits(),
+                    img.bytesPerLine(), img.width(), img.height())) {
+        return QImage();
+    }
+    return img;
+}
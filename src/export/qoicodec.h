@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+
+// "Quite OK Image" lossless codec, see https://qoiformat.org/qoi-specification.pdf
+// encode()/decode() read and write complete RGBA files. The row functions
+// work on raw 4-byte pixels in whatever channel order the caller uses, with
+// no header, so frame caches can compress ARGB32 bands independently.
+class QoiCodec {
+public:
+    static QByteArray encode(const QImage& image);
+    static QImage decode(const QByteArray& data);
+
+    // Appends the chunks for rows [0, rows) of a width-pixel image
+    static void encodeRows(QByteArray& out, const uchar* bits, qsizetype stride, int width, int rows);
+
+    // Decodes exactly width * rows pixels; false on truncated input
+    static bool decodeRows(const uchar* data, qsizetype size, uchar* bits, qsizetype stride,
+                           int width, int rows);
+};
@@ -1,17 +1,35 @@
 #include "videoexporter.h"
 #include "ffmpegpipeline.h"
+#include "imagesequencewriter.h"
+#include "framecache.h"
 #include "framecapturer.h"
 #include "../animation/animationcontroller.h"
 #include "../map/maprenderer.h"
+#include "../core/projectmanager.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QThread>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <cmath>
 
 VideoExporter::VideoExporter(QObject* parent)
     : QObject(parent)
     , m_ffmpeg(new FFmpegPipeline(this))
+    , m_frameCache(new FrameCache(this))
+    , m_sequence(new ImageSequenceWriter(this))
     , m_capturer(new FrameCapturer(this))
     , m_frameTimer(new QTimer(this))
 {
     connect(m_ffmpeg, &FFmpegPipeline::finished, this, &VideoExporter::onFFmpegFinished);
     connect(m_ffmpeg, &FFmpegPipeline::error, this, &VideoExporter::onFFmpegError);
+    connect(m_sequence, &ImageSequenceWriter::finished, this, &VideoExporter::onSequenceFinished);
+    connect(m_sequence, &ImageSequenceWriter::error, this, &VideoExporter::onFFmpegError);
 
     m_frameTimer->setSingleShot(true);
     connect(m_frameTimer, &QTimer::timeout, this, &VideoExporter::processNextFrame);
@@ -31,40 +49,139 @@ void VideoExporter::setMapRenderer(MapRenderer* renderer) {
     m_capturer->setRenderer(renderer);
 }
 
-void VideoExporter::startExport(const QString& outputPath, int width, int height, int framerate) {
+void VideoExporter::setSegmentCount(int count) {
+    count = qBound(1, count, MAX_SEGMENTS);
+    if (m_segmentCount != count) {
+        m_segmentCount = count;
+        emit segmentCountChanged();
+    }
+}
+
+void VideoExporter::setResumable(bool resumable) {
+    if (m_resumable != resumable) {
+        m_resumable = resumable;
+        emit resumableChanged();
+    }
+}
+
+int VideoExporter::imageCompression() const {
+    return m_sequence->compressionLevel();
+}
+
+void VideoExporter::setImageCompression(int level) {
+    if (m_sequence->compressionLevel() != qBound(0, level, 9)) {
+        m_sequence->setCompressionLevel(level);
+        emit imageCompressionChanged();
+    }
+}
+
+QStringList VideoExporter::imageFormats() const {
+    return ImageSequenceWriter::supportedFormats();
+}
+
+bool VideoExporter::prepareExport(const QString& outputPath, int width, int height, const FrameRate& rate) {
     if (m_exporting) {
         emit exportError("Export already in progress");
-        return;
+        return false;
     }
 
     if (!m_controller) {
         emit exportError("No animation controller set");
-        return;
+        return false;
+    }
+
+    if (!rate.isValid()) {
+        emit exportError("Invalid frame rate");
+        return false;
     }
 
     m_outputPath = outputPath;
     m_width = width;
     m_height = height;
-    m_framerate = framerate;
-    m_frameDurationMs = 1000.0 / framerate;
+    m_frameRate = rate;
 
-    m_totalDuration = m_controller->totalDuration();
+    // Wall-clock length, so the speed curve plays out exactly as in the preview
+    m_totalDuration = m_controller->playbackDuration();
     if (m_totalDuration <= 0) {
         emit exportError("No animation to export");
-        return;
+        return false;
     }
 
-    m_totalFrames = static_cast<int>(std::ceil(m_totalDuration / m_frameDurationMs));
+    // Frame times are derived from integer ticks, never accumulated
+    m_totalFrames = static_cast<int>(m_frameRate.frameCount(Timebase::fromMs(m_totalDuration)));
     m_currentFrame = 0;
     m_progress = 0.0;
     m_cancelled = false;
+    m_sequenceMode = false;
 
     m_capturer->setOutputSize(width, height);
+    m_capturer->setFrameCache(m_incremental ? m_frameCache : nullptr);
+    m_capturer->setMotionBlur(m_motionBlurSamples, m_shutterAngle, m_frameRate.frameDurationMs());
+    return true;
+}
+
+void VideoExporter::setMotionBlurSamples(int samples) {
+    samples = qBound(1, samples, MAX_BLUR_SAMPLES);
+    if (m_motionBlurSamples != samples) {
+        m_motionBlurSamples = samples;
+        emit motionBlurChanged();
+    }
+}
+
+void VideoExporter::setShutterAngle(double degrees) {
+    degrees = qBound(0.0, degrees, 360.0);
+    if (!qFuzzyCompare(m_shutterAngle, degrees)) {
+        m_shutterAngle = degrees;
+        emit motionBlurChanged();
+    }
+}
+
+void VideoExporter::setIncremental(bool incremental) {
+    if (m_incremental != incremental) {
+        m_incremental = incremental;
+        emit incrementalChanged();
+    }
+}
+
+void VideoExporter::setKeepParts(bool keep) {
+    if (m_keepParts != keep) {
+        m_keepParts = keep;
+        emit keepPartsChanged();
+    }
+}
+
+int VideoExporter::gopFrames() const {
+    return qMax(1, qRound(m_frameRate.fps() * GOP_SECONDS));
+}
+
+void VideoExporter::startExport(const QString& outputPath, int width, int height, int framerate) {
+    startExport(outputPath, width, height, FrameRate(framerate));
+}
+
+void VideoExporter::startExport(const QString& outputPath, int width, int height, const FrameRate& rate) {
+    if (!prepareExport(outputPath, width, height, rate)) {
+        return;
+    }
 
     setStatus("Starting FFmpeg...");
     emit totalFramesChanged();
 
-    if (!m_ffmpeg->start(outputPath, width, height, framerate)) {
+    // Long timelines are split across several encoders when requested
+    if (isCheckpointed() || (m_segmentCount > 1 && m_totalFrames >= 2 * gopFrames())) {
+        if (!startSegmentedExport()) {
+            emit exportError("Failed to start FFmpeg");
+            return;
+        }
+
+        m_exporting = true;
+        emit exportingChanged();
+
+        setStatus("Rendering frames...");
+        processNextSegmentFrame();
+        return;
+    }
+
+    if (!m_ffmpeg->start(outputPath, width, height, m_frameRate)) {
         emit exportError("Failed to start FFmpeg");
         return;
     }
@@ -84,6 +201,11 @@ void VideoExporter::cancelExport() {
     m_cancelled = true;
     m_frameTimer->stop();
     m_ffmpeg->abort();
+    m_sequence->abort();
+    clearSegments();
+    if (!keepSegmentFiles(false)) {
+        removeSegmentFiles();
+    }
 
     m_exporting = false;
     emit exportingChanged();
@@ -97,7 +219,17 @@ void VideoExporter::processNextFrame() {
         return;
     }
 
-    double timeMs = m_currentFrame * m_frameDurationMs;
+    if (m_sequenceMode) {
+        processNextSequenceFrame();
+        return;
+    }
+
+    if (!m_segments.isEmpty()) {
+        processNextSegmentFrame();
+        return;
+    }
+
+    double timeMs = frameTimeMs(m_currentFrame);
 
     // Check if we've reached the end
     if (timeMs > m_totalDuration) {
@@ -126,6 +258,19 @@ void VideoExporter::processNextFrame() {
 }
 
 void VideoExporter::onFFmpegFinished(bool success) {
+    // In segmented mode this is the concat step; keep the parts for resume or reuse
+    if (!m_segments.isEmpty()) {
+        clearSegments();
+        if (!keepSegmentFiles(success)) {
+            removeSegmentFiles();
+        }
+    }
+
+    if (m_incremental) {
+        m_frameCache->waitForWrites();
+        m_frameCache->enforceDiskLimit();
+    }
+
     m_exporting = false;
     emit exportingChanged();
 
@@ -140,6 +285,11 @@ void VideoExporter::onFFmpegFinished(bool success) {
 
 void VideoExporter::onFFmpegError(const QString& error) {
     m_frameTimer->stop();
+    m_sequence->abort();
+    clearSegments();
+    if (!keepSegmentFiles(false)) {
+        removeSegmentFiles();
+    }
     m_exporting = false;
     emit exportingChanged();
 
@@ -153,3 +303,454 @@ void VideoExporter::setStatus(const QString& status) {
         emit statusChanged();
     }
 }
+
+void VideoExporter::startImageSequenceExport(const QString& directory, int width, int height, int framerate,
+                                             const QString& format, int firstFrame, int lastFrame) {
+    startImageSequenceExport(directory, width, height, FrameRate(framerate), format, firstFrame, lastFrame);
+}
+
+void VideoExporter::startImageSequenceExport(const QString& directory, int width, int height,
+                                             const FrameRate& rate, const QString& format,
+                                             int firstFrame, int lastFrame) {
+    if (!prepareExport(directory, width, height, rate)) {
+        return;
+    }
+
+    int endFrame = m_totalFrames - 1;
+    m_sequenceFrame = qBound(0, firstFrame, endFrame);
+    m_sequenceLastFrame = lastFrame < 0 ? endFrame : qBound(m_sequenceFrame, lastFrame, endFrame);
+
+    // Progress counts only the requested range
+    m_totalFrames = m_sequenceLastFrame - m_sequenceFrame + 1;
+    emit totalFramesChanged();
+
+    if (!m_sequence->start(directory, format)) {
+        emit exportError("Failed to start image sequence export");
+        return;
+    }
+
+    m_sequenceMode = true;
+    m_exporting = true;
+    emit exportingChanged();
+
+    setStatus("Rendering frames...");
+    processNextSequenceFrame();
+}
+
+void VideoExporter::processNextSequenceFrame() {
+    if (m_sequenceFrame > m_sequenceLastFrame) {
+        setStatus("Finishing image writes...");
+        m_sequence->finish();
+        return;
+    }
+
+    // Let the compression threads catch up instead of queueing unbounded frames
+    if (m_sequence->pendingFrames() >= m_sequence->maxPendingFrames()) {
+        m_frameTimer->start(5);
+        return;
+    }
+
+    QImage frame = m_capturer->captureFrameAtTime(frameTimeMs(m_sequenceFrame));
+    m_sequence->writeFrame(m_sequenceFrame, frame);
+    m_sequenceFrame++;
+
+    m_currentFrame++;
+    m_progress = static_cast<double>(m_currentFrame) / m_totalFrames;
+
+    emit progressChanged();
+    emit currentFrameChanged();
+
+    setStatus(QString("Rendering frame %1 of %2").arg(m_currentFrame).arg(m_totalFrames));
+
+    m_frameTimer->start(0);
+}
+
+void VideoExporter::onSequenceFinished(bool success) {
+    if (!m_exporting) return;
+
+    m_sequenceMode = false;
+    m_exporting = false;
+    emit exportingChanged();
+
+    if (success && !m_cancelled) {
+        setStatus("Export complete!");
+        emit exportComplete(m_outputPath);
+    } else if (!m_cancelled) {
+        setStatus("Export failed");
+        emit exportError("Writing image sequence failed");
+    }
+}
+
+bool VideoExporter::startSegmentedExport() {
+    // Segment boundaries fall on GOP boundaries so the parts can be joined without re-encoding
+    // Whole GOPs per segment; at NTSC rates a GOP is the rounded frame count
+    int gop = gopFrames();
+    int framesPerSegment = gop * (RESUME_SEGMENT_SECONDS / GOP_SECONDS);
+    if (!isCheckpointed()) {
+        int gopCount = (m_totalFrames + gop - 1) / gop;
+        int segmentCount = qMin(m_segmentCount, gopCount);
+        framesPerSegment = ((gopCount + segmentCount - 1) / segmentCount) * gop;
+    }
+
+    m_segmentDir = m_outputPath + ".parts";
+    if (!QDir().mkpath(m_segmentDir)) {
+        m_segmentDir.clear();
+        return false;
+    }
+
+    for (int first = 0, i = 0; first < m_totalFrames; first += framesPerSegment, ++i) {
+        Segment seg;
+        seg.firstFrame = first;
+        seg.endFrame = qMin(m_totalFrames, first + framesPerSegment);
+        seg.nextFrame = first;
+        seg.path = QDir(m_segmentDir).filePath(QString("segment_%1.mp4").arg(i, 4, 10, QChar('0')));
+        m_segments.append(seg);
+    }
+
+    m_projectHash = m_projectManager ? m_projectManager->contentHash() : QString();
+    if (isCheckpointed()) {
+        loadManifest();
+    }
+
+    m_nextSegment = 0;
+    return true;
+}
+
+bool VideoExporter::startSegment(int index) {
+    Segment& seg = m_segments[index];
+
+    // Share the cores between the encoders instead of oversubscribing
+    int threads = qMax(1, QThread::idealThreadCount() / m_segmentCount);
+
+    seg.pipeline = new FFmpegPipeline(this);
+    seg.pipeline->setGopSize(gopFrames());
+    seg.pipeline->setThreadCount(threads);
+    seg.started = true;
+
+    connect(seg.pipeline, &FFmpegPipeline::finished, this, [this, index](bool success) {
+        onSegmentFinished(index, success);
+    });
+    connect(seg.pipeline, &FFmpegPipeline::error, this, [this](const QString& error) {
+        if (m_exporting && !m_cancelled) {
+            failSegmentedExport(error);
+        }
+    });
+
+    return seg.pipeline->start(partialPath(seg.path), m_width, m_height, m_frameRate);
+}
+
+void VideoExporter::processNextSegmentFrame() {
+    if (m_cancelled || !m_exporting) {
+        return;
+    }
+
+    const int count = m_segments.size();
+
+    // Keep up to segmentCount encoders running, starting segments in timeline order
+    int running = 0;
+    for (const Segment& seg : m_segments) {
+        if (seg.started && !seg.done) running++;
+    }
+    for (int i = 0; i < count && running < m_segmentCount; ++i) {
+        if (m_segments[i].started || m_segments[i].done) continue;
+
+        // Check one segment per pass so long clean stretches don't stall the UI
+        if (m_incremental && !m_segments[i].checked) {
+            if (reuseSegment(i)) {
+                m_frameTimer->start(0);
+                return;
+            }
+        }
+
+        if (!startSegment(i)) {
+            failSegmentedExport(QString("Failed to start FFmpeg for segment %1").arg(i + 1));
+            return;
+        }
+        running++;
+    }
+
+    // Round-robin over the open segments so every encoder stays busy, skipping
+    // any whose stdin backlog shows it has fallen behind
+    const qint64 frameBytes = static_cast<qint64>(m_width) * m_height * 4;
+    bool anyOpen = false;
+
+    for (int n = 0; n < count; ++n) {
+        int index = (m_nextSegment + n) % count;
+        Segment& seg = m_segments[index];
+        if (!seg.started || seg.inputClosed) continue;
+        anyOpen = true;
+
+        if (seg.pipeline->pendingBytes() > MAX_PENDING_FRAMES * frameBytes) continue;
+
+        QImage frame = m_capturer->captureFrameAtTime(frameTimeMs(seg.nextFrame));
+        seg.pipeline->writeFrame(frame);
+        seg.frameSignatures.append(m_capturer->lastSignature());
+        seg.nextFrame++;
+
+        if (seg.nextFrame >= seg.endFrame) {
+            seg.inputClosed = true;
+            seg.pipeline->closeInput();
+        }
+
+        m_nextSegment = (index + 1) % count;
+
+        int rendered = 0;
+        for (const Segment& s : m_segments) {
+            rendered += s.nextFrame - s.firstFrame;
+        }
+        m_currentFrame = rendered;
+        m_progress = static_cast<double>(rendered) / m_totalFrames;
+
+        emit progressChanged();
+        emit currentFrameChanged();
+
+        setStatus(QString("Rendering frame %1 of %2 (%3 segments)")
+                  .arg(m_currentFrame).arg(m_totalFrames).arg(count));
+
+        m_frameTimer->start(0);
+        return;
+    }
+
+    if (running == 0) {
+        // Everything was already encoded by an earlier run
+        joinSegments();
+        return;
+    }
+
+    if (!anyOpen) {
+        // All started segments are finalizing; onSegmentFinished() continues from here
+        setStatus("Encoding segments...");
+        return;
+    }
+
+    // Every open encoder is backed up; give them a moment to drain
+    m_frameTimer->start(5);
+}
+
+void VideoExporter::onSegmentFinished(int index, bool success) {
+    if (m_cancelled || !m_exporting || index >= m_segments.size()) {
+        return;
+    }
+
+    if (!success) {
+        failSegmentedExport(QString("FFmpeg failed encoding segment %1").arg(index + 1));
+        return;
+    }
+
+    Segment& seg = m_segments[index];
+    seg.done = true;
+    if (!seg.frameSignatures.isEmpty()) {
+        seg.signature = QCryptographicHash::hash(seg.frameSignatures, QCryptographicHash::Sha1);
+        seg.frameSignatures.clear();
+    }
+    seg.pipeline->disconnect(this);
+    seg.pipeline->deleteLater();
+    seg.pipeline = nullptr;
+
+    // Segments are encoded under a temporary name so a crash never leaves a
+    // truncated file that a later run would trust
+    QFile::remove(seg.path);
+    if (!QFile::rename(partialPath(seg.path), seg.path)) {
+        failSegmentedExport(QString("Failed to finalize segment %1").arg(index + 1));
+        return;
+    }
+
+    if (isCheckpointed()) {
+        writeManifest();
+    }
+
+    for (const Segment& s : m_segments) {
+        if (!s.done) {
+            // An encoder slot is free; wake the render loop if it was waiting
+            if (!m_frameTimer->isActive()) {
+                m_frameTimer->start(0);
+            }
+            return;
+        }
+    }
+
+    joinSegments();
+}
+
+bool VideoExporter::reuseSegment(int index) {
+    Segment& seg = m_segments[index];
+    seg.checked = true;
+    if (seg.previousSignature.isEmpty() || !QFile::exists(seg.path)) {
+        return false;
+    }
+
+    // Evaluate every frame's inputs without rendering; this is cheap compared to drawing
+    QByteArray signatures;
+    for (int frame = seg.firstFrame; frame < seg.endFrame; ++frame) {
+        signatures.append(m_capturer->frameSignatureAtTime(frameTimeMs(frame)));
+    }
+    QByteArray signature = QCryptographicHash::hash(signatures, QCryptographicHash::Sha1);
+    if (signature != seg.previousSignature) {
+        return false;
+    }
+
+    seg.signature = signature;
+    seg.done = true;
+    seg.nextFrame = seg.endFrame;
+
+    m_currentFrame += seg.endFrame - seg.firstFrame;
+    m_progress = static_cast<double>(m_currentFrame) / m_totalFrames;
+    emit currentFrameChanged();
+    emit progressChanged();
+    setStatus(QString("Reusing unchanged segment %1").arg(index + 1));
+
+    writeManifest();
+    return true;
+}
+
+void VideoExporter::joinSegments() {
+    QStringList paths;
+    for (const Segment& seg : m_segments) {
+        paths.append(seg.path);
+    }
+
+    setStatus("Joining segments...");
+    if (!m_ffmpeg->concat(paths, m_outputPath)) {
+        failSegmentedExport("Failed to join segments");
+    }
+}
+
+void VideoExporter::failSegmentedExport(const QString& error) {
+    m_frameTimer->stop();
+    clearSegments();
+    if (!keepSegmentFiles(false)) {
+        removeSegmentFiles();
+    }
+
+    m_exporting = false;
+    emit exportingChanged();
+
+    setStatus("Export failed: " + error);
+    emit exportError(error);
+}
+
+void VideoExporter::clearSegments() {
+    for (Segment& seg : m_segments) {
+        if (seg.pipeline) {
+            seg.pipeline->disconnect(this);
+            seg.pipeline->abort();
+            // May be called from inside the pipeline's own signal
+            seg.pipeline->deleteLater();
+        }
+    }
+    m_segments.clear();
+}
+
+void VideoExporter::removeSegmentFiles() {
+    if (m_segmentDir.isEmpty()) return;
+    QDir(m_segmentDir).removeRecursively();
+    m_segmentDir.clear();
+}
+
+QString VideoExporter::partialPath(const QString& segmentPath) {
+    // Only the file name changes; the segment directory itself ends in
+    // ".mp4.parts"
+    QFileInfo fi(segmentPath);
+    return fi.dir().filePath(fi.completeBaseName() + ".partial.mp4");
+}
+
+QString VideoExporter::manifestPath() const {
+    return QDir(m_segmentDir).filePath("manifest.json");
+}
+
+void VideoExporter::loadManifest() {
+    QFile file(manifestPath());
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+
+    if (root["width"].toInt() != m_width
+        || root["height"].toInt() != m_height
+        || root["framerate"].toVariant().toString() != m_frameRate.toString()
+        || root["motionBlurSamples"].toInt(1) != m_motionBlurSamples
+        || root["shutterAngle"].toDouble(180.0) != m_shutterAngle) {
+        qDebug() << "VideoExporter: Discarding export checkpoint with different settings in" << m_segmentDir;
+        return;
+    }
+
+    // Incremental mode compares per-segment signatures as each segment comes up
+    if (m_incremental) {
+        const QJsonArray completed = root["completed"].toArray();
+        for (const QJsonValue& val : completed) {
+            QJsonObject obj = val.toObject();
+            for (Segment& seg : m_segments) {
+                if (seg.firstFrame == obj["firstFrame"].toInt(-1) && seg.endFrame == obj["endFrame"].toInt(-1)) {
+                    seg.previousSignature = QByteArray::fromHex(obj["signature"].toString().toLatin1());
+                }
+            }
+        }
+        return;
+    }
+
+    // Plain resume only trusts segments from the same project
+    if (m_projectHash.isEmpty()
+        || root["projectHash"].toString() != m_projectHash
+        || root["totalFrames"].toInt() != m_totalFrames) {
+        qDebug() << "VideoExporter: Discarding stale export checkpoint in" << m_segmentDir;
+        return;
+    }
+
+    int resumed = 0;
+    const QJsonArray completed = root["completed"].toArray();
+    for (const QJsonValue& val : completed) {
+        QJsonObject obj = val.toObject();
+        int first = obj["firstFrame"].toInt(-1);
+        int end = obj["endFrame"].toInt(-1);
+
+        for (Segment& seg : m_segments) {
+            if (seg.firstFrame == first && seg.endFrame == end && QFile::exists(seg.path)) {
+                seg.done = true;
+                seg.nextFrame = seg.endFrame;
+                resumed += end - first;
+            }
+        }
+    }
+
+    if (resumed > 0) {
+        qDebug() << "VideoExporter: Resuming export," << resumed << "frames already encoded";
+        m_currentFrame = resumed;
+        m_progress = static_cast<double>(resumed) / m_totalFrames;
+        emit currentFrameChanged();
+        emit progressChanged();
+    }
+}
+
+void VideoExporter::writeManifest() const {
+    QJsonArray completed;
+    for (const Segment& seg : m_segments) {
+        if (!seg.done) continue;
+        QJsonObject obj;
+        obj["firstFrame"] = seg.firstFrame;
+        obj["endFrame"] = seg.endFrame;
+        obj["file"] = QFileInfo(seg.path).fileName();
+        if (!seg.signature.isEmpty()) {
+            obj["signature"] = QString::fromLatin1(seg.signature.toHex());
+        }
+        completed.append(obj);
+    }
+
+    QJsonObject root;
+    root["version"] = 1;
+    root["projectHash"] = m_projectHash;
+    root["width"] = m_width;
+    root["height"] = m_height;
+    root["framerate"] = m_frameRate.toString();
+    root["motionBlurSamples"] = m_motionBlurSamples;
+    root["shutterAngle"] = m_shutterAngle;
+    root["totalFrames"] = m_totalFrames;
+    root["completed"] = completed;
+
+    // Atomic replace so a crash never leaves a truncated manifest
+    QSaveFile file(manifestPath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "VideoExporter: Cannot write export manifest" << manifestPath();
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    file.commit();
+}
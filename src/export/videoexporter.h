@@ -2,11 +2,17 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QVector>
+#include <QStringList>
+#include "../animation/timebase.h"
 
 class FFmpegPipeline;
+class ImageSequenceWriter;
 class FrameCapturer;
 class AnimationController;
 class MapRenderer;
+class ProjectManager;
+class FrameCache;
 
 class VideoExporter : public QObject {
     Q_OBJECT
@@ -16,6 +22,14 @@ class VideoExporter : public QObject {
     Q_PROPERTY(QString status READ status NOTIFY statusChanged)
     Q_PROPERTY(int currentFrame READ currentFrame NOTIFY currentFrameChanged)
     Q_PROPERTY(int totalFrames READ totalFrames NOTIFY totalFramesChanged)
+    Q_PROPERTY(int segmentCount READ segmentCount WRITE setSegmentCount NOTIFY segmentCountChanged)
+    Q_PROPERTY(bool resumable READ resumable WRITE setResumable NOTIFY resumableChanged)
+    Q_PROPERTY(bool incremental READ incremental WRITE setIncremental NOTIFY incrementalChanged)
+    Q_PROPERTY(bool keepParts READ keepParts WRITE setKeepParts NOTIFY keepPartsChanged)
+    Q_PROPERTY(int imageCompression READ imageCompression WRITE setImageCompression NOTIFY imageCompressionChanged)
+    Q_PROPERTY(QStringList imageFormats READ imageFormats CONSTANT)
+    Q_PROPERTY(int motionBlurSamples READ motionBlurSamples WRITE setMotionBlurSamples NOTIFY motionBlurChanged)
+    Q_PROPERTY(double shutterAngle READ shutterAngle WRITE setShutterAngle NOTIFY motionBlurChanged)
 
 public:
     explicit VideoExporter(QObject* parent = nullptr);
@@ -23,6 +37,7 @@ public:
 
     void setAnimationController(AnimationController* controller);
     void setMapRenderer(MapRenderer* renderer);
+    void setProjectManager(ProjectManager* projectManager) { m_projectManager = projectManager; }
 
     bool isExporting() const { return m_exporting; }
     double progress() const { return m_progress; }
@@ -30,16 +45,63 @@ public:
     int currentFrame() const { return m_currentFrame; }
     int totalFrames() const { return m_totalFrames; }
 
+    // Number of parallel encoder segments (1 = single FFmpeg process)
+    int segmentCount() const { return m_segmentCount; }
+    void setSegmentCount(int count);
+
+    // Checkpointed export: fixed-length segments plus a manifest, so an
+    // interrupted export continues from the last completed segment
+    bool resumable() const { return m_resumable; }
+    void setResumable(bool resumable);
+
+    // Incremental re-export: segments whose frame signatures match the last
+    // export are reused, and unchanged frames come from the disk frame cache
+    bool incremental() const { return m_incremental; }
+    void setIncremental(bool incremental);
+
+    // Whether an incremental export leaves its segments in "<output>.parts"
+    // for the next one to reuse. Without them only the frame cache helps.
+    bool keepParts() const { return m_keepParts; }
+    void setKeepParts(bool keep);
+
+    // PNG zlib level for image sequences (0 = fastest, 9 = smallest)
+    int imageCompression() const;
+    void setImageCompression(int level);
+    QStringList imageFormats() const;
+
+    // Motion blur: subframes averaged per output frame (1 = off) over the
+    // shutter angle (180 = half the frame interval, the film default)
+    int motionBlurSamples() const { return m_motionBlurSamples; }
+    void setMotionBlurSamples(int samples);
+    double shutterAngle() const { return m_shutterAngle; }
+    void setShutterAngle(double degrees);
+
+    // Rational rates (30000/1001 for 29.97); the int slots below forward here
+    void startExport(const QString& outputPath, int width, int height, const FrameRate& rate);
+    void startImageSequenceExport(const QString& directory, int width, int height, const FrameRate& rate,
+                                  const QString& format = "png", int firstFrame = 0, int lastFrame = -1);
+
 public slots:
     void startExport(const QString& outputPath, int width, int height, int framerate);
     void cancelExport();
 
+    // Numbered stills instead of a video; lastFrame -1 means the end of the
+    // animation, so a subrange re-renders just those frames in place
+    void startImageSequenceExport(const QString& directory, int width, int height, int framerate,
+                                  const QString& format = "png", int firstFrame = 0, int lastFrame = -1);
+
 signals:
     void exportingChanged();
     void progressChanged();
     void statusChanged();
     void currentFrameChanged();
     void totalFramesChanged();
+    void segmentCountChanged();
+    void resumableChanged();
+    void incrementalChanged();
+    void keepPartsChanged();
+    void imageCompressionChanged();
+    void motionBlurChanged();
     void exportComplete(const QString& path);
     void exportError(const QString& error);
     void exportCancelled();
@@ -48,17 +110,81 @@ private slots:
     void processNextFrame();
     void onFFmpegFinished(bool success);
     void onFFmpegError(const QString& error);
+    void onSegmentFinished(int index, bool success);
+    void onSequenceFinished(bool success);
 
 private:
+    struct Segment {
+        FFmpegPipeline* pipeline = nullptr;
+        QString path;
+        int firstFrame = 0;
+        int endFrame = 0;      // Exclusive
+        int nextFrame = 0;
+        bool started = false;
+        bool inputClosed = false;
+        bool done = false;
+        bool checked = false;           // Incremental reuse check done
+        QByteArray frameSignatures;     // Concatenated per-frame signatures
+        QByteArray signature;           // Hash of frameSignatures once complete
+        QByteArray previousSignature;   // From the last export's manifest
+    };
+
     void setStatus(const QString& status);
+    bool prepareExport(const QString& outputPath, int width, int height, const FrameRate& rate);
+    double frameTimeMs(int frame) const { return m_frameRate.frameTimeMs(frame); }
+    int gopFrames() const;
+    void processNextSequenceFrame();
+    bool startSegmentedExport();
+    bool startSegment(int index);
+    bool reuseSegment(int index);
+    bool isCheckpointed() const { return m_resumable || m_incremental; }
+    bool keepSegmentFiles(bool success) const {
+        return (m_incremental && m_keepParts) || (!success && m_resumable);
+    }
+    void processNextSegmentFrame();
+    void joinSegments();
+    void failSegmentedExport(const QString& error);
+    void clearSegments();
+    void removeSegmentFiles();
+    QString manifestPath() const;
+    static QString partialPath(const QString& segmentPath);
+    void loadManifest();
+    void writeManifest() const;
+
+    static constexpr int GOP_SECONDS = 2;
+    static constexpr int MAX_SEGMENTS = 16;
+    static constexpr int RESUME_SEGMENT_SECONDS = 10;  // Work lost at most on failure
+    static constexpr int MAX_PENDING_FRAMES = 3;  // Per-segment stdin backlog before throttling
+    static constexpr int MAX_BLUR_SAMPLES = 32;
 
     FFmpegPipeline* m_ffmpeg = nullptr;
+    FrameCache* m_frameCache = nullptr;
+    ImageSequenceWriter* m_sequence = nullptr;
     FrameCapturer* m_capturer = nullptr;
     AnimationController* m_controller = nullptr;
     MapRenderer* m_renderer = nullptr;
+    ProjectManager* m_projectManager = nullptr;
 
     QTimer* m_frameTimer = nullptr;
 
+    // Segmented export state
+    QVector<Segment> m_segments;
+    QString m_segmentDir;
+    int m_segmentCount = 1;
+    int m_nextSegment = 0;
+    bool m_resumable = false;
+    bool m_incremental = false;
+    bool m_keepParts = true;
+    QString m_projectHash;
+
+    int m_motionBlurSamples = 1;
+    double m_shutterAngle = 180.0;
+
+    // Image sequence state
+    bool m_sequenceMode = false;
+    int m_sequenceFrame = 0;
+    int m_sequenceLastFrame = 0;
+
     bool m_exporting = false;
     bool m_cancelled = false;
     double m_progress = 0.0;
@@ -69,7 +195,6 @@ private:
     QString m_outputPath;
     int m_width = 1920;
     int m_height = 1080;
-    int m_framerate = 30;
-    double m_frameDurationMs = 33.33;
+    FrameRate m_frameRate;
     double m_totalDuration = 0.0;
 };
@@ -6,6 +6,13 @@
 #include <QSurfaceFormat>
 #include <QQuick3D>
 #include <QQuickWindow>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QRegularExpression>
+#include <QDebug>
+#include <cstring>
 
 #include "version.h"
 #include "core/settings.h"
@@ -22,13 +29,123 @@
 #include "animation/animationcontroller.h"
 #include "overlays/overlaymanager.h"
 #include "export/videoexporter.h"
+#include "export/batchrenderer.h"
 #include "controllers/maincontroller.h"
 #include "3d/globegeometry.h"
 #include "3d/countrygeometry.h"
+#include "3d/arrowgeometry.h"
 #include "3d/globecamera.h"
 
+// Batch mode is decided before QApplication exists so the platform plugin can be chosen
+static bool isBatchInvocation(int argc, char* argv[]) {
+    // "--name" or "--name=value", as QCommandLineParser accepts them
+    auto isOption = [](const char* arg, const char* name) {
+        const size_t length = std::strlen(name);
+        return std::strncmp(arg, name, length) == 0 && (arg[length] == '\0' || arg[length] == '=');
+    };
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--") == 0) break;  // Positional arguments follow
+        if (isOption(argv[i], "--render") || isOption(argv[i], "--queue")) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int runBatch(QApplication& app) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Render .kart projects to video without the UI");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption renderOpt("render", "Project to render (repeatable).", "project.kart");
+    QCommandLineOption outOpt("out", "Output file, or directory for image sequences (repeatable, matched to --render in order).", "path");
+    QCommandLineOption queueOpt("queue", "Text file with one \"project.kart [output]\" job per line.", "file");
+    QCommandLineOption sizeOpt("size", "Output size.", "WxH", "1920x1080");
+    QCommandLineOption fpsOpt("fps", "Frame rate, e.g. 30, 29.97 or 30000/1001.", "fps", "30");
+    QCommandLineOption formatOpt("format", "Write an image sequence instead of video (png, tga, qoi, tiff).", "format");
+    QCommandLineOption offlineOpt("offline", "Use only cached tiles; never download.");
+    QCommandLineOption blurOpt("motion-blur", "Subframes averaged per frame (1 = off).", "samples", "1");
+    QCommandLineOption shutterOpt("shutter", "Motion blur shutter angle in degrees.", "degrees", "180");
+    parser.addOptions({renderOpt, outOpt, queueOpt, sizeOpt, fpsOpt, formatOpt, offlineOpt, blurOpt, shutterOpt});
+    parser.process(app);
+
+    QRegularExpressionMatch sizeMatch = QRegularExpression("^(\\d+)x(\\d+)$").match(parser.value(sizeOpt));
+    FrameRate fps = FrameRate::fromString(parser.value(fpsOpt));
+    if (!sizeMatch.hasMatch() || !fps.isValid()) {
+        qCritical() << "Invalid --size or --fps";
+        return 2;
+    }
+
+    BatchRenderer::Job defaults;
+    defaults.width = sizeMatch.captured(1).toInt();
+    defaults.height = sizeMatch.captured(2).toInt();
+    defaults.framerate = fps;
+    defaults.imageFormat = parser.value(formatOpt);
+
+    // Output defaults to the project path with a .mp4 suffix (or a directory for sequences)
+    auto defaultOutput = [&defaults](const QString& project) {
+        QFileInfo info(project);
+        QString base = info.absolutePath() + "/" + info.completeBaseName();
+        return defaults.imageFormat.isEmpty() ? base + ".mp4" : base + "_frames";
+    };
+
+    QList<BatchRenderer::Job> jobs;
+    const QStringList projects = parser.values(renderOpt);
+    const QStringList outputs = parser.values(outOpt);
+    for (int i = 0; i < projects.size(); ++i) {
+        BatchRenderer::Job job = defaults;
+        job.projectPath = projects[i];
+        job.outputPath = i < outputs.size() ? outputs[i] : defaultOutput(projects[i]);
+        jobs.append(job);
+    }
+
+    if (parser.isSet(queueOpt)) {
+        QFile queueFile(parser.value(queueOpt));
+        if (!queueFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            qCritical() << "Cannot open queue file" << queueFile.fileName();
+            return 2;
+        }
+        QTextStream in(&queueFile);
+        while (!in.atEnd()) {
+            QString line = in.readLine().trimmed();
+            if (line.isEmpty() || line.startsWith('#')) continue;
+
+            QStringList parts = line.split(QRegularExpression("\\s+"));
+            BatchRenderer::Job job = defaults;
+            job.projectPath = parts[0];
+            job.outputPath = parts.size() > 1 ? parts[1] : defaultOutput(parts[0]);
+            jobs.append(job);
+        }
+    }
+
+    if (jobs.isEmpty()) {
+        qCritical() << "Nothing to render";
+        return 2;
+    }
+
+    MainController mainController;
+    BatchRenderer batch(&mainController);
+    batch.setOffline(parser.isSet(offlineOpt));
+    mainController.exporter()->setMotionBlurSamples(parser.value(blurOpt).toInt());
+    mainController.exporter()->setShutterAngle(parser.value(shutterOpt).toDouble());
+    for (const auto& job : jobs) {
+        batch.addJob(job);
+    }
+
+    QObject::connect(&batch, &BatchRenderer::finished, &app, &QCoreApplication::exit);
+    batch.start();
+    return app.exec();
+}
+
 int main(int argc, char *argv[])
 {
+    bool batchMode = isBatchInvocation(argc, argv);
+    if (batchMode && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        // Render boxes have no display
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
     QApplication app(argc, argv);
     app.setOrganizationName("TristansKortAnimator");
     app.setOrganizationDomain("tristans-kort-animator.local");
@@ -36,6 +153,10 @@ int main(int argc, char *argv[])
     app.setApplicationVersion(VERSION_STRING);
     app.setWindowIcon(QIcon(":/icons/app_icon.png"));
 
+    if (batchMode) {
+        return runBatch(app);
+    }
+
     // Use Material style for modern look
     QQuickStyle::setStyle("Material");
 
@@ -65,6 +186,7 @@ int main(int argc, char *argv[])
     qmlRegisterType<MapRenderer>("TristansKortAnimator", 1, 0, "MapRenderer");
     qmlRegisterType<GlobeGeometry>("TristansKortAnimator", 1, 0, "GlobeGeometry");
     qmlRegisterType<CountryGeometry>("TristansKortAnimator", 1, 0, "CountryGeometry");
+    qmlRegisterType<ArrowGeometry>("TristansKortAnimator", 1, 0, "ArrowGeometry");
     qmlRegisterType<GlobeCamera>("TristansKortAnimator", 1, 0, "GlobeCamera");
     qmlRegisterUncreatableType<MapCamera>("TristansKortAnimator", 1, 0, "MapCameraType",
         "MapCamera is created in C++");
@@ -0,0 +1,97 @@
+#include "framebufferfiller.h"
+#include "mapcamera.h"
+#include "rendersnapshot.h"
+#include "../animation/framebuffer.h"
+#include "../animation/regiontrackmodel.h"
+#include "../animation/geooverlaymodel.h"
+#include "../overlays/overlaymanager.h"
+
+FrameBufferFiller::FrameBufferFiller(FrameBuffer* buffer, TileCache* tileCache, QObject* parent)
+    : QObject(parent)
+    , m_buffer(buffer)
+    , m_context(new QObject())
+{
+    // Built here, then moved as one tree onto the worker thread
+    m_camera = new MapCamera(m_context);
+    m_regionTracks = new RegionTrackModel(m_context);
+    m_geoOverlays = new GeoOverlayModel(m_context);
+    m_overlays = new OverlayManager(m_context);
+
+    m_painter.setTileCache(tileCache);
+    m_painter.setCamera(m_camera);
+    m_painter.setRegionTrackModel(m_regionTracks);
+    m_painter.setGeoOverlayModel(m_geoOverlays);
+    m_painter.setOverlayManager(m_overlays);
+
+    m_context->moveToThread(&m_thread);
+    m_thread.setObjectName("FrameBufferFiller");
+    m_thread.start(QThread::LowPriority);
+}
+
+FrameBufferFiller::~FrameBufferFiller() {
+    cancel();
+    m_thread.quit();
+    m_thread.wait();
+    delete m_context;
+}
+
+void FrameBufferFiller::fill(const RenderSnapshot& snapshot) {
+    if (!m_buffer || !m_buffer->isEnabled() || !snapshot.timeline.hasCamera()) return;
+
+    Job job;
+    job.generation = ++m_generation;
+    job.bufferEpoch = m_buffer->epoch();
+    job.width = m_buffer->width();
+    job.height = m_buffer->height();
+    job.totalFrames = m_buffer->totalFrames();
+    job.capacity = m_buffer->capacity();
+    if (job.width <= 0 || job.height <= 0) return;
+
+    QMetaObject::invokeMethod(m_context, [this, snapshot, job]() {
+        renderFrames(snapshot, job);
+    }, Qt::QueuedConnection);
+}
+
+void FrameBufferFiller::cancel() {
+    ++m_generation;
+}
+
+void FrameBufferFiller::renderFrames(const RenderSnapshot& snapshot, const Job& job) {
+    // A newer fill is queued behind this one
+    if (job.generation != m_generation) return;
+
+    m_painter.applySnapshot(snapshot);
+    m_regionTracks->setTracks(snapshot.regionTracks);
+    m_geoOverlays->setOverlays(snapshot.geoOverlays);
+    m_overlays->fromJson(snapshot.overlays);
+
+    int rendered = 0;
+    int skipped = 0;
+    for (int frame = 0; frame < job.totalFrames; ++frame) {
+        if (job.generation != m_generation) return;
+        if (m_buffer->frameCount() >= job.capacity) break;
+
+        double timeMs = m_buffer->frameIndexToTime(frame);
+        if (m_buffer->hasFrame(timeMs)) continue;
+
+        CameraState camera = snapshot.timeline.cameraAt(timeMs);
+        m_camera->setPosition(camera.latitude, camera.longitude, camera.zoom(),
+                              camera.bearing, camera.tilt);
+        m_painter.setCurrentTime(timeMs);
+
+        if (!m_painter.visibleTilesCached()) {
+            skipped++;
+            continue;
+        }
+
+        QImage image = m_painter.renderToImage(job.width, job.height);
+        if (!m_buffer->storeFrame(timeMs, image, job.bufferEpoch)) {
+            // Rejected only when the buffer was cleared under us
+            if (m_buffer->epoch() != job.bufferEpoch) return;
+            continue;
+        }
+        rendered++;
+    }
+
+    emit fillFinished(rendered, skipped);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QObject>
+#include <QThread>
+#include <atomic>
+#include "mappainter.h"
+
+class FrameBuffer;
+class TileCache;
+class MapCamera;
+class RegionTrackModel;
+class GeoOverlayModel;
+class OverlayManager;
+struct RenderSnapshot;
+
+// Renders the frames a FrameBuffer is missing on a worker thread, so looping
+// playback of an unchanged timeline becomes one blit per frame. The worker
+// draws with its own MapPainter, camera and model copies taken from a
+// RenderSnapshot. The features come with the snapshot as an implicitly shared
+// copy nobody writes to, so the only state shared with the GUI thread is the
+// tile cache, which locks internally.
+// Frames whose tiles are not cached yet are skipped rather than stored with
+// placeholders, and picked up by the next fill.
+class FrameBufferFiller : public QObject {
+    Q_OBJECT
+
+public:
+    FrameBufferFiller(FrameBuffer* buffer, TileCache* tileCache, QObject* parent = nullptr);
+    ~FrameBufferFiller();
+
+    // Replaces any fill in progress
+    void fill(const RenderSnapshot& snapshot);
+    void cancel();
+
+signals:
+    void fillFinished(int rendered, int skipped);
+
+private:
+    // Buffer state as of fill(), read on the buffer's thread
+    struct Job {
+        quint64 generation = 0;
+        quint64 bufferEpoch = 0;
+        int width = 0;
+        int height = 0;
+        int totalFrames = 0;
+        int capacity = 0;
+    };
+
+    void renderFrames(const RenderSnapshot& snapshot, const Job& job);
+
+    FrameBuffer* m_buffer = nullptr;
+    QThread m_thread;
+
+    // Used only on m_thread; the QObjects are owned by m_context, which lives there
+    QObject* m_context = nullptr;
+    MapPainter m_painter;
+    MapCamera* m_camera = nullptr;
+    RegionTrackModel* m_regionTracks = nullptr;
+    GeoOverlayModel* m_geoOverlays = nullptr;
+    OverlayManager* m_overlays = nullptr;
+
+    std::atomic<quint64> m_generation{0};
+};
@@ -0,0 +1,104 @@
+#include "geodesic.h"
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+
+namespace Geodesic {
+
+namespace {
+
+constexpr double MAX_MERCATOR_LAT = 85.05112878;
+
+struct Vec3 {
+    double x, y, z;
+};
+
+Vec3 toVector(const QPointF& p) {
+    const double lat = qDegreesToRadians(p.x());
+    const double lon = qDegreesToRadians(p.y());
+    return {std::cos(lat) * std::cos(lon), std::cos(lat) * std::sin(lon), std::sin(lat)};
+}
+
+QPointF fromVector(const Vec3& v) {
+    const double lat = std::atan2(v.z, std::hypot(v.x, v.y));
+    const double lon = std::atan2(v.y, v.x);
+    return QPointF(qRadiansToDegrees(lat), qRadiansToDegrees(lon));
+}
+
+Vec3 slerp(const Vec3& a, const Vec3& b, double f) {
+    const double dot = a.x * b.x + a.y * b.y + a.z * b.z;
+    const Vec3 cross{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    const double angle = std::atan2(std::sqrt(cross.x * cross.x + cross.y * cross.y + cross.z * cross.z), dot);
+    const double s = std::sin(angle);
+
+    // Coincident or antipodal points have no unique great circle; the chord
+    // is as good as any and keeps the result continuous
+    if (s < 1e-9) {
+        Vec3 v{a.x + (b.x - a.x) * f, a.y + (b.y - a.y) * f, a.z + (b.z - a.z) * f};
+        const double len = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+        if (len < 1e-12) return f < 0.5 ? a : b;
+        return {v.x / len, v.y / len, v.z / len};
+    }
+    const double wa = std::sin((1.0 - f) * angle) / s;
+    const double wb = std::sin(f * angle) / s;
+    return {a.x * wa + b.x * wb, a.y * wa + b.y * wb, a.z * wa + b.z * wb};
+}
+
+double mercatorY(double lat) {
+    lat = std::clamp(lat, -MAX_MERCATOR_LAT, MAX_MERCATOR_LAT);
+    return std::log(std::tan(M_PI / 4.0 + qDegreesToRadians(lat) / 2.0));
+}
+
+double mercatorLat(double y) {
+    return qRadiansToDegrees(std::atan(std::sinh(y)));
+}
+
+}
+
+double normalizeLongitude(double lon) {
+    lon = std::fmod(lon + 180.0, 360.0);
+    if (lon < 0.0) lon += 360.0;
+    return lon - 180.0;
+}
+
+double unwrapLongitude(double lon, double reference) {
+    return lon - 360.0 * std::round((lon - reference) / 360.0);
+}
+
+QPointF greatCircleBezier(const QVector<QPointF>& control, double t) {
+    if (control.isEmpty()) return QPointF();
+
+    QVector<Vec3> working;
+    working.reserve(control.size());
+    for (const QPointF& p : control) {
+        working.append(toVector(p));
+    }
+    for (int n = working.size() - 1; n > 0; --n) {
+        for (int i = 0; i < n; ++i) {
+            working[i] = slerp(working[i], working[i + 1], t);
+        }
+    }
+    return fromVector(working.first());
+}
+
+QPointF rhumbBezier(const QVector<QPointF>& control, double t) {
+    if (control.isEmpty()) return QPointF();
+
+    // Longitudes unwrapped along the control polygon, so each leg takes the
+    // short way across the antimeridian
+    QVector<QPointF> working;
+    working.reserve(control.size());
+    double lon = control.first().y();
+    for (const QPointF& p : control) {
+        lon = unwrapLongitude(p.y(), lon);
+        working.append(QPointF(lon, mercatorY(p.x())));
+    }
+    for (int n = working.size() - 1; n > 0; --n) {
+        for (int i = 0; i < n; ++i) {
+            working[i] += (working[i + 1] - working[i]) * t;
+        }
+    }
+    return QPointF(mercatorLat(working.first().y()), normalizeLongitude(working.first().x()));
+}
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QPointF>
+#include <QVector>
+
+// Interpolation on the sphere. Points are QPointF(lat, lon) in degrees like
+// everywhere else; returned longitudes are normalised to [-180, 180], so a
+// caller drawing in Mercator unwraps them against the previous point.
+namespace Geodesic {
+
+// Longitude in [-180, 180]
+double normalizeLongitude(double lon);
+
+// The longitude equivalent to lon that lies within 180 degrees of reference
+double unwrapLongitude(double lon, double reference);
+
+// Bezier curve through the control points with every linear step of de
+// Casteljau's algorithm replaced by a step along the great circle. With two
+// points it is the shortest route between them.
+QPointF greatCircleBezier(const QVector<QPointF>& control, double t);
+
+// The same in Mercator space, taking the shorter way around in longitude.
+// With two points it is the rhumb line (constant compass bearing).
+QPointF rhumbBezier(const QVector<QPointF>& control, double t);
+
+}
@@ -2,6 +2,10 @@
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonArray>
+#include <QtMath>
+#include <cmath>
+#include "polylabel.h"
+#include "polygonclip.h"
 
 GeoJsonParser::GeoJsonParser(QObject* parent)
     : QObject(parent)
@@ -159,11 +163,7 @@ void GeoJsonParser::parseFeature(const QJsonObject& feature) {
         geoFeature.type = "city";
     }
 
-    // Calculate centroid if not already set
-    if (geoFeature.centroid.isNull() && !geoFeature.polygons.isEmpty()) {
-        geoFeature.centroid = calculateCentroid(geoFeature.polygons);
-    }
-
+    finishFeature(geoFeature);
     m_features.append(geoFeature);
 }
 
@@ -181,22 +181,85 @@ QPolygonF GeoJsonParser::parsePolygon(const QJsonArray& coords) {
     return polygon;
 }
 
-QPointF GeoJsonParser::calculateCentroid(const QVector<QPolygonF>& polygons) {
-    if (polygons.isEmpty()) return QPointF();
+// Polygons are measured in Web Mercator degrees (lon, y), the plane the
+// map is drawn in, so areas and anchors match what is on screen
+static QPointF toMercator(const QPointF& latLon) {
+    double lat = qBound(-85.0511, latLon.x(), 85.0511);
+    double y = std::log(std::tan(M_PI / 4.0 + qDegreesToRadians(lat) / 2.0));
+    return QPointF(latLon.y(), qRadiansToDegrees(y));
+}
 
-    double totalLat = 0, totalLon = 0;
-    int count = 0;
+static QPointF fromMercator(const QPointF& p) {
+    double lat = qRadiansToDegrees(2.0 * std::atan(std::exp(qDegreesToRadians(p.y()))) - M_PI / 2.0);
+    return QPointF(lat, p.x());
+}
 
-    for (const auto& poly : polygons) {
-        for (const auto& point : poly) {
-            totalLat += point.x();
-            totalLon += point.y();
-            count++;
+void GeoJsonParser::finishFeature(GeoFeature& feature) const {
+    // Parts crossing the antimeridian or reaching past the Mercator limit
+    // are cut once here, so every ring projects without wrapping around
+    // the map; everything below then measures the parts actually drawn
+    QVector<QPolygonF> parts;
+    parts.reserve(feature.polygons.size());
+    for (const QPolygonF& polygon : feature.polygons) {
+        parts += PolygonClip::splitGeoRing(polygon);
+    }
+    feature.polygons = parts;
+
+    if (feature.polygons.isEmpty()) {
+        // Points: everything collapses onto the coordinate
+        feature.labelAnchor = feature.centroid;
+        feature.bounds = QRectF(feature.centroid, QSizeF(0, 0));
+        feature.mainBounds = feature.bounds;
+        return;
+    }
+
+    QVector<QPolygonF> projected;
+    QVector<double> areas;
+    projected.reserve(feature.polygons.size());
+    areas.reserve(feature.polygons.size());
+    feature.polygonBounds.clear();
+    feature.bounds = QRectF();
+    feature.area = 0.0;
+
+    int largest = 0;
+    for (int i = 0; i < feature.polygons.size(); ++i) {
+        const QPolygonF& polygon = feature.polygons[i];
+        QRectF box = polygon.boundingRect();
+        feature.polygonBounds.append(box);
+        feature.bounds = feature.bounds.isNull() ? box : feature.bounds.united(box);
+
+        QPolygonF ring;
+        ring.reserve(polygon.size());
+        for (const QPointF& p : polygon) ring.append(toMercator(p));
+        projected.append(ring);
+        areas.append(std::abs(PolyLabel::signedArea(ring)));
+        feature.area += areas.last();
+        if (areas.last() > areas[largest]) largest = i;
+    }
+
+    // Centroid of all parts weighted by their area; the vertex mean this
+    // replaces drifted towards whichever coast had the most detail
+    if (feature.centroid.isNull()) {
+        QPointF weighted;
+        for (int i = 0; i < projected.size(); ++i) {
+            weighted += PolyLabel::centroid(projected[i]) * areas[i];
         }
+        feature.centroid = feature.area > 0
+            ? fromMercator(weighted / feature.area)
+            : fromMercator(PolyLabel::centroid(projected[largest]));
     }
 
-    if (count == 0) return QPointF();
-    return QPointF(totalLat / count, totalLon / count);
+    // Labels go inside the largest part, as far from its coast as possible
+    const QRectF largestBox = projected[largest].boundingRect();
+    const double precision = qMax(1e-4, qMax(largestBox.width(), largestBox.height()) * ANCHOR_PRECISION);
+    feature.labelAnchor = fromMercator(PolyLabel::poleOfInaccessibility(projected[largest], precision));
+
+    feature.mainBounds = QRectF();
+    for (int i = 0; i < feature.polygons.size(); ++i) {
+        if (areas[i] < areas[largest] * MAIN_AREA_FRACTION) continue;
+        const QRectF& box = feature.polygonBounds[i];
+        feature.mainBounds = feature.mainBounds.isNull() ? box : feature.mainBounds.united(box);
+    }
 }
 
 QVariantList GeoJsonParser::countryList() const {
@@ -486,6 +549,7 @@ void GeoJsonParser::loadBuiltInCities() {
         feature.code = QString::fromUtf8(city.country);
         feature.properties["population"] = city.population;
         feature.properties["country"] = QString::fromUtf8(city.country);
+        finishFeature(feature);
         m_features.append(feature);
     }
 
@@ -2,6 +2,7 @@
 
 #include <QObject>
 #include <QPolygonF>
+#include <QRectF>
 #include <QVariantMap>
 #include <QVector>
 #include <QJsonObject>
@@ -12,8 +13,16 @@ struct GeoFeature {
     QString name;
     QString code;       // ISO code
     QVector<QPolygonF> polygons;  // MultiPolygon support
-    QPointF centroid;
+    QPointF centroid;   // Area-weighted over all polygons, as the map projects them
     QVariantMap properties;
+
+    // Derived once at load (GeoJsonParser::finishFeature) so rendering and
+    // hit testing don't walk vertices. All in (lat, lon) like the polygons.
+    QPointF labelAnchor;              // Pole of inaccessibility of the largest polygon
+    QRectF bounds;                    // All polygons
+    QRectF mainBounds;                // Polygons of at least MAIN_AREA_FRACTION of the largest
+    QVector<QRectF> polygonBounds;    // Parallel to polygons
+    double area = 0.0;                // Projected area, Mercator degrees squared
 };
 
 class GeoJsonParser : public QObject {
@@ -62,7 +71,13 @@ private:
     void parseFeatureCollection(const QJsonObject& root);
     void parseFeature(const QJsonObject& feature);
     QPolygonF parsePolygon(const QJsonArray& coords);
-    QPointF calculateCentroid(const QVector<QPolygonF>& polygons);
+    void finishFeature(GeoFeature& feature) const;
 
     QVector<GeoFeature> m_features;
+
+    // Islands and exclaves smaller than this share of the largest polygon
+    // don't widen the framing bounds (French Guiana for France, say)
+    static constexpr double MAIN_AREA_FRACTION = 0.1;
+    // Label anchor accuracy, relative to the largest polygon's size
+    static constexpr double ANCHOR_PRECISION = 0.01;
 };
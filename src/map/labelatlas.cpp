@@ -0,0 +1,53 @@
+#include "labelatlas.h"
+
+LabelAtlas::Slot LabelAtlas::allocate(const QSize& pixels) {
+    const QSize padded = pixels.expandedTo(QSize(1, 1)) + QSize(SPACING, SPACING);
+
+    Slot slot;
+    for (int i = 0; i < m_pages.size(); ++i) {
+        if (allocateIn(m_pages[i], padded, slot.rect)) {
+            slot.page = i;
+            slot.rect.setSize(pixels);
+            return slot;
+        }
+    }
+
+    // Oversized sprites get a page of their own size
+    Page& page = addPage(padded);
+    allocateIn(page, padded, slot.rect);
+    slot.page = m_pages.size() - 1;
+    slot.rect.setSize(pixels);
+    return slot;
+}
+
+bool LabelAtlas::allocateIn(Page& page, const QSize& size, QRect& rect) {
+    const int pageWidth = page.image.width();
+    const int pageHeight = page.image.height();
+
+    // Best fitting shelf that is not much taller than the sprite
+    Shelf* best = nullptr;
+    for (Shelf& shelf : page.shelves) {
+        if (shelf.height < size.height() || shelf.height > size.height() * 3 / 2 + 2) continue;
+        if (shelf.x + size.width() > pageWidth) continue;
+        if (!best || shelf.height < best->height) best = &shelf;
+    }
+
+    if (!best) {
+        if (page.used + size.height() > pageHeight || size.width() > pageWidth) return false;
+        page.shelves.append({page.used, size.height(), 0});
+        page.used += size.height();
+        best = &page.shelves.last();
+    }
+
+    rect = QRect(best->x, best->y, size.width(), size.height());
+    best->x += size.width();
+    return true;
+}
+
+LabelAtlas::Page& LabelAtlas::addPage(const QSize& minimum) {
+    Page page;
+    page.image = QImage(minimum.expandedTo(QSize(PAGE_SIZE, PAGE_SIZE)), QImage::Format_ARGB32_Premultiplied);
+    page.image.fill(Qt::transparent);
+    m_pages.append(page);
+    return m_pages.last();
+}
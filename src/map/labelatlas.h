@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QImage>
+#include <QRect>
+#include <QVector>
+
+// Shelf-packed texture pages for pre-rendered label sprites. Every label of
+// a frame is a sub-rectangle of a few large images, so drawing is a run of
+// blits from the same source instead of one image per label, and painters
+// that upload textures upload a page once. Pages are kept at 1x; callers
+// rasterise at the device pixel ratio and draw with logical target rects.
+class LabelAtlas {
+public:
+    struct Slot {
+        int page = -1;
+        QRect rect;  // Pixels within the page
+        bool isValid() const { return page >= 0; }
+    };
+
+    // Reserves a transparent area of the given pixel size. Never fails: a
+    // new page is started when the current ones are full, so a frame's
+    // slots stay valid until the caller clears the atlas between frames.
+    Slot allocate(const QSize& pixels);
+
+    QImage& page(int index) { return m_pages[index].image; }
+    const QImage& page(int index) const { return m_pages[index].image; }
+    int pageCount() const { return m_pages.size(); }
+
+    bool overBudget() const { return m_pages.size() > MAX_PAGES; }
+    void clear() { m_pages.clear(); }
+
+    static constexpr int PAGE_SIZE = 1024;
+    static constexpr int MAX_PAGES = 4;
+    static constexpr int SPACING = 1;  // Transparent gap so filtering never bleeds between slots
+
+private:
+    struct Shelf {
+        int y;
+        int height;
+        int x;  // Next free column
+    };
+
+    struct Page {
+        QImage image;
+        QVector<Shelf> shelves;
+        int used = 0;  // Rows taken by shelves
+    };
+
+    bool allocateIn(Page& page, const QSize& size, QRect& rect);
+    Page& addPage(const QSize& minimum);
+
+    QVector<Page> m_pages;
+};
@@ -0,0 +1,251 @@
+#include "labelengine.h"
+#include <QFont>
+#include <QPainter>
+#include <QPainterPath>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+
+LabelEngine::LabelEngine() = default;
+
+void LabelEngine::setDevicePixelRatio(qreal dpr) {
+    if (qFuzzyCompare(m_dpr, dpr)) return;
+    m_dpr = dpr;
+    m_sprites.clear();
+    m_atlas.clear();
+}
+
+int LabelEngine::styleSlot(const Style& style) {
+    // Every field renderSprite() bakes into the sprite
+    QString key = QString("%1|%2|%3|%4|%5|%6|%7|%8,%9|%10|%11")
+        .arg(style.family).arg(style.pixelSize).arg(style.weight)
+        .arg(style.color.rgba()).arg(style.outline.rgba()).arg(style.outlineWidth)
+        .arg(style.shadow.rgba()).arg(style.shadowOffset.x()).arg(style.shadowOffset.y())
+        .arg(style.background.rgba()).arg(style.backgroundPadding);
+    auto it = m_styleSlots.constFind(key);
+    if (it != m_styleSlots.constEnd()) return it.value();
+    int slot = m_styleSlots.size();
+    m_styleSlots.insert(key, slot);
+    return slot;
+}
+
+LabelEngine::Sprite LabelEngine::renderSprite(const QString& text, const Style& style) {
+    QFont font(style.family);
+    font.setPixelSize(style.pixelSize);
+    font.setWeight(static_cast<QFont::Weight>(style.weight));
+
+    // The outline is one stroke of the glyph paths instead of drawing the
+    // text once per outline offset
+    QPainterPath path;
+    path.addText(0, 0, font, text);
+    const double margin = style.outlineWidth + 1.0;
+    QRectF textBounds = path.boundingRect();
+    QRectF bounds = textBounds.adjusted(-margin, -margin, margin, margin);
+
+    const bool hasBackground = style.background.alpha() > 0;
+    const bool hasShadow = style.shadow.alpha() > 0;
+    QRectF box = textBounds.adjusted(-style.backgroundPadding, -style.backgroundPadding,
+                                     style.backgroundPadding, style.backgroundPadding);
+    if (hasBackground) bounds |= box;
+    if (hasShadow) bounds |= bounds.translated(style.shadowOffset);
+
+    Sprite sprite;
+    sprite.size = bounds.size();
+    sprite.slot = m_atlas.allocate(QSize(qCeil(bounds.width() * m_dpr), qCeil(bounds.height() * m_dpr)));
+
+    QPainter painter(&m_atlas.page(sprite.slot.page));
+    painter.setClipRect(sprite.slot.rect);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.translate(sprite.slot.rect.topLeft());
+    painter.scale(m_dpr, m_dpr);
+    painter.translate(-bounds.topLeft());
+
+    QPen outlinePen(style.outline, style.outlineWidth * 2.0, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
+    if (hasShadow) {
+        painter.save();
+        painter.translate(style.shadowOffset);
+        if (hasBackground) {
+            painter.setPen(Qt::NoPen);
+            painter.setBrush(style.shadow);
+            painter.drawRoundedRect(box, 3, 3);
+        } else {
+            if (style.outlineWidth > 0) {
+                painter.strokePath(path, QPen(style.shadow, outlinePen.widthF(), Qt::SolidLine,
+                                              Qt::RoundCap, Qt::RoundJoin));
+            }
+            painter.fillPath(path, style.shadow);
+        }
+        painter.restore();
+    }
+    if (hasBackground) {
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(style.background);
+        painter.drawRoundedRect(box, 3, 3);
+    }
+    if (style.outlineWidth > 0) {
+        painter.strokePath(path, outlinePen);
+    }
+    painter.fillPath(path, style.color);
+    return sprite;
+}
+
+const LabelEngine::Sprite* LabelEngine::sprite(const QString& text, int slot, const Style& style) {
+    SpriteKey key{slot, text};
+    auto it = m_sprites.constFind(key);
+    if (it == m_sprites.constEnd()) {
+        it = m_sprites.insert(key, renderSprite(text, style));
+    }
+    return &it.value();
+}
+
+QSizeF LabelEngine::labelSize(const QString& text, const Style& style) {
+    return sprite(text, styleSlot(style), style)->size;
+}
+
+bool LabelEngine::canReuse(const View& view) const {
+    if (!m_hasLayout || !view.allowReuse) return false;
+    return view.size == m_lastView.size
+        && view.contentKey == m_lastView.contentKey
+        && view.bearing == m_lastView.bearing
+        && view.tilt == m_lastView.tilt
+        && std::abs(view.zoom - m_lastView.zoom) < REUSE_ZOOM_DELTA
+        && std::hypot(view.pan.x(), view.pan.y()) < REUSE_PAN_PX;
+}
+
+bool LabelEngine::layout(const QVector<Candidate>& candidates, const QVector<Style>& styles,
+                         const View& view) {
+    // Atlas slots must stay valid for the whole frame, so a full atlas is
+    // only emptied here; labels still in view are rendered again on demand
+    if (m_atlas.overBudget()) {
+        m_atlas.clear();
+        m_sprites.clear();
+    }
+
+    QVector<int> slots;
+    slots.reserve(styles.size());
+    for (const Style& style : styles) {
+        slots.append(styleSlot(style));
+    }
+
+    if (canReuse(view)) {
+        keep(candidates, slots, styles);
+        return false;
+    }
+
+    place(candidates, slots, styles);
+    m_lastView = view;
+    m_hasLayout = true;
+    return true;
+}
+
+void LabelEngine::place(const QVector<Candidate>& candidates, const QVector<int>& slots,
+                        const QVector<Style>& styles) {
+    m_placed.clear();
+    m_placedIds.clear();
+
+    QVector<int> order(candidates.size());
+    for (int i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&candidates](int a, int b) {
+        return candidates[a].priority > candidates[b].priority;
+    });
+
+    // Coarse grid over the candidates' extent; each cell lists the placed
+    // rectangles overlapping it. Labels hanging past the edge cells clamp
+    // into them, which only costs extra comparisons.
+    QRectF extent;
+    for (const Candidate& c : candidates) {
+        extent |= QRectF(c.anchor + c.offset, QSizeF(1, 1));
+    }
+    const QPointF origin = extent.topLeft();
+    const int cols = qBound(1, static_cast<int>(extent.width() / GRID_CELL) + 1, MAX_GRID_CELLS);
+    const int rows = qBound(1, static_cast<int>(extent.height() / GRID_CELL) + 1, MAX_GRID_CELLS);
+    QVector<QVector<QRectF>> grid(cols * rows);
+
+    auto cell = [](double v, double o, int count) {
+        return qBound(0, static_cast<int>(std::floor((v - o) / GRID_CELL)), count - 1);
+    };
+    auto cellRange = [&](const QRectF& r, int& x0, int& y0, int& x1, int& y1) {
+        x0 = cell(r.left(), origin.x(), cols);
+        y0 = cell(r.top(), origin.y(), rows);
+        x1 = cell(r.right(), origin.x(), cols);
+        y1 = cell(r.bottom(), origin.y(), rows);
+    };
+
+    for (int index : order) {
+        const Candidate& c = candidates[index];
+        if (c.style < 0 || c.style >= styles.size()) continue;
+        const Sprite* s = sprite(c.text, slots[c.style], styles[c.style]);
+        QRectF rect(QPointF(0, 0), s->size);
+        rect.moveCenter(c.anchor + c.offset);
+        QRectF padded = rect.adjusted(-LABEL_PADDING, -LABEL_PADDING, LABEL_PADDING, LABEL_PADDING);
+
+        int x0, y0, x1, y1;
+        cellRange(padded, x0, y0, x1, y1);
+        bool blocked = false;
+        for (int y = y0; y <= y1 && !blocked; ++y) {
+            for (int x = x0; x <= x1 && !blocked; ++x) {
+                for (const QRectF& other : grid[y * cols + x]) {
+                    if (other.intersects(padded)) {
+                        blocked = true;
+                        break;
+                    }
+                }
+            }
+        }
+        if (blocked && !c.alwaysPlace) continue;
+
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                grid[y * cols + x].append(padded);
+            }
+        }
+        m_placed.append({s->slot, rect, c.opacity, index, c.alwaysPlace});
+        m_placedIds.insert(c.id);
+    }
+    sortByPage();
+}
+
+void LabelEngine::keep(const QVector<Candidate>& candidates, const QVector<int>& slots,
+                       const QVector<Style>& styles) {
+    // Same labels as the last placement, at this frame's positions; a pan
+    // this small leaves their relative layout untouched
+    m_placed.clear();
+    for (int index = 0; index < candidates.size(); ++index) {
+        const Candidate& c = candidates[index];
+        if (!m_placedIds.contains(c.id)) continue;
+        if (c.style < 0 || c.style >= styles.size()) continue;
+        const Sprite* s = sprite(c.text, slots[c.style], styles[c.style]);
+
+        QRectF rect(QPointF(0, 0), s->size);
+        rect.moveCenter(c.anchor + c.offset);
+        m_placed.append({s->slot, rect, c.opacity, index, c.alwaysPlace});
+    }
+    sortByPage();
+}
+
+void LabelEngine::sortByPage() {
+    // Collision-checked labels never overlap, so their order only matters
+    // for batching. Labels placed regardless may overlap anything: they go
+    // on top, in candidate order, so later ones cover earlier ones.
+    std::stable_sort(m_placed.begin(), m_placed.end(), [](const Placed& a, const Placed& b) {
+        if (a.alwaysPlace != b.alwaysPlace) return b.alwaysPlace;
+        if (a.alwaysPlace) return a.index < b.index;
+        return a.slot.page < b.slot.page;
+    });
+}
+
+void LabelEngine::draw(QPainter* painter) const {
+    // One pass over the atlas pages. QPainter::drawPixmapFragments() would
+    // batch further but needs a QPixmap, which the background frame
+    // renderer can't use off the GUI thread.
+    const double baseOpacity = painter->opacity();
+    double opacity = -1.0;
+    for (const Placed& label : m_placed) {
+        if (label.opacity != opacity) {
+            opacity = label.opacity;
+            painter->setOpacity(baseOpacity * opacity);
+        }
+        painter->drawImage(label.rect, m_atlas.page(label.slot.page), QRectF(label.slot.rect));
+    }
+    painter->setOpacity(baseOpacity);
+}
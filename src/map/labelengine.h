@@ -0,0 +1,121 @@
+#pragma once
+
+#include <QColor>
+#include <QHash>
+#include <QImage>
+#include <QPointF>
+#include <QRectF>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include "labelatlas.h"
+
+class QPainter;
+
+// Places and draws map labels. Each (text, style) is rendered once, with its
+// outline, shadow and background, into a slot of a LabelAtlas, so a frame
+// draws one blit per label instead of laying text out several times for the
+// outline, and all blits come from a few atlas pages. Candidates are placed greedily by
+// priority against a screen-space grid and the chosen set is kept while the
+// view only pans a little, so labels neither flicker nor re-solve every frame.
+class LabelEngine {
+public:
+    struct Style {
+        QString family = "Arial";
+        int pixelSize = 13;
+        int weight = 400;           // QFont::Weight
+        QColor color = Qt::white;
+        QColor outline = QColor(0, 0, 0, 180);
+        double outlineWidth = 1.5;  // Pixels around each glyph, 0 = none
+        QColor shadow = Qt::transparent;
+        QPointF shadowOffset = QPointF(1, 1);
+        QColor background = Qt::transparent;  // Rounded box behind the text
+        double backgroundPadding = 4.0;
+    };
+
+    struct Candidate {
+        quint64 id = 0;          // Stable across frames
+        QString text;
+        int style = 0;           // Index into the styles passed to layout()
+        QPointF anchor;          // Screen position of the labelled point
+        QPointF offset;          // Label centre relative to the anchor
+        double priority = 0.0;   // Higher wins collisions
+        double opacity = 1.0;
+        bool alwaysPlace = false; // Drawn even when it collides (user-placed text)
+    };
+
+    // What the previous placement depends on. A layout is reused when
+    // nothing but a pan below REUSE_PAN_PX happened since.
+    struct View {
+        QSizeF size;
+        double zoom = 0.0;
+        double bearing = 0.0;
+        double tilt = 0.0;
+        quint64 contentKey = 0;  // Toggles, selection: anything that changes the candidates
+        QPointF pan;             // Screen shift since the last full placement
+        bool allowReuse = true;
+    };
+
+    LabelEngine();
+
+    void setDevicePixelRatio(qreal dpr);
+
+    // Returns true when the candidates were placed from scratch; the caller
+    // then measures later pans from the current view
+    bool layout(const QVector<Candidate>& candidates, const QVector<Style>& styles, const View& view);
+    void draw(QPainter* painter) const;
+
+    // Screen rectangle a label of this text and style occupies
+    QSizeF labelSize(const QString& text, const Style& style);
+
+private:
+    struct Sprite {
+        LabelAtlas::Slot slot;
+        QSizeF size;  // Logical pixels
+    };
+
+    struct SpriteKey {
+        int style;
+        QString text;
+        bool operator==(const SpriteKey& other) const {
+            return style == other.style && text == other.text;
+        }
+    };
+    friend size_t qHash(const SpriteKey& key, size_t seed) {
+        return qHashMulti(seed, key.style, key.text);
+    }
+
+    struct Placed {
+        LabelAtlas::Slot slot;
+        QRectF rect;
+        double opacity;
+        int index;          // Candidate position, the draw order of overlapping labels
+        bool alwaysPlace;
+    };
+
+    int styleSlot(const Style& style);
+    const Sprite* sprite(const QString& text, int slot, const Style& style);
+    Sprite renderSprite(const QString& text, const Style& style);
+    bool canReuse(const View& view) const;
+    void place(const QVector<Candidate>& candidates, const QVector<int>& slots,
+               const QVector<Style>& styles);
+    void keep(const QVector<Candidate>& candidates, const QVector<int>& slots,
+              const QVector<Style>& styles);
+    void sortByPage();
+
+    LabelAtlas m_atlas;
+    QHash<SpriteKey, Sprite> m_sprites;
+    QHash<QString, int> m_styleSlots;
+    qreal m_dpr = 1.0;
+
+    QVector<Placed> m_placed;
+    QSet<quint64> m_placedIds;
+    View m_lastView;
+    bool m_hasLayout = false;
+
+    static constexpr int GRID_CELL = 48;
+    static constexpr int MAX_GRID_CELLS = 256;   // Per axis
+    static constexpr double LABEL_PADDING = 2.0;
+    static constexpr double REUSE_PAN_PX = 48.0;
+    static constexpr double REUSE_ZOOM_DELTA = 0.02;
+};
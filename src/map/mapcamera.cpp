@@ -102,27 +102,31 @@ void MapCamera::setPosition(double lat, double lon, double zoom, double bearing,
     }
 }
 
-QPointF MapCamera::geoToScreen(double lat, double lon, double viewWidth, double viewHeight) const {
-    // Web Mercator projection
-    double scale = std::pow(2.0, m_zoom) * TILE_SIZE;
-
-    // Convert geo coordinates to pixel coordinates
-    double x = (lon + 180.0) / 360.0 * scale;
+QPointF MapCamera::geoToWorld(double lat, double lon) {
+    double x = (lon + 180.0) / 360.0;
     double latRad = lat * M_PI / 180.0;
-    double y = (1.0 - std::log(std::tan(latRad) + 1.0 / std::cos(latRad)) / M_PI) / 2.0 * scale;
+    double y = (1.0 - std::log(std::tan(latRad) + 1.0 / std::cos(latRad)) / M_PI) / 2.0;
+    return QPointF(x, y);
+}
 
-    // Convert center to pixel coordinates
-    double centerX = (m_longitude + 180.0) / 360.0 * scale;
-    double centerLatRad = m_latitude * M_PI / 180.0;
-    double centerY = (1.0 - std::log(std::tan(centerLatRad) + 1.0 / std::cos(centerLatRad)) / M_PI) / 2.0 * scale;
+double MapCamera::worldScale() const {
+    return std::pow(2.0, m_zoom) * TILE_SIZE;
+}
 
+QPointF MapCamera::worldToScreen(const QPointF& world, double viewWidth, double viewHeight) const {
     // Relative to center
-    double screenX = (x - centerX) + viewWidth / 2.0;
-    double screenY = (y - centerY) + viewHeight / 2.0;
-
+    double scale = worldScale();
+    QPointF center = geoToWorld(m_latitude, m_longitude);
+    double screenX = (world.x() - center.x()) * scale + viewWidth / 2.0;
+    double screenY = (world.y() - center.y()) * scale + viewHeight / 2.0;
     return QPointF(screenX, screenY);
 }
 
+QPointF MapCamera::geoToScreen(double lat, double lon, double viewWidth, double viewHeight) const {
+    // Web Mercator projection
+    return worldToScreen(geoToWorld(lat, lon), viewWidth, viewHeight);
+}
+
 QPointF MapCamera::screenToGeo(double x, double y, double viewWidth, double viewHeight) const {
     double scale = std::pow(2.0, m_zoom) * TILE_SIZE;
 
@@ -37,6 +37,15 @@ public:
     Q_INVOKABLE QPointF geoToScreen(double lat, double lon, double viewWidth, double viewHeight) const;
     Q_INVOKABLE QPointF screenToGeo(double x, double y, double viewWidth, double viewHeight) const;
 
+    // Web Mercator world coordinates, 0..1 across the map. Geometry cached
+    // in world space is projected with worldToScreen(), a scale and offset,
+    // and its lengths are screen lengths divided by worldScale().
+    static QPointF geoToWorld(double lat, double lon);
+    QPointF worldToScreen(const QPointF& world, double viewWidth, double viewHeight) const;
+    double worldScale() const;  // Screen pixels per world unit
+
+    static constexpr double TILE_SIZE = 256.0;  // worldScale() at zoom 0
+
     // Tile math
     Q_INVOKABLE int tileX() const;
     Q_INVOKABLE int tileY() const;
@@ -73,6 +82,4 @@ private:
     double m_prevZoom = 5.0;
     double m_movementSpeed = 0.0;
     QElapsedTimer m_speedTimer;
-
-    static constexpr double TILE_SIZE = 256.0;
 };
@@ -0,0 +1,1004 @@
+#include "mappainter.h"
+#include "tileprovider.h"
+#include "tilecache.h"
+#include "mapcamera.h"
+#include "rendersnapshot.h"
+#include "polygonclip.h"
+#include "../overlays/overlaymanager.h"
+#include "../overlays/overlay.h"
+#include "../overlays/arrowoverlay.h"
+#include "../overlays/regionhighlight.h"
+#include "../animation/regiontrackmodel.h"
+#include "../animation/geooverlaymodel.h"
+#include "../animation/geooverlay.h"
+#include <QPainter>
+#include <QtMath>
+#include <QTransform>
+#include <cmath>
+#include <QMetaObject>
+#include <QSet>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QJsonDocument>
+#include <QDebug>
+
+namespace {
+
+// Cheap fingerprint of overlay geometry for frame signatures
+size_t polygonsHash(const QVector<QPolygonF>& polygons) {
+    size_t hash = polygons.size();
+    for (const QPolygonF& polygon : polygons) {
+        hash = qHashBits(polygon.constData(), polygon.size() * sizeof(QPointF), hash);
+    }
+    return hash;
+}
+
+}
+
+void MapPainter::applySnapshot(const RenderSnapshot& snapshot) {
+    m_viewSize = QSizeF(snapshot.width, snapshot.height);
+    m_totalDuration = snapshot.totalDuration;
+    m_features = snapshot.features;
+
+    m_settings.tileSource = snapshot.tileSource;
+    m_settings.showCountryLabels = snapshot.showCountryLabels;
+    m_settings.showRegionLabels = snapshot.showRegionLabels;
+    m_settings.showCityLabels = snapshot.showCityLabels;
+    m_settings.showCountryBorders = snapshot.showCountryBorders;
+    m_settings.showCityMarkers = snapshot.showCityMarkers;
+    m_settings.shadeNonHighlighted = snapshot.shadeNonHighlighted;
+    m_settings.nonHighlightedOpacity = snapshot.nonHighlightedOpacity;
+    m_settings.labelOpacity = snapshot.labelOpacity;
+
+    m_settings.highlights.clear();
+    for (auto it = snapshot.highlights.constBegin(); it != snapshot.highlights.constEnd(); ++it) {
+        m_settings.highlights.insert(it.key(), {it.value().first, it.value().second});
+    }
+    m_settings.selectedFeatureCode = snapshot.selectedFeatureCode;
+    m_settings.selectedFeatureName = snapshot.selectedFeatureName;
+    m_settings.selectedFeatureType = snapshot.selectedFeatureType;
+}
+
+void MapPainter::render(QPainter* painter, int layers) {
+    renderLayers(painter, layers, m_viewCaches, true);
+}
+
+void MapPainter::renderLayers(QPainter* painter, int layers, Caches& caches, bool reuseLabels) {
+    // Apply camera transforms (bearing and tilt)
+    painter->save();
+    applyTransforms(painter);
+
+    // Render layers in order
+    if (layers & BaseLayer) {
+        renderTiles(painter);
+        renderCountryBorders(painter);
+        renderHighlights(painter);
+    }
+    if (layers & TimelineLayer) {
+        renderRegionTracks(painter, m_currentTime, m_totalDuration);
+        renderGeoOverlays(painter, m_currentTime, m_totalDuration);
+    }
+    if (layers & TopLayer) {
+        renderCityMarkers(painter);
+        renderOverlays(painter, m_currentTime, caches.overlays);
+        renderLabels(painter, caches, reuseLabels);
+    }
+
+    painter->restore();
+}
+
+void MapPainter::applyTransforms(QPainter* painter) {
+    if (!m_camera) return;
+
+    // Apply tilt (fake 3D perspective)
+    if (m_camera->tilt() > 0) {
+        QTransform tiltTransform;
+        // Move origin to bottom center for perspective effect
+        tiltTransform.translate(m_viewSize.width() / 2, m_viewSize.height());
+        // Scale vertically to simulate perspective (objects at top appear smaller)
+        double tiltFactor = 1.0 - (m_camera->tilt() / 90.0) * 0.5;
+        tiltTransform.scale(1.0, tiltFactor);
+        tiltTransform.translate(-m_viewSize.width() / 2, -m_viewSize.height());
+        painter->setTransform(tiltTransform, true);
+    }
+
+    // Apply bearing (rotation)
+    if (m_camera->bearing() != 0) {
+        painter->translate(m_viewSize.width() / 2, m_viewSize.height() / 2);
+        painter->rotate(-m_camera->bearing());
+        painter->translate(-m_viewSize.width() / 2, -m_viewSize.height() / 2);
+    }
+}
+
+void MapPainter::renderTiles(QPainter* painter) {
+    if (!m_camera) return;
+
+    // Enable smooth scaling for better quality during zoom transitions
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+
+    double zoom = m_camera->zoom();
+    int preferredZoom = preferredTileZoom();
+    double scale = std::pow(2.0, zoom - preferredZoom);
+
+    // Get visible tile range (use preferred zoom for tile coordinates)
+    auto range = m_camera->visibleTileRangeAtZoom(m_viewSize.width(), m_viewSize.height(), preferredZoom);
+
+    // Calculate center tile position at preferred zoom level
+    double centerLon = m_camera->longitude();
+    double centerLat = m_camera->latitude();
+    double n = std::pow(2.0, preferredZoom);
+
+    double centerTileX = (centerLon + 180.0) / 360.0 * n;
+    double latRad = centerLat * M_PI / 180.0;
+    double centerTileY = (1.0 - std::log(std::tan(latRad) + 1.0 / std::cos(latRad)) / M_PI) / 2.0 * n;
+
+    // Calculate offset for sub-tile positioning
+    double offsetX = (centerTileX - std::floor(centerTileX)) * TILE_SIZE * scale;
+    double offsetY = (centerTileY - std::floor(centerTileY)) * TILE_SIZE * scale;
+
+    int centerTileXInt = static_cast<int>(std::floor(centerTileX));
+    int centerTileYInt = static_cast<int>(std::floor(centerTileY));
+
+    // Get tile source
+    int source = tileSource();
+
+    // Render tiles
+    // Add small overlap to prevent seams between tiles (floating-point precision issue)
+    constexpr double TILE_OVERLAP = 0.5;
+
+    for (int ty = range.minY; ty <= range.maxY; ty++) {
+        for (int tx = range.minX; tx <= range.maxX; tx++) {
+            // Calculate screen position for this tile
+            double screenX = m_viewSize.width() / 2.0 + (tx - centerTileXInt) * TILE_SIZE * scale - offsetX;
+            double screenY = m_viewSize.height() / 2.0 + (ty - centerTileYInt) * TILE_SIZE * scale - offsetY;
+            double tileSize = TILE_SIZE * scale;
+
+            QImage tile;
+            if (m_tileCache) {
+                // Try memory cache, then disk cache
+                tile = m_tileCache->get(source, tx, ty, preferredZoom);
+            }
+
+            if (!tile.isNull()) {
+                // Slightly expand the destination rect to eliminate seams
+                QRectF destRect(screenX - TILE_OVERLAP, screenY - TILE_OVERLAP,
+                               tileSize + TILE_OVERLAP * 2, tileSize + TILE_OVERLAP * 2);
+                painter->drawImage(destRect, tile);
+            } else {
+                // Try to render a fallback tile from a lower zoom level
+                bool hasFallback = tryRenderFallbackTile(painter, tx, ty, preferredZoom,
+                                                          screenX, screenY, tileSize, source);
+
+                // Request the correct tile in background
+                if (m_tileProvider) {
+                    QMetaObject::invokeMethod(m_tileProvider, "requestTile",
+                                              Qt::QueuedConnection,
+                                              Q_ARG(int, tx), Q_ARG(int, ty), Q_ARG(int, preferredZoom));
+                }
+
+                // Only show placeholder if no fallback was found
+                if (!hasFallback) {
+                    painter->fillRect(QRectF(screenX - TILE_OVERLAP, screenY - TILE_OVERLAP,
+                                            tileSize + TILE_OVERLAP * 2, tileSize + TILE_OVERLAP * 2),
+                                     QColor(30, 30, 50));
+                }
+            }
+        }
+    }
+}
+
+int MapPainter::tileSource() const {
+    return m_tileProvider ? m_tileProvider->currentSource() : m_settings.tileSource;
+}
+
+int MapPainter::preferredTileZoom() const {
+    double zoom = m_camera->zoom();
+    int zoomLevel = m_camera->zoomLevel();
+    double scale = std::pow(2.0, zoom - zoomLevel);
+
+    // When scale > 1.5, try to use higher zoom level tiles (scale down instead of up)
+    // Scaling down produces better quality than scaling up
+    if (scale > 1.5 && zoomLevel < 19) {
+        return zoomLevel + 1;
+    }
+    return zoomLevel;
+}
+
+bool MapPainter::tryRenderFallbackTile(QPainter* painter, int tx, int ty, int targetZoom,
+                                         double screenX, double screenY, double tileSize, int source) {
+    if (!m_tileCache) return false;
+
+    // Try parent zoom levels (lower zoom = larger area per tile)
+    // Each zoom level down covers 4x the area (2x in each dimension)
+    for (int fallbackZoom = targetZoom - 1; fallbackZoom >= qMax(0, targetZoom - FALLBACK_LEVELS); fallbackZoom--) {
+        // Calculate which tile at fallbackZoom contains our target tile
+        int zoomDiff = targetZoom - fallbackZoom;
+        int divisor = 1 << zoomDiff;  // 2^zoomDiff
+
+        int parentTx = tx / divisor;
+        int parentTy = ty / divisor;
+
+        {
+            QImage parentTile = m_tileCache->get(source, parentTx, parentTy, fallbackZoom);
+            if (parentTile.isNull()) continue;
+
+            // Calculate which portion of the parent tile to use
+            // Each parent tile is divided into divisor x divisor sub-tiles
+            int subTileX = tx % divisor;  // Which column within the parent
+            int subTileY = ty % divisor;  // Which row within the parent
+
+            int subTileSize = TILE_SIZE / divisor;
+            int srcX = subTileX * subTileSize;
+            int srcY = subTileY * subTileSize;
+
+            // Extract the relevant portion and scale it up
+            // Add small overlap to prevent seams (same as regular tiles)
+            constexpr double TILE_OVERLAP = 0.5;
+            QRectF srcRect(srcX, srcY, subTileSize, subTileSize);
+            QRectF destRect(screenX - TILE_OVERLAP, screenY - TILE_OVERLAP,
+                           tileSize + TILE_OVERLAP * 2, tileSize + TILE_OVERLAP * 2);
+
+            // Use smooth scaling for better quality
+            painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+            painter->drawImage(destRect, parentTile, srcRect);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int MapPainter::drawnTileZoom(int source, int tx, int ty, int targetZoom) const {
+    if (!m_tileCache) return -1;
+
+    // Same search as renderTiles() and tryRenderFallbackTile()
+    for (int zoom = targetZoom; zoom >= qMax(0, targetZoom - FALLBACK_LEVELS); zoom--) {
+        int divisor = 1 << (targetZoom - zoom);
+        if (m_tileCache->isCached(source, tx / divisor, ty / divisor, zoom)) {
+            return zoom;
+        }
+    }
+    return -1;
+}
+
+void MapPainter::renderHighlights(QPainter* painter) {
+    if (!m_camera || m_features.isEmpty()) return;
+
+    double viewW = m_viewSize.width();
+    double viewH = m_viewSize.height();
+    if (viewW <= 0 || viewH <= 0) return;
+    const QRectF clipRect = polygonClipRect();
+
+    // Collect highlighted region codes (from both internal highlights and overlay system)
+    QSet<QString> highlightedCodes;
+
+    // Add internal highlights
+    for (auto it = m_settings.highlights.constBegin(); it != m_settings.highlights.constEnd(); ++it) {
+        highlightedCodes.insert(it.key());
+    }
+
+    // Add region highlights from overlay manager
+    QVector<RegionHighlight*> regionOverlays;
+    if (m_overlays) {
+        auto visibleOverlays = m_overlays->visibleOverlaysAtTime(0); // TODO: Get actual animation time
+        for (auto* overlay : visibleOverlays) {
+            if (auto* regionHighlight = qobject_cast<RegionHighlight*>(overlay)) {
+                regionOverlays.append(regionHighlight);
+                highlightedCodes.insert(regionHighlight->regionCode());
+            }
+        }
+    }
+
+    // If shading non-highlighted is enabled, draw all countries with dim shade first
+    if (m_settings.shadeNonHighlighted && !highlightedCodes.isEmpty()) {
+        QColor shadeColor(0, 0, 0, static_cast<int>((1.0 - m_settings.nonHighlightedOpacity) * 150));
+
+        for (const auto& feature : m_features) {
+            if (feature.type == "country" && !highlightedCodes.contains(feature.code)) {
+                for (const QPolygonF& geoPoly : feature.polygons) {
+                    QPolygonF screenPoly = toScreenPolygon(geoPoly, clipRect);
+
+                    if (!screenPoly.isEmpty()) {
+                        painter->setPen(Qt::NoPen);
+                        painter->setBrush(shadeColor);
+                        painter->drawPolygon(screenPoly);
+                    }
+                }
+            }
+        }
+    }
+
+    // Draw internal highlights
+    for (auto it = m_settings.highlights.constBegin(); it != m_settings.highlights.constEnd(); ++it) {
+        const QString& regionCode = it.key();
+        const HighlightStyle& highlight = it.value();
+
+        const GeoFeature* feature = findByCode(regionCode);
+        if (!feature) continue;
+
+        for (const QPolygonF& geoPoly : feature->polygons) {
+            QPolygonF screenPoly = toScreenPolygon(geoPoly, clipRect);
+
+            if (!screenPoly.isEmpty()) {
+                // Draw fill
+                if (highlight.fillColor.alpha() > 0) {
+                    painter->setPen(Qt::NoPen);
+                    painter->setBrush(highlight.fillColor);
+                    painter->drawPolygon(screenPoly);
+                }
+
+                // Draw border
+                if (highlight.borderColor.alpha() > 0) {
+                    painter->setPen(QPen(highlight.borderColor, 2.0));
+                    painter->setBrush(Qt::NoBrush);
+                    painter->drawPolygon(screenPoly);
+                }
+            }
+        }
+    }
+
+    // Draw region highlights from overlay manager (with their specific colors)
+    for (auto* regionHighlight : regionOverlays) {
+        const GeoFeature* feature = findByCode(regionHighlight->regionCode());
+        if (!feature) continue;
+
+        for (const QPolygonF& geoPoly : feature->polygons) {
+            QPolygonF screenPoly = toScreenPolygon(geoPoly, clipRect);
+
+            if (!screenPoly.isEmpty()) {
+                // Draw fill
+                if (regionHighlight->fillColor().alpha() > 0) {
+                    painter->setPen(Qt::NoPen);
+                    painter->setBrush(regionHighlight->fillColor());
+                    painter->drawPolygon(screenPoly);
+                }
+
+                // Draw border
+                if (regionHighlight->borderColor().alpha() > 0) {
+                    painter->setPen(QPen(regionHighlight->borderColor(), regionHighlight->borderWidth()));
+                    painter->setBrush(Qt::NoBrush);
+                    painter->drawPolygon(screenPoly);
+                }
+            }
+        }
+    }
+}
+
+void MapPainter::renderRegionTracks(QPainter* painter, double currentTime, double totalDuration) {
+    if (!m_camera || m_features.isEmpty() || !m_regionTracks) return;
+
+    double viewW = m_viewSize.width();
+    double viewH = m_viewSize.height();
+    if (viewW <= 0 || viewH <= 0) return;
+    const QRectF clipRect = polygonClipRect();
+
+    // Get all visible tracks at current time with their calculated opacities
+    auto visibleTracks = m_regionTracks->visibleTracksAtTime(currentTime, totalDuration);
+
+    for (const auto& trackPair : visibleTracks) {
+        const RegionTrack* track = trackPair.first;
+        double opacity = trackPair.second;
+
+        if (opacity <= 0.0) continue;
+
+        // Find the geographic feature for this region
+        const GeoFeature* feature = findByCode(track->regionCode);
+        if (!feature) {
+            // Try finding by name if code didn't match
+            feature = findByName(track->regionName);
+        }
+        if (!feature) continue;
+
+        // Apply opacity to colors
+        QColor fillColor = track->fillColor;
+        fillColor.setAlphaF(fillColor.alphaF() * opacity);
+
+        QColor borderColor = track->borderColor;
+        borderColor.setAlphaF(borderColor.alphaF() * opacity);
+
+        // Draw the region polygons
+        for (const QPolygonF& geoPoly : feature->polygons) {
+            QPolygonF screenPoly = toScreenPolygon(geoPoly, clipRect);
+
+            if (!screenPoly.isEmpty()) {
+                // Draw fill
+                if (fillColor.alpha() > 0) {
+                    painter->setPen(Qt::NoPen);
+                    painter->setBrush(fillColor);
+                    painter->drawPolygon(screenPoly);
+                }
+
+                // Draw border
+                if (borderColor.alpha() > 0 && track->borderWidth > 0) {
+                    painter->setPen(QPen(borderColor, track->borderWidth));
+                    painter->setBrush(Qt::NoBrush);
+                    painter->drawPolygon(screenPoly);
+                }
+            }
+        }
+    }
+}
+
+void MapPainter::renderGeoOverlays(QPainter* painter, double currentTime, double totalDuration) {
+    if (!m_camera || !m_geoOverlays) return;
+
+    double viewW = m_viewSize.width();
+    double viewH = m_viewSize.height();
+    if (viewW <= 0 || viewH <= 0) return;
+    const QRectF clipRect = polygonClipRect();
+
+    // Only overlays active at this time, with their fade opacity
+    const auto visibleOverlays = m_geoOverlays->visibleOverlaysAtTime(currentTime, totalDuration);
+
+    for (const auto& overlayPair : visibleOverlays) {
+        const GeoOverlay& overlay = *overlayPair.first;
+        double opacity = overlayPair.second;
+
+        // Apply opacity to colors
+        QColor fillColor = overlay.fillColor;
+        fillColor.setAlphaF(fillColor.alphaF() * opacity);
+
+        QColor borderColor = overlay.borderColor;
+        borderColor.setAlphaF(borderColor.alphaF() * opacity);
+
+        if (overlay.type == GeoOverlayType::City) {
+            // Check if city has boundary polygons
+            if (!overlay.polygons.isEmpty()) {
+                // Render city boundary as polygons (like countries/regions)
+                for (const QPolygonF& geoPoly : overlay.polygons) {
+                    QPolygonF screenPoly = toScreenPolygon(geoPoly, clipRect);
+
+                    if (!screenPoly.isEmpty()) {
+                        // Draw fill
+                        if (fillColor.alpha() > 0) {
+                            painter->setPen(Qt::NoPen);
+                            painter->setBrush(fillColor);
+                            painter->drawPolygon(screenPoly);
+                        }
+
+                        // Draw border
+                        painter->setPen(QPen(borderColor, overlay.borderWidth > 0 ? overlay.borderWidth : 2.0));
+                        painter->setBrush(Qt::NoBrush);
+                        painter->drawPolygon(screenPoly);
+                    }
+                }
+
+                // Draw label if enabled (at centroid position)
+                if (overlay.showLabel) {
+                    QPointF screenPoint = m_camera->geoToScreen(overlay.latitude, overlay.longitude, viewW, viewH);
+                    if (screenPoint.x() >= -50 && screenPoint.x() <= viewW + 50 &&
+                        screenPoint.y() >= -50 && screenPoint.y() <= viewH + 50) {
+
+                        QColor textColor = Qt::white;
+                        textColor.setAlphaF(opacity);
+
+                        QFont font = painter->font();
+                        font.setPixelSize(11);
+                        font.setBold(true);
+                        painter->setFont(font);
+
+                        // Draw text with shadow for readability
+                        QColor shadowColor(0, 0, 0, static_cast<int>(180 * opacity));
+                        painter->setPen(shadowColor);
+                        painter->drawText(QPointF(screenPoint.x() + 1, screenPoint.y() + 1), overlay.name);
+
+                        painter->setPen(textColor);
+                        painter->drawText(screenPoint, overlay.name);
+                    }
+                }
+            } else {
+                // Fallback: Render city as a marker circle (no boundary data)
+                QPointF screenPoint = m_camera->geoToScreen(overlay.latitude, overlay.longitude, viewW, viewH);
+
+                // Check if on screen
+                if (screenPoint.x() >= -50 && screenPoint.x() <= viewW + 50 &&
+                    screenPoint.y() >= -50 && screenPoint.y() <= viewH + 50) {
+
+                    double radius = overlay.markerRadius;
+
+                    // Draw circle - border only if fill is transparent
+                    if (fillColor.alpha() > 0) {
+                        painter->setBrush(fillColor);
+                    } else {
+                        painter->setBrush(Qt::NoBrush);
+                    }
+
+                    if (borderColor.alpha() > 0) {
+                        painter->setPen(QPen(borderColor, 3));  // Thicker border for visibility
+                    } else {
+                        painter->setPen(Qt::NoPen);
+                    }
+                    painter->drawEllipse(screenPoint, radius, radius);
+
+                    // Draw label if enabled
+                    if (overlay.showLabel) {
+                        QColor textColor = Qt::white;
+                        textColor.setAlphaF(opacity);
+
+                        painter->setPen(textColor);
+                        QFont font = painter->font();
+                        font.setPixelSize(11);
+                        font.setBold(true);
+                        painter->setFont(font);
+
+                        // Draw text with shadow for readability
+                        QColor shadowColor(0, 0, 0, static_cast<int>(180 * opacity));
+                        painter->setPen(shadowColor);
+                        painter->drawText(QPointF(screenPoint.x() + radius + 5 + 1, screenPoint.y() + 4 + 1), overlay.name);
+
+                        painter->setPen(textColor);
+                        painter->drawText(QPointF(screenPoint.x() + radius + 5, screenPoint.y() + 4), overlay.name);
+                    }
+                }
+            }
+        } else {
+            // Render country/region polygons
+            // Debug: log polygon count
+            if (overlay.polygons.isEmpty()) {
+                qWarning() << "WARNING: No polygons for" << overlay.name << "code=" << overlay.code;
+            }
+
+            for (const QPolygonF& geoPoly : overlay.polygons) {
+                QPolygonF screenPoly = toScreenPolygon(geoPoly, clipRect);
+
+                if (!screenPoly.isEmpty()) {
+                    // Draw fill
+                    if (fillColor.alpha() > 0) {
+                        painter->setPen(Qt::NoPen);
+                        painter->setBrush(fillColor);
+                        painter->drawPolygon(screenPoly);
+                    }
+
+                    // Draw border - ALWAYS draw for debugging
+                    painter->setPen(QPen(borderColor, overlay.borderWidth > 0 ? overlay.borderWidth : 3.0));
+                    painter->setBrush(Qt::NoBrush);
+                    painter->drawPolygon(screenPoly);
+                }
+            }
+        }
+    }
+}
+
+void MapPainter::renderOverlays(QPainter* painter, double currentTime, OverlayRenderer& renderer) {
+    if (!m_camera || !m_overlays) return;
+    if (m_viewSize.width() <= 0 || m_viewSize.height() <= 0) return;
+
+    // Get overlays visible at current time
+    auto visibleOverlays = m_overlays->visibleOverlaysAtTime(currentTime);
+    if (visibleOverlays.isEmpty()) return;
+
+    renderer.render(painter, visibleOverlays, currentTime, *m_camera, m_viewSize,
+                             spritePixelRatio(painter));
+}
+
+qreal MapPainter::spritePixelRatio(QPainter* painter) {
+    // Sprites are rasterised at the resolution they land on, including the
+    // export scale in renderToImage(); quarter steps keep caches stable
+    const QTransform& world = painter->worldTransform();
+    qreal scale = painter->device()->devicePixelRatio() * std::hypot(world.m11(), world.m12());
+    return std::ceil(scale * 4.0) / 4.0;
+}
+
+void MapPainter::renderLabels(QPainter* painter, Caches& caches, bool reuseLayout) {
+    if (!m_camera || m_features.isEmpty()) return;
+
+    double viewW = m_viewSize.width();
+    double viewH = m_viewSize.height();
+    if (viewW <= 0 || viewH <= 0) return;
+
+    double zoom = m_camera->zoom();
+
+    // Labels fade when the camera moves fast; marker names stay
+    bool showLabels = m_settings.labelOpacity > 0.01;
+    bool showMarkerNames = m_settings.showCityMarkers && zoom >= 6;
+    if (!showLabels && !showMarkerNames) return;
+
+    caches.labels.setDevicePixelRatio(spritePixelRatio(painter));
+
+    // Point sizes as before, converted to pixels at 96 dpi
+    auto pixels = [](double pointSize) { return qRound(pointSize * 4.0 / 3.0); };
+    enum { CountryStyle, RegionStyle, CityStyle, MarkerStyle, SelectedMarkerStyle };
+    QVector<LabelEngine::Style> styles(5);
+    styles[CountryStyle].pixelSize = pixels(static_cast<int>(10 + (zoom - 2) * 1.5));
+    styles[CountryStyle].weight = QFont::Bold;
+    styles[RegionStyle].pixelSize = pixels(static_cast<int>(8 + (zoom - 5) * 1.0));
+    styles[RegionStyle].color = QColor(220, 220, 220);
+    styles[RegionStyle].outlineWidth = 0;
+    styles[RegionStyle].shadow = QColor(0, 0, 0, 150);
+    styles[CityStyle].pixelSize = pixels(static_cast<int>(8 + (zoom - 6) * 0.8));
+    styles[CityStyle].color = QColor(255, 255, 200);
+    styles[CityStyle].outlineWidth = 0;
+    styles[CityStyle].shadow = QColor(0, 0, 0, 150);
+    styles[MarkerStyle].pixelSize = pixels(10);
+    styles[MarkerStyle].color = QColor(255, 255, 255, 220);
+    styles[MarkerStyle].outlineWidth = 0;
+    styles[MarkerStyle].shadow = QColor(0, 0, 0, 180);
+    styles[SelectedMarkerStyle] = styles[MarkerStyle];
+    styles[SelectedMarkerStyle].color = QColor(255, 220, 0, 255);
+
+    // Collisions go to the higher tier; within a tier to the larger
+    // country or city (weight in [0, 1))
+    static constexpr double SELECTED_TIER = 8.0;
+    static constexpr double COUNTRY_TIER = 6.0;
+    static constexpr double MARKER_TIER = 4.0;
+    static constexpr double CITY_TIER = 2.0;
+    static constexpr double REGION_TIER = 0.0;
+
+    const QVector<GeoFeature>& features = m_features;
+    auto areaWeight = [](double area) {
+        return qMin(0.999, std::log1p(area) / std::log1p(360.0 * 360.0));
+    };
+    auto populationWeight = [](int population) {
+        return qBound(0.0, std::log10(qMax(1, population)) / 8.0, 0.999);
+    };
+
+    bool countries = showLabels && m_settings.showCountryLabels && zoom >= 2.0 && zoom <= 10.0;
+    bool regions = showLabels && m_settings.showRegionLabels && zoom >= 5.0 && zoom <= 12.0;
+    bool cities = showLabels && m_settings.showCityLabels && zoom >= 6.0;
+
+    // Larger cities at lower zoom, smaller cities at higher zoom
+    int cityMinPopulation = 0;
+    if (zoom < 8) cityMinPopulation = 1000000;       // Mega cities only
+    else if (zoom < 10) cityMinPopulation = 500000;  // Large cities
+    else if (zoom < 12) cityMinPopulation = 100000;  // Medium cities
+    else cityMinPopulation = 50000;                   // Small cities
+
+    // Names of the city markers, same thresholds as renderCityMarkers()
+    int markerMinPopulation = 0;
+    if (zoom < 7) markerMinPopulation = 1000000;
+    else if (zoom < 9) markerMinPopulation = 500000;
+    else if (zoom < 11) markerMinPopulation = 100000;
+    else markerMinPopulation = 50000;
+
+    auto onScreen = [viewW, viewH](const QPointF& p, double marginX, double marginY) {
+        return p.x() >= -marginX && p.x() <= viewW + marginX &&
+               p.y() >= -marginY && p.y() <= viewH + marginY;
+    };
+
+    QVector<LabelEngine::Candidate> candidates;
+    QVector<QPointF> cityDots;
+    for (int i = 0; i < features.size(); ++i) {
+        const GeoFeature& feature = features[i];
+        if (feature.name.isEmpty()) continue;
+        const quint64 id = static_cast<quint64>(i) << 2;
+
+        if (feature.type == "country") {
+            if (!countries || feature.labelAnchor.isNull()) continue;
+            QPointF screenPos = m_camera->geoToScreen(feature.labelAnchor.x(), feature.labelAnchor.y(), viewW, viewH);
+            if (!onScreen(screenPos, 100, 50)) continue;
+            candidates.append({id, feature.name, CountryStyle, screenPos, QPointF(),
+                               COUNTRY_TIER + areaWeight(feature.area), m_settings.labelOpacity});
+        } else if (feature.type == "region") {
+            if (!regions) continue;
+            QPointF screenPos = m_camera->geoToScreen(feature.labelAnchor.x(), feature.labelAnchor.y(), viewW, viewH);
+            if (!onScreen(screenPos, 50, 30)) continue;
+            candidates.append({id | 1, feature.name, RegionStyle, screenPos, QPointF(),
+                               REGION_TIER, m_settings.labelOpacity});
+        } else if (feature.type == "city") {
+            if (!cities && !showMarkerNames) continue;
+            int population = feature.properties.value("population", 0).toInt();
+            QPointF screenPos = m_camera->geoToScreen(feature.centroid.x(), feature.centroid.y(), viewW, viewH);
+
+            if (cities && population >= cityMinPopulation && onScreen(screenPos, 30, 20)) {
+                cityDots.append(screenPos);
+                candidates.append({id | 2, feature.name, CityStyle, screenPos, QPointF(0, -10),
+                                   CITY_TIER + populationWeight(population), m_settings.labelOpacity});
+            }
+            if (showMarkerNames && population >= markerMinPopulation && onScreen(screenPos, 20, 20)) {
+                bool isSelected = (m_settings.selectedFeatureType == "city" && feature.name == m_settings.selectedFeatureName);
+                candidates.append({id | 3, feature.name, isSelected ? SelectedMarkerStyle : MarkerStyle,
+                                   screenPos, QPointF(0, -15),
+                                   (isSelected ? SELECTED_TIER : MARKER_TIER) + populationWeight(population), 1.0});
+            }
+        }
+    }
+
+    // City dots belong to the labels and fade with them
+    if (!cityDots.isEmpty()) {
+        painter->setOpacity(m_settings.labelOpacity);
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(Qt::white);
+        for (const QPointF& dot : cityDots) {
+            painter->drawEllipse(dot, 3, 3);
+        }
+        painter->setOpacity(1.0);
+    }
+
+    LabelEngine::View view;
+    view.size = QSizeF(viewW, viewH);
+    view.zoom = zoom;
+    view.bearing = m_camera->bearing();
+    view.tilt = m_camera->tilt();
+    view.contentKey = qHashMulti(0, m_settings.showCountryLabels, m_settings.showRegionLabels,
+                                 m_settings.showCityLabels, m_settings.showCityMarkers, showLabels,
+                                 m_settings.selectedFeatureType, m_settings.selectedFeatureName);
+    view.pan = m_camera->geoToScreen(caches.labelReferenceGeo.x(), caches.labelReferenceGeo.y(), viewW, viewH)
+             - QPointF(viewW / 2, viewH / 2);
+    view.allowReuse = reuseLayout;
+
+    if (caches.labels.layout(candidates, styles, view)) {
+        caches.labelReferenceGeo = m_camera->screenToGeo(viewW / 2, viewH / 2, viewW, viewH);
+    }
+    caches.labels.draw(painter);
+}
+
+
+QImage MapPainter::renderToImage(int targetWidth, int targetHeight) {
+    QImage image(targetWidth, targetHeight, QImage::Format_ARGB32);
+    image.fill(Qt::black);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    if (m_viewSize.isEmpty()) return image;
+
+    // Drawn in view coordinates, scaled to the target size
+    double scaleX = static_cast<double>(targetWidth) / m_viewSize.width();
+    double scaleY = static_cast<double>(targetHeight) / m_viewSize.height();
+    painter.scale(scaleX, scaleY);
+
+    // Exports solve labels from scratch so a frame never depends on the
+    // ones rendered before it. Their own caches keep the export scale from
+    // re-rasterising the view's label and sprite atlases, and back.
+    renderLayers(&painter, AllLayers, m_imageCaches, false);
+
+    return image;
+}
+
+QByteArray MapPainter::settingsSignature() const {
+    QByteArray buffer;
+    QDataStream out(&buffer, QIODevice::WriteOnly);
+
+    const Settings& s = m_settings;
+    out << tileSource()
+        << s.showCountryLabels << s.showRegionLabels << s.showCityLabels
+        << s.shadeNonHighlighted << s.nonHighlightedOpacity
+        << s.showCountryBorders << s.showCityMarkers
+        << s.selectedFeatureCode << s.selectedFeatureType;
+
+    QStringList highlightKeys = s.highlights.keys();
+    highlightKeys.sort();
+    for (const QString& code : highlightKeys) {
+        HighlightStyle style = s.highlights.value(code);
+        out << code << style.fillColor.rgba() << style.borderColor.rgba();
+    }
+    return buffer;
+}
+
+QByteArray MapPainter::frameSignature(int targetWidth, int targetHeight) const {
+    QByteArray buffer;
+    QDataStream out(&buffer, QIODevice::WriteOnly);
+
+    // The size the frame is rendered at and the view size it is laid out in
+    // and scaled from; either one changes every pixel
+    out << targetWidth << targetHeight << m_viewSize.width() << m_viewSize.height();
+
+    if (m_camera) {
+        out << m_camera->latitude() << m_camera->longitude() << m_camera->zoom()
+            << m_camera->bearing() << m_camera->tilt();
+    }
+
+    // Styling and label fade
+    out << settingsSignature() << m_settings.labelOpacity;
+
+    // Tile set: source, zoom and the zoom each visible tile is actually drawn
+    // from. A frame drawn with fallback or placeholder tiles must not match
+    // one drawn with real ones.
+    if (m_camera) {
+        int source = tileSource();
+        int tileZoom = preferredTileZoom();
+        auto range = m_camera->visibleTileRangeAtZoom(m_viewSize.width(), m_viewSize.height(), tileZoom);
+        out << source << tileZoom << range.minX << range.maxX << range.minY << range.maxY;
+
+        QByteArray drawnZooms;
+        drawnZooms.reserve((range.maxX - range.minX + 1) * (range.maxY - range.minY + 1));
+        for (int ty = range.minY; ty <= range.maxY; ty++) {
+            for (int tx = range.minX; tx <= range.maxX; tx++) {
+                drawnZooms.append(static_cast<char>(drawnTileZoom(source, tx, ty, tileZoom)));
+            }
+        }
+        out << drawnZooms;
+    }
+
+    // Region tracks and geo overlays with their evaluated properties
+    if (m_regionTracks) {
+        for (const auto& trackPair : m_regionTracks->visibleTracksAtTime(m_currentTime, m_totalDuration)) {
+            const RegionTrack* track = trackPair.first;
+            out << track->regionCode << track->fillColor.rgba() << track->borderColor.rgba()
+                << track->borderWidth << trackPair.second;
+        }
+    }
+
+    if (m_geoOverlays) {
+        for (const auto& overlayPair : m_geoOverlays->visibleOverlaysAtTime(m_currentTime, m_totalDuration)) {
+            const GeoOverlay& overlay = *overlayPair.first;
+            double opacity = overlayPair.second;
+
+            OverlayKeyframe props = overlay.propertiesAtTime(m_currentTime);
+            out << overlay.id << static_cast<int>(overlay.type) << overlay.name << opacity
+                << overlay.fillColor.rgba() << overlay.borderColor.rgba() << overlay.borderWidth
+                << overlay.markerRadius << overlay.showLabel << overlay.latitude << overlay.longitude
+                << static_cast<quint64>(polygonsHash(overlay.polygons))
+                << props.opacity << props.extrusion << props.scale
+                << props.fillColor.rgba() << props.borderColor.rgba();
+
+            for (const OverlayEffect& effect : overlay.effects) {
+                out << effect.type << effect.intensityAtTime(m_currentTime);
+            }
+        }
+    }
+
+    if (m_overlays) {
+        for (const Overlay* overlay : m_overlays->visibleOverlaysAtTime(m_currentTime)) {
+            out << QJsonDocument(overlay->toJson()).toJson(QJsonDocument::Compact);
+            if (overlay->type() == OverlayType::Arrow) {
+                // Arrows are drawn up to their animated reveal
+                out << static_cast<const ArrowOverlay*>(overlay)->animationProgress(m_currentTime);
+            }
+        }
+    }
+
+    return QCryptographicHash::hash(buffer, QCryptographicHash::Sha1);
+}
+
+void MapPainter::requestVisibleTiles() {
+    if (!m_camera || !m_tileProvider) return;
+
+    int source = m_tileProvider->currentSource();
+    int tileZoom = preferredTileZoom();
+    auto range = m_camera->visibleTileRangeAtZoom(m_viewSize.width(), m_viewSize.height(), tileZoom);
+
+    for (int ty = range.minY; ty <= range.maxY; ty++) {
+        for (int tx = range.minX; tx <= range.maxX; tx++) {
+            if (!m_tileCache || !m_tileCache->isCached(source, tx, ty, tileZoom)) {
+                m_tileProvider->requestTile(tx, ty, tileZoom);
+            }
+        }
+    }
+}
+
+
+bool MapPainter::visibleTilesCached() const {
+    if (!m_camera || !m_tileCache) return false;
+
+    int source = tileSource();
+    int tileZoom = preferredTileZoom();
+    auto range = m_camera->visibleTileRangeAtZoom(m_viewSize.width(), m_viewSize.height(), tileZoom);
+
+    for (int ty = range.minY; ty <= range.maxY; ty++) {
+        for (int tx = range.minX; tx <= range.maxX; tx++) {
+            if (!m_tileCache->isCached(source, tx, ty, tileZoom)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+void MapPainter::renderCountryBorders(QPainter* painter) {
+    if (!m_settings.showCountryBorders || !m_camera || m_features.isEmpty()) return;
+
+    double viewW = m_viewSize.width();
+    double viewH = m_viewSize.height();
+    if (viewW <= 0 || viewH <= 0) return;
+    const QRectF clipRect = polygonClipRect();
+
+    // Border colors
+    QColor borderColor(255, 255, 255, 120);  // White semi-transparent
+    QColor selectedBorderColor(255, 220, 0, 255);  // Yellow for selected
+
+    painter->setBrush(Qt::NoBrush);
+
+    for (const auto& feature : m_features) {
+        if (feature.type != "country") continue;
+
+        bool isSelected = (m_settings.selectedFeatureType == "country" && feature.code == m_settings.selectedFeatureCode);
+
+        if (isSelected) {
+            painter->setPen(QPen(selectedBorderColor, 3.0));
+        } else {
+            painter->setPen(QPen(borderColor, 1.0));
+        }
+
+        for (const QPolygonF& geoPoly : feature.polygons) {
+            QPolygonF screenPoly = toScreenPolygon(geoPoly, clipRect);
+
+            if (!screenPoly.isEmpty()) {
+                painter->drawPolygon(screenPoly);
+            }
+        }
+    }
+}
+
+void MapPainter::renderCityMarkers(QPainter* painter) {
+    if (!m_settings.showCityMarkers || !m_camera || m_features.isEmpty()) return;
+
+    double viewW = m_viewSize.width();
+    double viewH = m_viewSize.height();
+    if (viewW <= 0 || viewH <= 0) return;
+
+    double zoom = m_camera->zoom();
+
+    // Filter cities by zoom level
+    int minPopulation = 0;
+    if (zoom < 5) minPopulation = 5000000;
+    else if (zoom < 7) minPopulation = 1000000;
+    else if (zoom < 9) minPopulation = 500000;
+    else if (zoom < 11) minPopulation = 100000;
+    else minPopulation = 50000;
+
+    QColor markerColor(255, 100, 100, 200);
+    QColor selectedMarkerColor(255, 220, 0, 255);
+
+    // Names are placed with the other labels in renderLabels()
+    painter->setPen(Qt::NoPen);
+    for (const auto& feature : m_features) {
+        if (feature.type != "city") continue;
+
+        int population = feature.properties.value("population", 0).toInt();
+        if (population < minPopulation) continue;
+
+        QPointF screenPos = m_camera->geoToScreen(feature.centroid.x(), feature.centroid.y(), viewW, viewH);
+
+        // Skip if off screen
+        if (screenPos.x() < -20 || screenPos.x() > viewW + 20 ||
+            screenPos.y() < -20 || screenPos.y() > viewH + 20) continue;
+
+        bool isSelected = (m_settings.selectedFeatureType == "city" && feature.name == m_settings.selectedFeatureName);
+
+        // Draw marker circle
+        double markerSize = isSelected ? 8 : 5;
+        painter->setBrush(isSelected ? selectedMarkerColor : markerColor);
+        painter->drawEllipse(screenPos, markerSize, markerSize);
+    }
+}
+
+
+QRectF MapPainter::polygonClipRect() const {
+    // Past the viewport by more than any border is wide, so the edges the
+    // clip adds are never seen. Rotation and tilt are applied by the
+    // painter and show more of the map than the unrotated viewport.
+    double margin = CLIP_MARGIN;
+    if (m_camera->bearing() != 0.0 || m_camera->tilt() > 0.0) {
+        margin += qMax(m_viewSize.width(), m_viewSize.height());
+    }
+    return QRectF(0, 0, m_viewSize.width(), m_viewSize.height()).adjusted(-margin, -margin, margin, margin);
+}
+
+QPolygonF MapPainter::toScreenPolygon(const QPolygonF& geoPolygon, const QRectF& clipRect) const {
+    QPolygonF screenPoly;
+    screenPoly.reserve(geoPolygon.size());
+    for (const QPointF& geoPoint : geoPolygon) {
+        // Polygons store (lat=x, lon=y) after parsing
+        screenPoly.append(m_camera->geoToScreen(geoPoint.x(), geoPoint.y(), m_viewSize.width(), m_viewSize.height()));
+    }
+
+    // At high zoom a country's outline runs for thousands of pixels off
+    // screen; clipped, QPainter only rasterises the part near the view
+    const QRectF bounds = screenPoly.boundingRect();
+    if (clipRect.contains(bounds)) return screenPoly;
+    if (!clipRect.intersects(bounds)) return QPolygonF();
+    return PolygonClip::clip(screenPoly, clipRect);
+}
+
+
+const GeoFeature* MapPainter::findByCode(const QString& code) const {
+    for (const auto& feature : m_features) {
+        if (feature.code == code) {
+            return &feature;
+        }
+    }
+    return nullptr;
+}
+
+const GeoFeature* MapPainter::findByName(const QString& name) const {
+    for (const auto& feature : m_features) {
+        if (feature.name.compare(name, Qt::CaseInsensitive) == 0) {
+            return &feature;
+        }
+    }
+    return nullptr;
+}
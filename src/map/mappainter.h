@@ -0,0 +1,160 @@
+#pragma once
+
+#include <QHash>
+#include <QColor>
+#include <QImage>
+#include <QSizeF>
+#include <QString>
+#include <QVector>
+#include "geojsonparser.h"
+#include "labelengine.h"
+#include "overlayrenderer.h"
+
+class QPainter;
+class TileProvider;
+class TileCache;
+class MapCamera;
+class OverlayManager;
+class RegionTrackModel;
+class GeoOverlayModel;
+struct RenderSnapshot;
+
+// Draws the map layers with a QPainter. MapRenderer forwards to one for the
+// view and for exports; FrameBufferFiller owns one on its worker thread, so
+// buffered frames are drawn without a QQuickItem. Holds no Qt object state:
+// the features are an implicitly shared copy that is only ever read, and the
+// tile cache locks internally, so a painter may live on any thread as long
+// as its camera and models live there too.
+class MapPainter {
+public:
+    enum Layer {
+        BaseLayer = 0x1,       // Tiles, borders, highlights: camera, tiles, styling
+        TimelineLayer = 0x2,   // Region tracks, geo overlays: camera, time, their models
+        TopLayer = 0x4,        // City markers, overlays, labels: camera, label fade, overlays
+        AllLayers = BaseLayer | TimelineLayer | TopLayer
+    };
+
+    struct HighlightStyle {
+        QColor fillColor;
+        QColor borderColor;
+    };
+
+    // Everything besides the camera and models that changes what is drawn
+    struct Settings {
+        bool showCountryLabels = false;
+        bool showRegionLabels = false;
+        bool showCityLabels = false;
+        bool showCountryBorders = false;
+        bool showCityMarkers = false;
+        bool shadeNonHighlighted = false;
+        double nonHighlightedOpacity = 0.3;
+        double labelOpacity = 1.0;
+        int tileSource = 0;               // Used when there is no tile provider
+
+        QHash<QString, HighlightStyle> highlights;
+        QString selectedFeatureCode;
+        QString selectedFeatureName;
+        QString selectedFeatureType;
+    };
+
+    // The provider is optional; without it missing tiles are not requested
+    void setTileProvider(TileProvider* provider) { m_tileProvider = provider; }
+    void setTileCache(TileCache* cache) { m_tileCache = cache; }
+    void setCamera(MapCamera* camera) { m_camera = camera; }
+    void setOverlayManager(OverlayManager* overlays) { m_overlays = overlays; }
+    void setRegionTrackModel(RegionTrackModel* regionTracks) { m_regionTracks = regionTracks; }
+    void setGeoOverlayModel(GeoOverlayModel* geoOverlays) { m_geoOverlays = geoOverlays; }
+    void setFeatures(const QVector<GeoFeature>& features) { m_features = features; }
+    const QVector<GeoFeature>& features() const { return m_features; }
+
+    Settings& settings() { return m_settings; }
+    const Settings& settings() const { return m_settings; }
+
+    QSizeF viewSize() const { return m_viewSize; }
+    void setViewSize(const QSizeF& size) { m_viewSize = size; }
+
+    double currentTime() const { return m_currentTime; }
+    void setCurrentTime(double timeMs) { m_currentTime = timeMs; }
+
+    double totalDuration() const { return m_totalDuration; }
+    void setTotalDuration(double durationMs) { m_totalDuration = durationMs; }
+
+    // Settings, view size and features from a snapshot; the caller loads the
+    // models and positions the camera
+    void applySnapshot(const RenderSnapshot& snapshot);
+
+    // Draws the given layers in view coordinates
+    void render(QPainter* painter, int layers = AllLayers);
+
+    // Renders every layer scaled from the view size to the target size
+    QImage renderToImage(int width, int height);
+
+    // Tile source, layer toggles, highlights and selection: the styling
+    // every frame depends on, whatever the camera and time
+    QByteArray settingsSignature() const;
+
+    // Hash of every input that affects renderToImage() at the current time.
+    // Equal signatures mean identical frames, so exports can reuse them.
+    QByteArray frameSignature(int width, int height) const;
+
+    int tileSource() const;
+
+    // True when every tile the current view needs is in the memory or disk cache
+    bool visibleTilesCached() const;
+
+    // Request any uncached tiles for the current view (used to prefetch before export)
+    void requestVisibleTiles();
+
+private:
+    // Label placement and sprite atlases, rasterised at one pixel ratio.
+    // The reference point measures how far the view panned since the last
+    // full placement.
+    struct Caches {
+        LabelEngine labels;
+        QPointF labelReferenceGeo;
+        OverlayRenderer overlays;
+    };
+
+    void renderLayers(QPainter* painter, int layers, Caches& caches, bool reuseLabels);
+    void applyTransforms(QPainter* painter);
+    void renderTiles(QPainter* painter);
+    int preferredTileZoom() const;
+    bool tryRenderFallbackTile(QPainter* painter, int tx, int ty, int targetZoom,
+                               double screenX, double screenY, double tileSize, int source);
+    // Zoom of the cached tile renderTiles() draws for (tx, ty), -1 for a placeholder
+    int drawnTileZoom(int source, int tx, int ty, int targetZoom) const;
+    void renderHighlights(QPainter* painter);
+    void renderRegionTracks(QPainter* painter, double currentTime, double totalDuration);
+    void renderGeoOverlays(QPainter* painter, double currentTime, double totalDuration);
+    void renderCountryBorders(QPainter* painter);
+    void renderCityMarkers(QPainter* painter);
+    void renderOverlays(QPainter* painter, double currentTime, OverlayRenderer& renderer);
+    void renderLabels(QPainter* painter, Caches& caches, bool reuseLayout);
+    static qreal spritePixelRatio(QPainter* painter);
+    QRectF polygonClipRect() const;
+    QPolygonF toScreenPolygon(const QPolygonF& geoPolygon, const QRectF& clipRect) const;
+    const GeoFeature* findByCode(const QString& code) const;
+    const GeoFeature* findByName(const QString& name) const;
+
+    // render() and renderToImage() draw at different scales, so each keeps
+    // its own caches rather than invalidating the other's every frame
+    Caches m_viewCaches;
+    Caches m_imageCaches;
+
+    TileProvider* m_tileProvider = nullptr;
+    TileCache* m_tileCache = nullptr;
+    MapCamera* m_camera = nullptr;
+    OverlayManager* m_overlays = nullptr;
+    RegionTrackModel* m_regionTracks = nullptr;
+    GeoOverlayModel* m_geoOverlays = nullptr;
+    QVector<GeoFeature> m_features;
+
+    Settings m_settings;
+    QSizeF m_viewSize;
+    double m_currentTime = 0.0;
+    double m_totalDuration = 0.0;
+
+    static constexpr int TILE_SIZE = 256;
+    static constexpr int FALLBACK_LEVELS = 4;    // Lower zooms tried for a missing tile
+    static constexpr double CLIP_MARGIN = 16.0;  // Pixels beyond the viewport polygons are clipped to
+};
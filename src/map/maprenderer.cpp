@@ -3,20 +3,15 @@
 #include "tilecache.h"
 #include "mapcamera.h"
 #include "geojsonparser.h"
+#include "rendersnapshot.h"
 #include "../overlays/overlaymanager.h"
-#include "../overlays/regionhighlight.h"
 #include "../animation/framebuffer.h"
 #include "../animation/regiontrackmodel.h"
 #include "../animation/geooverlaymodel.h"
-#include "../animation/geooverlay.h"
 #include <QPainter>
+#include <QQuickWindow>
 #include <QtMath>
-#include <QTransform>
 #include <cmath>
-#include <QMetaObject>
-#include <QSet>
-#include <QFile>
-#include <QTextStream>
 
 MapRenderer::MapRenderer(QQuickItem* parent)
     : QQuickPaintedItem(parent)
@@ -25,690 +20,63 @@ MapRenderer::MapRenderer(QQuickItem* parent)
     setRenderTarget(QQuickPaintedItem::FramebufferObject);
 }
 
-void MapRenderer::paint(QPainter* painter) {
-    if (!m_camera) return;
-
-    // Check if we can use a cached frame
-    if (m_useFrameBuffer && m_frameBuffer && m_frameBuffer->hasFrame(m_currentAnimationTime)) {
-        QImage cachedFrame = m_frameBuffer->getFrame(m_currentAnimationTime);
-        if (!cachedFrame.isNull()) {
-            painter->drawImage(QRectF(0, 0, width(), height()), cachedFrame);
-            emit renderingComplete();
-            return;
-        }
-    }
-
-    painter->save();
-
-    // Apply camera transforms (bearing and tilt)
-    applyTransforms(painter);
-
-    // Render layers in order
-    renderTiles(painter);
-    renderCountryBorders(painter);
-    renderHighlights(painter);
-    renderRegionTracks(painter, m_currentAnimationTime, m_totalDuration);
-    renderGeoOverlays(painter, m_currentAnimationTime, m_totalDuration);
-    renderCityMarkers(painter);
-    renderOverlays(painter, m_currentAnimationTime);
-    renderLabels(painter);
-
-    resetTransforms(painter);
-    painter->restore();
-
-    // Store frame in buffer if not already cached - DISABLED for debugging
-    /*
-    if (m_useFrameBuffer && m_frameBuffer && !m_frameBuffer->hasFrame(m_currentAnimationTime)) {
-        QImage frame = renderToImage(static_cast<int>(width()), static_cast<int>(height()));
-        m_frameBuffer->storeFrame(m_currentAnimationTime, frame);
-    }
-    */
-
-    emit renderingComplete();
+void MapRenderer::geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry) {
+    QQuickPaintedItem::geometryChange(newGeometry, oldGeometry);
+    m_painter.setViewSize(newGeometry.size());
 }
 
-void MapRenderer::applyTransforms(QPainter* painter) {
+void MapRenderer::paint(QPainter* painter) {
     if (!m_camera) return;
 
-    // Apply tilt (fake 3D perspective)
-    if (m_camera->tilt() > 0) {
-        QTransform tiltTransform;
-        // Move origin to bottom center for perspective effect
-        tiltTransform.translate(width() / 2, height());
-        // Scale vertically to simulate perspective (objects at top appear smaller)
-        double tiltFactor = 1.0 - (m_camera->tilt() / 90.0) * 0.5;
-        tiltTransform.scale(1.0, tiltFactor);
-        tiltTransform.translate(-width() / 2, -height());
-        painter->setTransform(tiltTransform, true);
-    }
-
-    // Apply bearing (rotation)
-    if (m_camera->bearing() != 0) {
-        painter->translate(width() / 2, height() / 2);
-        painter->rotate(-m_camera->bearing());
-        painter->translate(-width() / 2, -height() / 2);
-    }
-}
-
-void MapRenderer::resetTransforms(QPainter* painter) {
-    painter->resetTransform();
-}
-
-void MapRenderer::renderTiles(QPainter* painter) {
-    if (!m_camera || !m_tileProvider) return;
-
-    // Enable smooth scaling for better quality during zoom transitions
-    painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
-
-    double zoom = m_camera->zoom();
-    int zoomLevel = m_camera->zoomLevel();
-    double scale = std::pow(2.0, zoom - zoomLevel);
-
-    // When scale > 1.5, try to use higher zoom level tiles (scale down instead of up)
-    // Scaling down produces better quality than scaling up
-    int preferredZoom = zoomLevel;
-    if (scale > 1.5 && zoomLevel < 19) {
-        preferredZoom = zoomLevel + 1;
-        scale = std::pow(2.0, zoom - preferredZoom);  // Will be 0.5 to 0.75
-    }
-
-    // Get visible tile range (use preferred zoom for tile coordinates)
-    auto range = m_camera->visibleTileRangeAtZoom(width(), height(), preferredZoom);
-
-    // Calculate center tile position at preferred zoom level
-    double centerLon = m_camera->longitude();
-    double centerLat = m_camera->latitude();
-    double n = std::pow(2.0, preferredZoom);
+    const qreal dpr = window() ? window()->effectiveDevicePixelRatio() : 1.0;
+    const QSize pixelSize = (size() * dpr).toSize();
 
-    double centerTileX = (centerLon + 180.0) / 360.0 * n;
-    double latRad = centerLat * M_PI / 180.0;
-    double centerTileY = (1.0 - std::log(std::tan(latRad) + 1.0 / std::cos(latRad)) / M_PI) / 2.0 * n;
-
-    // Calculate offset for sub-tile positioning
-    double offsetX = (centerTileX - std::floor(centerTileX)) * TILE_SIZE * scale;
-    double offsetY = (centerTileY - std::floor(centerTileY)) * TILE_SIZE * scale;
-
-    int centerTileXInt = static_cast<int>(std::floor(centerTileX));
-    int centerTileYInt = static_cast<int>(std::floor(centerTileY));
-
-    // Get tile source
-    int source = m_tileProvider->currentSource();
-
-    // Render tiles
-    // Add small overlap to prevent seams between tiles (floating-point precision issue)
-    constexpr double TILE_OVERLAP = 0.5;
-
-    for (int ty = range.minY; ty <= range.maxY; ty++) {
-        for (int tx = range.minX; tx <= range.maxX; tx++) {
-            // Calculate screen position for this tile
-            double screenX = width() / 2.0 + (tx - centerTileXInt) * TILE_SIZE * scale - offsetX;
-            double screenY = height() / 2.0 + (ty - centerTileYInt) * TILE_SIZE * scale - offsetY;
-            double tileSize = TILE_SIZE * scale;
-
-            QImage tile;
-            if (m_tileCache) {
-                // Try memory cache, then disk cache
-                tile = m_tileCache->get(source, tx, ty, preferredZoom);
-            }
-
-            if (!tile.isNull()) {
-                // Slightly expand the destination rect to eliminate seams
-                QRectF destRect(screenX - TILE_OVERLAP, screenY - TILE_OVERLAP,
-                               tileSize + TILE_OVERLAP * 2, tileSize + TILE_OVERLAP * 2);
-                painter->drawImage(destRect, tile);
+    // During playback a buffered frame is a single blit. The buffer is
+    // filled in the background by FrameBufferFiller, never from here.
+    if (m_useFrameBuffer && m_timelinePlaying && m_frameBuffer) {
+        QImage cachedFrame = m_frameBuffer->getFrame(m_painter.currentTime());
+        if (!cachedFrame.isNull()) {
+            // Filled at the view's device pixel size, so it maps one to one
+            if (cachedFrame.size() == pixelSize) {
+                cachedFrame.setDevicePixelRatio(dpr);
+                painter->drawImage(QPointF(0, 0), cachedFrame);
             } else {
-                // Try to render a fallback tile from a lower zoom level
-                bool hasFallback = tryRenderFallbackTile(painter, tx, ty, preferredZoom,
-                                                          screenX, screenY, tileSize, source);
-
-                // Request the correct tile in background
-                QMetaObject::invokeMethod(m_tileProvider, "requestTile",
-                                          Qt::QueuedConnection,
-                                          Q_ARG(int, tx), Q_ARG(int, ty), Q_ARG(int, preferredZoom));
-
-                // Only show placeholder if no fallback was found
-                if (!hasFallback) {
-                    painter->fillRect(QRectF(screenX - TILE_OVERLAP, screenY - TILE_OVERLAP,
-                                            tileSize + TILE_OVERLAP * 2, tileSize + TILE_OVERLAP * 2),
-                                     QColor(30, 30, 50));
-                }
-            }
-        }
-    }
-}
-
-bool MapRenderer::tryRenderFallbackTile(QPainter* painter, int tx, int ty, int targetZoom,
-                                         double screenX, double screenY, double tileSize, int source) {
-    if (!m_tileCache) return false;
-
-    // Try parent zoom levels (lower zoom = larger area per tile)
-    // Each zoom level down covers 4x the area (2x in each dimension)
-    for (int fallbackZoom = targetZoom - 1; fallbackZoom >= qMax(0, targetZoom - 4); fallbackZoom--) {
-        // Calculate which tile at fallbackZoom contains our target tile
-        int zoomDiff = targetZoom - fallbackZoom;
-        int divisor = 1 << zoomDiff;  // 2^zoomDiff
-
-        int parentTx = tx / divisor;
-        int parentTy = ty / divisor;
-
-        {
-            QImage parentTile = m_tileCache->get(source, parentTx, parentTy, fallbackZoom);
-            if (parentTile.isNull()) continue;
-
-            // Calculate which portion of the parent tile to use
-            // Each parent tile is divided into divisor x divisor sub-tiles
-            int subTileX = tx % divisor;  // Which column within the parent
-            int subTileY = ty % divisor;  // Which row within the parent
-
-            int subTileSize = TILE_SIZE / divisor;
-            int srcX = subTileX * subTileSize;
-            int srcY = subTileY * subTileSize;
-
-            // Extract the relevant portion and scale it up
-            // Add small overlap to prevent seams (same as regular tiles)
-            constexpr double TILE_OVERLAP = 0.5;
-            QRectF srcRect(srcX, srcY, subTileSize, subTileSize);
-            QRectF destRect(screenX - TILE_OVERLAP, screenY - TILE_OVERLAP,
-                           tileSize + TILE_OVERLAP * 2, tileSize + TILE_OVERLAP * 2);
-
-            // Use smooth scaling for better quality
-            painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
-            painter->drawImage(destRect, parentTile, srcRect);
-
-            return true;
-        }
-    }
-
-    return false;
-}
-
-void MapRenderer::renderHighlights(QPainter* painter) {
-    if (!m_camera || !m_geojson || !m_geojson->isLoaded()) return;
-
-    double viewW = width();
-    double viewH = height();
-    if (viewW <= 0 || viewH <= 0) return;
-
-    // Collect highlighted region codes (from both internal highlights and overlay system)
-    QSet<QString> highlightedCodes;
-
-    // Add internal highlights
-    for (auto it = m_highlights.constBegin(); it != m_highlights.constEnd(); ++it) {
-        highlightedCodes.insert(it.key());
-    }
-
-    // Add region highlights from overlay manager
-    QVector<RegionHighlight*> regionOverlays;
-    if (m_overlays) {
-        auto visibleOverlays = m_overlays->visibleOverlaysAtTime(0); // TODO: Get actual animation time
-        for (auto* overlay : visibleOverlays) {
-            if (auto* regionHighlight = qobject_cast<RegionHighlight*>(overlay)) {
-                regionOverlays.append(regionHighlight);
-                highlightedCodes.insert(regionHighlight->regionCode());
-            }
-        }
-    }
-
-    // If shading non-highlighted is enabled, draw all countries with dim shade first
-    if (m_shadeNonHighlighted && !highlightedCodes.isEmpty()) {
-        QColor shadeColor(0, 0, 0, static_cast<int>((1.0 - m_nonHighlightedOpacity) * 150));
-
-        for (const auto& feature : m_geojson->features()) {
-            if (feature.type == "country" && !highlightedCodes.contains(feature.code)) {
-                for (const QPolygonF& geoPoly : feature.polygons) {
-                    QPolygonF screenPoly;
-                    screenPoly.reserve(geoPoly.size());
-
-                    for (const QPointF& geoPoint : geoPoly) {
-                        // Polygons store (lat=x, lon=y) after parsing
-                        QPointF screenPoint = m_camera->geoToScreen(geoPoint.x(), geoPoint.y(), viewW, viewH);
-                        screenPoly.append(screenPoint);
-                    }
-
-                    if (!screenPoly.isEmpty()) {
-                        painter->setPen(Qt::NoPen);
-                        painter->setBrush(shadeColor);
-                        painter->drawPolygon(screenPoly);
-                    }
-                }
+                painter->drawImage(QRectF(0, 0, width(), height()), cachedFrame);
             }
+            emit renderingComplete();
+            return;
         }
     }
 
-    // Draw internal highlights
-    for (auto it = m_highlights.constBegin(); it != m_highlights.constEnd(); ++it) {
-        const QString& regionCode = it.key();
-        const HighlightStyle& highlight = it.value();
-
-        const GeoFeature* feature = m_geojson->findByCode(regionCode);
-        if (!feature) continue;
-
-        for (const QPolygonF& geoPoly : feature->polygons) {
-            QPolygonF screenPoly;
-            screenPoly.reserve(geoPoly.size());
-
-            for (const QPointF& geoPoint : geoPoly) {
-                // GeoJSON stores as (longitude, latitude)
-                QPointF screenPoint = m_camera->geoToScreen(geoPoint.y(), geoPoint.x(), viewW, viewH);
-                screenPoly.append(screenPoint);
-            }
+    // Redraw only dirty layers, then composite. Unchanged layer images keep
+    // their cacheKey, so the scene graph reuses their uploaded textures.
+    if (pixelSize.isEmpty()) return;
 
-            if (!screenPoly.isEmpty()) {
-                // Draw fill
-                if (highlight.fillColor.alpha() > 0) {
-                    painter->setPen(Qt::NoPen);
-                    painter->setBrush(highlight.fillColor);
-                    painter->drawPolygon(screenPoly);
-                }
-
-                // Draw border
-                if (highlight.borderColor.alpha() > 0) {
-                    painter->setPen(QPen(highlight.borderColor, 2.0));
-                    painter->setBrush(Qt::NoBrush);
-                    painter->drawPolygon(screenPoly);
-                }
-            }
+    for (int i = 0; i < LAYER_COUNT; ++i) {
+        const int layer = 1 << i;
+        QImage& image = m_layerImages[i];
+        if (image.size() != pixelSize || image.devicePixelRatio() != dpr) {
+            image = QImage(pixelSize, QImage::Format_ARGB32_Premultiplied);
+            image.setDevicePixelRatio(dpr);
+            m_dirtyLayers |= layer;
         }
-    }
-
-    // Draw region highlights from overlay manager (with their specific colors)
-    for (auto* regionHighlight : regionOverlays) {
-        const GeoFeature* feature = m_geojson->findByCode(regionHighlight->regionCode());
-        if (!feature) continue;
-
-        for (const QPolygonF& geoPoly : feature->polygons) {
-            QPolygonF screenPoly;
-            screenPoly.reserve(geoPoly.size());
 
-            for (const QPointF& geoPoint : geoPoly) {
-                // GeoJSON stores as (longitude, latitude)
-                QPointF screenPoint = m_camera->geoToScreen(geoPoint.y(), geoPoint.x(), viewW, viewH);
-                screenPoly.append(screenPoint);
-            }
-
-            if (!screenPoly.isEmpty()) {
-                // Draw fill
-                if (regionHighlight->fillColor().alpha() > 0) {
-                    painter->setPen(Qt::NoPen);
-                    painter->setBrush(regionHighlight->fillColor());
-                    painter->drawPolygon(screenPoly);
-                }
-
-                // Draw border
-                if (regionHighlight->borderColor().alpha() > 0) {
-                    painter->setPen(QPen(regionHighlight->borderColor(), regionHighlight->borderWidth()));
-                    painter->setBrush(Qt::NoBrush);
-                    painter->drawPolygon(screenPoly);
-                }
-            }
+        if (m_dirtyLayers & layer) {
+            image.fill(Qt::transparent);
+            QPainter layerPainter(&image);
+            layerPainter.setRenderHint(QPainter::Antialiasing, antialiasing());
+            m_painter.render(&layerPainter, layer);
         }
+        painter->drawImage(QPointF(0, 0), image);
     }
-}
-
-void MapRenderer::renderRegionTracks(QPainter* painter, double currentTime, double totalDuration) {
-    if (!m_camera || !m_geojson || !m_geojson->isLoaded() || !m_regionTracks) return;
-
-    double viewW = width();
-    double viewH = height();
-    if (viewW <= 0 || viewH <= 0) return;
-
-    // Get all visible tracks at current time with their calculated opacities
-    auto visibleTracks = m_regionTracks->visibleTracksAtTime(currentTime, totalDuration);
+    m_dirtyLayers = 0;
 
-    for (const auto& trackPair : visibleTracks) {
-        const RegionTrack* track = trackPair.first;
-        double opacity = trackPair.second;
-
-        if (opacity <= 0.0) continue;
-
-        // Find the geographic feature for this region
-        const GeoFeature* feature = m_geojson->findByCode(track->regionCode);
-        if (!feature) {
-            // Try finding by name if code didn't match
-            feature = m_geojson->findByName(track->regionName);
-        }
-        if (!feature) continue;
-
-        // Apply opacity to colors
-        QColor fillColor = track->fillColor;
-        fillColor.setAlphaF(fillColor.alphaF() * opacity);
-
-        QColor borderColor = track->borderColor;
-        borderColor.setAlphaF(borderColor.alphaF() * opacity);
-
-        // Draw the region polygons
-        for (const QPolygonF& geoPoly : feature->polygons) {
-            QPolygonF screenPoly;
-            screenPoly.reserve(geoPoly.size());
-
-            for (const QPointF& geoPoint : geoPoly) {
-                // Polygons store (lat=x, lon=y) after parsing
-                QPointF screenPoint = m_camera->geoToScreen(geoPoint.x(), geoPoint.y(), viewW, viewH);
-                screenPoly.append(screenPoint);
-            }
-
-            if (!screenPoly.isEmpty()) {
-                // Draw fill
-                if (fillColor.alpha() > 0) {
-                    painter->setPen(Qt::NoPen);
-                    painter->setBrush(fillColor);
-                    painter->drawPolygon(screenPoly);
-                }
-
-                // Draw border
-                if (borderColor.alpha() > 0 && track->borderWidth > 0) {
-                    painter->setPen(QPen(borderColor, track->borderWidth));
-                    painter->setBrush(Qt::NoBrush);
-                    painter->drawPolygon(screenPoly);
-                }
-            }
-        }
-    }
-}
-
-void MapRenderer::renderGeoOverlays(QPainter* painter, double currentTime, double totalDuration) {
-    if (!m_camera || !m_geoOverlays) return;
-
-    double viewW = width();
-    double viewH = height();
-    if (viewW <= 0 || viewH <= 0) return;
-
-    // Get all overlays and render visible ones
-    const auto& allOverlays = m_geoOverlays->overlays();
-
-    for (const auto& overlay : allOverlays) {
-        // Calculate opacity based on timing (fade in/out)
-        double opacity = overlay.opacityAtTime(currentTime, totalDuration);
-
-        // Skip invisible overlays
-        if (opacity <= 0.0) continue;
-
-        // Apply opacity to colors
-        QColor fillColor = overlay.fillColor;
-        fillColor.setAlphaF(fillColor.alphaF() * opacity);
-
-        QColor borderColor = overlay.borderColor;
-        borderColor.setAlphaF(borderColor.alphaF() * opacity);
-
-        if (overlay.type == GeoOverlayType::City) {
-            // Check if city has boundary polygons
-            if (!overlay.polygons.isEmpty()) {
-                // Render city boundary as polygons (like countries/regions)
-                for (const QPolygonF& geoPoly : overlay.polygons) {
-                    QPolygonF screenPoly;
-                    screenPoly.reserve(geoPoly.size());
-
-                    for (const QPointF& geoPoint : geoPoly) {
-                        // Polygons store (lat=x, lon=y) after parsing
-                        QPointF screenPoint = m_camera->geoToScreen(geoPoint.x(), geoPoint.y(), viewW, viewH);
-                        screenPoly.append(screenPoint);
-                    }
-
-                    if (!screenPoly.isEmpty()) {
-                        // Draw fill
-                        if (fillColor.alpha() > 0) {
-                            painter->setPen(Qt::NoPen);
-                            painter->setBrush(fillColor);
-                            painter->drawPolygon(screenPoly);
-                        }
-
-                        // Draw border
-                        painter->setPen(QPen(borderColor, overlay.borderWidth > 0 ? overlay.borderWidth : 2.0));
-                        painter->setBrush(Qt::NoBrush);
-                        painter->drawPolygon(screenPoly);
-                    }
-                }
-
-                // Draw label if enabled (at centroid position)
-                if (overlay.showLabel) {
-                    QPointF screenPoint = m_camera->geoToScreen(overlay.latitude, overlay.longitude, viewW, viewH);
-                    if (screenPoint.x() >= -50 && screenPoint.x() <= viewW + 50 &&
-                        screenPoint.y() >= -50 && screenPoint.y() <= viewH + 50) {
-
-                        QColor textColor = Qt::white;
-                        textColor.setAlphaF(opacity);
-
-                        QFont font = painter->font();
-                        font.setPixelSize(11);
-                        font.setBold(true);
-                        painter->setFont(font);
-
-                        // Draw text with shadow for readability
-                        QColor shadowColor(0, 0, 0, static_cast<int>(180 * opacity));
-                        painter->setPen(shadowColor);
-                        painter->drawText(QPointF(screenPoint.x() + 1, screenPoint.y() + 1), overlay.name);
-
-                        painter->setPen(textColor);
-                        painter->drawText(screenPoint, overlay.name);
-                    }
-                }
-            } else {
-                // Fallback: Render city as a marker circle (no boundary data)
-                QPointF screenPoint = m_camera->geoToScreen(overlay.latitude, overlay.longitude, viewW, viewH);
-
-                // Check if on screen
-                if (screenPoint.x() >= -50 && screenPoint.x() <= viewW + 50 &&
-                    screenPoint.y() >= -50 && screenPoint.y() <= viewH + 50) {
-
-                    double radius = overlay.markerRadius;
-
-                    // Draw circle - border only if fill is transparent
-                    if (fillColor.alpha() > 0) {
-                        painter->setBrush(fillColor);
-                    } else {
-                        painter->setBrush(Qt::NoBrush);
-                    }
-
-                    if (borderColor.alpha() > 0) {
-                        painter->setPen(QPen(borderColor, 3));  // Thicker border for visibility
-                    } else {
-                        painter->setPen(Qt::NoPen);
-                    }
-                    painter->drawEllipse(screenPoint, radius, radius);
-
-                    // Draw label if enabled
-                    if (overlay.showLabel) {
-                        QColor textColor = Qt::white;
-                        textColor.setAlphaF(opacity);
-
-                        painter->setPen(textColor);
-                        QFont font = painter->font();
-                        font.setPixelSize(11);
-                        font.setBold(true);
-                        painter->setFont(font);
-
-                        // Draw text with shadow for readability
-                        QColor shadowColor(0, 0, 0, static_cast<int>(180 * opacity));
-                        painter->setPen(shadowColor);
-                        painter->drawText(QPointF(screenPoint.x() + radius + 5 + 1, screenPoint.y() + 4 + 1), overlay.name);
-
-                        painter->setPen(textColor);
-                        painter->drawText(QPointF(screenPoint.x() + radius + 5, screenPoint.y() + 4), overlay.name);
-                    }
-                }
-            }
-        } else {
-            // Render country/region polygons
-            // Debug: log polygon count
-            if (overlay.polygons.isEmpty()) {
-                qWarning() << "WARNING: No polygons for" << overlay.name << "code=" << overlay.code;
-            }
-
-            for (const QPolygonF& geoPoly : overlay.polygons) {
-                QPolygonF screenPoly;
-                screenPoly.reserve(geoPoly.size());
-
-                for (const QPointF& geoPoint : geoPoly) {
-                    // Polygons store (lat=x, lon=y) after parsing
-                    QPointF screenPoint = m_camera->geoToScreen(geoPoint.x(), geoPoint.y(), viewW, viewH);
-                    screenPoly.append(screenPoint);
-                }
-
-                if (!screenPoly.isEmpty()) {
-                    // Draw fill
-                    if (fillColor.alpha() > 0) {
-                        painter->setPen(Qt::NoPen);
-                        painter->setBrush(fillColor);
-                        painter->drawPolygon(screenPoly);
-                    }
-
-                    // Draw border - ALWAYS draw for debugging
-                    painter->setPen(QPen(borderColor, overlay.borderWidth > 0 ? overlay.borderWidth : 3.0));
-                    painter->setBrush(Qt::NoBrush);
-                    painter->drawPolygon(screenPoly);
-                }
-            }
-        }
-    }
-}
-
-void MapRenderer::renderOverlays(QPainter* painter, double currentTime) {
-    if (!m_camera || !m_overlays) return;
-
-    // Get overlays visible at current time
-    auto visibleOverlays = m_overlays->visibleOverlaysAtTime(currentTime);
-
-    for (auto* overlay : visibleOverlays) {
-        // Render based on overlay type
-        // TODO: Implement overlay rendering (markers, arrows, text)
-    }
+    emit renderingComplete();
 }
 
-void MapRenderer::renderLabels(QPainter* painter) {
-    if (!m_camera || !m_geojson || !m_geojson->isLoaded()) return;
-
-    double viewW = width();
-    double viewH = height();
-    if (viewW <= 0 || viewH <= 0) return;
-
-    double zoom = m_camera->zoom();
-
-    // Apply label opacity (fades when camera moves fast)
-    if (m_labelOpacity <= 0.01) return;
-
-    painter->setOpacity(m_labelOpacity);
-
-    // Country labels (visible at zoom 2-8)
-    if (m_showCountryLabels && zoom >= 2.0 && zoom <= 10.0) {
-        // Font size scales with zoom
-        int fontSize = static_cast<int>(10 + (zoom - 2) * 1.5);
-        QFont countryFont("Arial", fontSize, QFont::Bold);
-        painter->setFont(countryFont);
-
-        for (const auto& feature : m_geojson->features()) {
-            if (feature.type == "country" && !feature.name.isEmpty() && !feature.centroid.isNull()) {
-                // Use centroid for label position
-                QPointF screenPos = m_camera->geoToScreen(
-                    feature.centroid.x(), feature.centroid.y(), viewW, viewH);
-
-                // Only draw if on screen
-                if (screenPos.x() >= -100 && screenPos.x() <= viewW + 100 &&
-                    screenPos.y() >= -50 && screenPos.y() <= viewH + 50) {
-
-                    // Draw text with outline for visibility
-                    QString name = feature.name;
-                    QFontMetrics fm(countryFont);
-                    QRect textRect = fm.boundingRect(name);
-                    textRect.moveCenter(screenPos.toPoint());
-
-                    // Draw outline
-                    painter->setPen(QPen(QColor(0, 0, 0, 180), 3));
-                    for (int dx = -1; dx <= 1; dx++) {
-                        for (int dy = -1; dy <= 1; dy++) {
-                            if (dx != 0 || dy != 0) {
-                                painter->drawText(textRect.translated(dx, dy), Qt::AlignCenter, name);
-                            }
-                        }
-                    }
-
-                    // Draw text
-                    painter->setPen(Qt::white);
-                    painter->drawText(textRect, Qt::AlignCenter, name);
-                }
-            }
-        }
-    }
-
-    // Region labels (visible at zoom 5-12)
-    if (m_showRegionLabels && zoom >= 5.0 && zoom <= 12.0) {
-        int fontSize = static_cast<int>(8 + (zoom - 5) * 1.0);
-        QFont regionFont("Arial", fontSize);
-        painter->setFont(regionFont);
-
-        for (const auto& feature : m_geojson->features()) {
-            if (feature.type == "region" && !feature.name.isEmpty()) {
-                QPointF screenPos = m_camera->geoToScreen(
-                    feature.centroid.x(), feature.centroid.y(), viewW, viewH);
-
-                if (screenPos.x() >= -50 && screenPos.x() <= viewW + 50 &&
-                    screenPos.y() >= -30 && screenPos.y() <= viewH + 30) {
-
-                    QString name = feature.name;
-                    QFontMetrics fm(regionFont);
-                    QRect textRect = fm.boundingRect(name);
-                    textRect.moveCenter(screenPos.toPoint());
-
-                    // Outline
-                    painter->setPen(QPen(QColor(0, 0, 0, 150), 2));
-                    painter->drawText(textRect.translated(1, 1), Qt::AlignCenter, name);
-
-                    // Text
-                    painter->setPen(QColor(220, 220, 220));
-                    painter->drawText(textRect, Qt::AlignCenter, name);
-                }
-            }
-        }
-    }
-
-    // City labels (visible at zoom 6+)
-    if (m_showCityLabels && zoom >= 6.0) {
-        // Larger cities at lower zoom, smaller cities at higher zoom
-        int minPopulation = 0;
-        if (zoom < 8) minPopulation = 1000000;       // Mega cities only
-        else if (zoom < 10) minPopulation = 500000;  // Large cities
-        else if (zoom < 12) minPopulation = 100000;  // Medium cities
-        else minPopulation = 50000;                   // Small cities
-
-        int fontSize = static_cast<int>(8 + (zoom - 6) * 0.8);
-        QFont cityFont("Arial", fontSize);
-        painter->setFont(cityFont);
-
-        for (const auto& feature : m_geojson->features()) {
-            if (feature.type == "city" && !feature.name.isEmpty()) {
-                // Check population if available
-                int population = feature.properties.value("population", 0).toInt();
-                if (population < minPopulation && minPopulation > 0) continue;
-
-                QPointF screenPos = m_camera->geoToScreen(
-                    feature.centroid.x(), feature.centroid.y(), viewW, viewH);
-
-                if (screenPos.x() >= -30 && screenPos.x() <= viewW + 30 &&
-                    screenPos.y() >= -20 && screenPos.y() <= viewH + 20) {
-
-                    QString name = feature.name;
-                    QFontMetrics fm(cityFont);
-                    QRect textRect = fm.boundingRect(name);
-                    textRect.moveCenter(screenPos.toPoint());
-                    textRect.translate(0, -10);  // Offset above the dot
-
-                    // Draw city dot
-                    painter->setPen(Qt::NoPen);
-                    painter->setBrush(Qt::white);
-                    painter->drawEllipse(screenPos, 3, 3);
-
-                    // Outline
-                    painter->setPen(QPen(QColor(0, 0, 0, 150), 2));
-                    painter->drawText(textRect.translated(1, 1), Qt::AlignCenter, name);
-
-                    // Text
-                    painter->setPen(QColor(255, 255, 200));
-                    painter->drawText(textRect, Qt::AlignCenter, name);
-                }
-            }
-        }
-    }
-
-    painter->setOpacity(1.0);
+void MapRenderer::markDirty(int layers) {
+    m_dirtyLayers |= layers;
+    update();
 }
 
 void MapRenderer::setTileProvider(TileProvider* provider) {
@@ -716,36 +84,66 @@ void MapRenderer::setTileProvider(TileProvider* provider) {
         disconnect(m_tileProvider, nullptr, this, nullptr);
     }
     m_tileProvider = provider;
+    m_painter.setTileProvider(provider);
     if (m_tileProvider) {
         connect(m_tileProvider, &TileProvider::tileReady, this, &MapRenderer::onTileReady);
-        connect(m_tileProvider, &TileProvider::currentSourceChanged, this, &MapRenderer::requestUpdate);
+        connect(m_tileProvider, &TileProvider::currentSourceChanged, this, [this]() {
+            markDirty(MapPainter::BaseLayer);
+        });
     }
+    markDirty(MapPainter::BaseLayer);
 }
 
 void MapRenderer::setTileCache(TileCache* cache) {
     m_tileCache = cache;
+    m_painter.setTileCache(cache);
 }
 
 void MapRenderer::setGeoJson(GeoJsonParser* geojson) {
     m_geojson = geojson;
+    m_painter.setFeatures(m_geojson ? m_geojson->features() : QVector<GeoFeature>());
+    if (m_geojson) {
+        // The painter keeps its own shallow copy, detached from later loads
+        connect(m_geojson, &GeoJsonParser::loaded, this, [this]() {
+            m_painter.setFeatures(m_geojson->features());
+            markDirty(MapPainter::AllLayers);
+        });
+    }
+    markDirty(MapPainter::AllLayers);
 }
 
 void MapRenderer::setOverlayManager(OverlayManager* overlays) {
     m_overlays = overlays;
+    m_painter.setOverlayManager(overlays);
+    if (m_overlays) {
+        // Region highlights are overlays too but draw in the base layer
+        connect(m_overlays, &OverlayManager::dataModified, this, [this]() {
+            markDirty(MapPainter::BaseLayer | MapPainter::TopLayer);
+        });
+    }
+    markDirty(MapPainter::BaseLayer | MapPainter::TopLayer);
 }
 
 void MapRenderer::setRegionTrackModel(RegionTrackModel* regionTracks) {
     m_regionTracks = regionTracks;
+    m_painter.setRegionTrackModel(regionTracks);
     if (m_regionTracks) {
-        connect(m_regionTracks, &RegionTrackModel::dataModified, this, &MapRenderer::requestUpdate);
+        connect(m_regionTracks, &RegionTrackModel::dataModified, this, [this]() {
+            markDirty(MapPainter::TimelineLayer);
+        });
     }
+    markDirty(MapPainter::TimelineLayer);
 }
 
 void MapRenderer::setGeoOverlayModel(GeoOverlayModel* geoOverlays) {
     m_geoOverlays = geoOverlays;
+    m_painter.setGeoOverlayModel(geoOverlays);
     if (m_geoOverlays) {
-        connect(m_geoOverlays, &GeoOverlayModel::dataModified, this, &MapRenderer::requestUpdate);
+        connect(m_geoOverlays, &GeoOverlayModel::dataModified, this, [this]() {
+            markDirty(MapPainter::TimelineLayer);
+        });
     }
+    markDirty(MapPainter::TimelineLayer);
 }
 
 void MapRenderer::setCamera(MapCamera* camera) {
@@ -753,12 +151,13 @@ void MapRenderer::setCamera(MapCamera* camera) {
         disconnect(m_camera, nullptr, this, nullptr);
     }
     m_camera = camera;
+    m_painter.setCamera(camera);
     if (m_camera) {
         connect(m_camera, &MapCamera::cameraChanged, this, &MapRenderer::requestUpdate);
         connect(m_camera, &MapCamera::movementSpeedChanged, this, &MapRenderer::onMovementSpeedChanged);
     }
     emit cameraChanged();
-    update();
+    markDirty(MapPainter::AllLayers);
 }
 
 void MapRenderer::onMovementSpeedChanged() {
@@ -776,66 +175,66 @@ void MapRenderer::onMovementSpeedChanged() {
         newOpacity = 1.0 - (speed - SPEED_FADE_START) / (SPEED_FADE_END - SPEED_FADE_START);
     }
 
-    if (!qFuzzyCompare(m_labelOpacity, newOpacity)) {
-        m_labelOpacity = newOpacity;
+    if (!qFuzzyCompare(m_painter.settings().labelOpacity, newOpacity)) {
+        m_painter.settings().labelOpacity = newOpacity;
         emit labelOpacityChanged();
-        update();
+        markDirty(MapPainter::TopLayer);
     }
 }
 
 void MapRenderer::setShowCountryLabels(bool show) {
-    if (m_showCountryLabels != show) {
-        m_showCountryLabels = show;
+    if (m_painter.settings().showCountryLabels != show) {
+        m_painter.settings().showCountryLabels = show;
         emit showCountryLabelsChanged();
-        update();
+        contentChanged(MapPainter::TopLayer);
     }
 }
 
 void MapRenderer::setShowRegionLabels(bool show) {
-    if (m_showRegionLabels != show) {
-        m_showRegionLabels = show;
+    if (m_painter.settings().showRegionLabels != show) {
+        m_painter.settings().showRegionLabels = show;
         emit showRegionLabelsChanged();
-        update();
+        contentChanged(MapPainter::TopLayer);
     }
 }
 
 void MapRenderer::setShowCityLabels(bool show) {
-    if (m_showCityLabels != show) {
-        m_showCityLabels = show;
+    if (m_painter.settings().showCityLabels != show) {
+        m_painter.settings().showCityLabels = show;
         emit showCityLabelsChanged();
-        update();
+        contentChanged(MapPainter::TopLayer);
     }
 }
 
 void MapRenderer::setShadeNonHighlighted(bool shade) {
-    if (m_shadeNonHighlighted != shade) {
-        m_shadeNonHighlighted = shade;
+    if (m_painter.settings().shadeNonHighlighted != shade) {
+        m_painter.settings().shadeNonHighlighted = shade;
         emit shadeNonHighlightedChanged();
-        update();
+        contentChanged(MapPainter::BaseLayer);
     }
 }
 
 void MapRenderer::setNonHighlightedOpacity(double opacity) {
-    if (!qFuzzyCompare(m_nonHighlightedOpacity, opacity)) {
-        m_nonHighlightedOpacity = opacity;
+    if (!qFuzzyCompare(m_painter.settings().nonHighlightedOpacity, opacity)) {
+        m_painter.settings().nonHighlightedOpacity = opacity;
         emit nonHighlightedOpacityChanged();
-        update();
+        contentChanged(MapPainter::BaseLayer);
     }
 }
 
 void MapRenderer::highlightRegion(const QString& regionCode, const QColor& fillColor, const QColor& borderColor) {
-    m_highlights[regionCode] = {fillColor, borderColor};
-    update();
+    m_painter.settings().highlights[regionCode] = {fillColor, borderColor};
+    contentChanged(MapPainter::BaseLayer);
 }
 
 void MapRenderer::clearHighlight(const QString& regionCode) {
-    m_highlights.remove(regionCode);
-    update();
+    m_painter.settings().highlights.remove(regionCode);
+    contentChanged(MapPainter::BaseLayer);
 }
 
 void MapRenderer::clearAllHighlights() {
-    m_highlights.clear();
-    update();
+    m_painter.settings().highlights.clear();
+    contentChanged(MapPainter::BaseLayer);
 }
 
 void MapRenderer::onTileReady(int x, int y, int zoom, const QImage& image) {
@@ -843,60 +242,43 @@ void MapRenderer::onTileReady(int x, int y, int zoom, const QImage& image) {
     if (m_tileCache && m_tileProvider) {
         m_tileCache->insert(m_tileProvider->currentSource(), x, y, zoom, image);
     }
-    update();
+    markDirty(MapPainter::BaseLayer);
 }
 
 void MapRenderer::requestUpdate() {
-    update();
+    markDirty(MapPainter::AllLayers);
 }
 
 QImage MapRenderer::renderToImage(int targetWidth, int targetHeight) {
-    QImage image(targetWidth, targetHeight, QImage::Format_ARGB32);
-    image.fill(Qt::black);
-
-    QPainter painter(&image);
-    painter.setRenderHint(QPainter::Antialiasing);
-    painter.setRenderHint(QPainter::SmoothPixmapTransform);
-
-    // Temporarily disable frame buffer to avoid recursion
-    bool wasUsingFrameBuffer = m_useFrameBuffer;
-    m_useFrameBuffer = false;
-
-    // Temporarily adjust for target size
-    double scaleX = static_cast<double>(targetWidth) / width();
-    double scaleY = static_cast<double>(targetHeight) / height();
-    painter.scale(scaleX, scaleY);
-
-    // Render all layers directly (not using paint() to avoid signals)
-    painter.save();
-    applyTransforms(&painter);
-    renderTiles(&painter);
-    renderCountryBorders(&painter);
-    renderHighlights(&painter);
-    renderCityMarkers(&painter);
-    renderOverlays(&painter, m_currentAnimationTime);
-    renderLabels(&painter);
-    resetTransforms(&painter);
-    painter.restore();
-
-    // Restore frame buffer setting
-    m_useFrameBuffer = wasUsingFrameBuffer;
-
-    return image;
+    return m_painter.renderToImage(targetWidth, targetHeight);
+}
+
+QByteArray MapRenderer::frameSignature(int targetWidth, int targetHeight) const {
+    return m_painter.frameSignature(targetWidth, targetHeight);
+}
+
+void MapRenderer::requestVisibleTiles() {
+    m_painter.requestVisibleTiles();
+}
+
+bool MapRenderer::visibleTilesCached() const {
+    return m_painter.visibleTilesCached();
 }
 
 void MapRenderer::setCurrentAnimationTime(double timeMs) {
-    if (!qFuzzyCompare(m_currentAnimationTime, timeMs)) {
-        m_currentAnimationTime = timeMs;
+    if (!qFuzzyCompare(m_painter.currentTime(), timeMs)) {
+        m_painter.setCurrentTime(timeMs);
         emit currentAnimationTimeChanged();
-        update();
+        // Overlays are the only time-dependent part of the top layer
+        markDirty(m_overlays && m_overlays->count() > 0 ? MapPainter::TimelineLayer | MapPainter::TopLayer : MapPainter::TimelineLayer);
     }
 }
 
 void MapRenderer::setTotalDuration(double durationMs) {
-    if (!qFuzzyCompare(m_totalDuration, durationMs)) {
-        m_totalDuration = durationMs;
+    if (!qFuzzyCompare(m_painter.totalDuration(), durationMs)) {
+        m_painter.setTotalDuration(durationMs);
         emit totalDurationChanged();
+        markDirty(MapPainter::TimelineLayer);
     }
 }
 
@@ -915,121 +297,61 @@ void MapRenderer::setUseFrameBuffer(bool use) {
     }
 }
 
-void MapRenderer::setShowCountryBorders(bool show) {
-    if (m_showCountryBorders != show) {
-        m_showCountryBorders = show;
-        emit showCountryBordersChanged();
+void MapRenderer::setTimelinePlaying(bool playing) {
+    if (m_timelinePlaying != playing) {
+        m_timelinePlaying = playing;
         update();
     }
 }
 
-void MapRenderer::setShowCityMarkers(bool show) {
-    if (m_showCityMarkers != show) {
-        m_showCityMarkers = show;
-        emit showCityMarkersChanged();
-        update();
+void MapRenderer::contentChanged(int layers) {
+    // Anything that changes how the timeline looks outdates the buffered frames
+    if (m_frameBuffer) {
+        m_frameBuffer->invalidate();
     }
+    markDirty(layers);
 }
 
-void MapRenderer::renderCountryBorders(QPainter* painter) {
-    if (!m_showCountryBorders || !m_camera || !m_geojson || !m_geojson->isLoaded()) return;
-
-    double viewW = width();
-    double viewH = height();
-    if (viewW <= 0 || viewH <= 0) return;
-
-    // Border colors
-    QColor borderColor(255, 255, 255, 120);  // White semi-transparent
-    QColor selectedBorderColor(255, 220, 0, 255);  // Yellow for selected
-
-    painter->setBrush(Qt::NoBrush);
+RenderSnapshot MapRenderer::captureSnapshot() const {
+    const MapPainter::Settings& settings = m_painter.settings();
+    RenderSnapshot snapshot;
+    snapshot.width = static_cast<int>(width());
+    snapshot.height = static_cast<int>(height());
+    snapshot.totalDuration = m_painter.totalDuration();
+    snapshot.tileSource = m_painter.tileSource();
+    snapshot.features = m_painter.features();
 
-    for (const auto& feature : m_geojson->features()) {
-        if (feature.type != "country") continue;
+    snapshot.showCountryLabels = settings.showCountryLabels;
+    snapshot.showRegionLabels = settings.showRegionLabels;
+    snapshot.showCityLabels = settings.showCityLabels;
+    snapshot.showCountryBorders = settings.showCountryBorders;
+    snapshot.showCityMarkers = settings.showCityMarkers;
+    snapshot.shadeNonHighlighted = settings.shadeNonHighlighted;
+    snapshot.nonHighlightedOpacity = settings.nonHighlightedOpacity;
+    snapshot.labelOpacity = settings.labelOpacity;
 
-        bool isSelected = (m_selectedFeatureType == "country" && feature.code == m_selectedFeatureCode);
-
-        if (isSelected) {
-            painter->setPen(QPen(selectedBorderColor, 3.0));
-        } else {
-            painter->setPen(QPen(borderColor, 1.0));
-        }
-
-        for (const QPolygonF& geoPoly : feature.polygons) {
-            QPolygonF screenPoly;
-            screenPoly.reserve(geoPoly.size());
-
-            for (const QPointF& geoPoint : geoPoly) {
-                QPointF screenPoint = m_camera->geoToScreen(geoPoint.x(), geoPoint.y(), viewW, viewH);
-                screenPoly.append(screenPoint);
-            }
-
-            if (!screenPoly.isEmpty()) {
-                painter->drawPolygon(screenPoly);
-            }
-        }
+    for (auto it = settings.highlights.constBegin(); it != settings.highlights.constEnd(); ++it) {
+        snapshot.highlights.insert(it.key(), {it.value().fillColor, it.value().borderColor});
     }
+    snapshot.selectedFeatureCode = settings.selectedFeatureCode;
+    snapshot.selectedFeatureName = settings.selectedFeatureName;
+    snapshot.selectedFeatureType = settings.selectedFeatureType;
+    return snapshot;
 }
 
-void MapRenderer::renderCityMarkers(QPainter* painter) {
-    if (!m_showCityMarkers || !m_camera || !m_geojson || !m_geojson->isLoaded()) return;
-
-    double viewW = width();
-    double viewH = height();
-    if (viewW <= 0 || viewH <= 0) return;
-
-    double zoom = m_camera->zoom();
-
-    // Filter cities by zoom level
-    int minPopulation = 0;
-    if (zoom < 5) minPopulation = 5000000;
-    else if (zoom < 7) minPopulation = 1000000;
-    else if (zoom < 9) minPopulation = 500000;
-    else if (zoom < 11) minPopulation = 100000;
-    else minPopulation = 50000;
-
-    QColor markerColor(255, 100, 100, 200);
-    QColor selectedMarkerColor(255, 220, 0, 255);
-    QColor textColor(255, 255, 255, 220);
-
-    QFont cityFont("Arial", 10);
-    painter->setFont(cityFont);
-
-    for (const auto& feature : m_geojson->features()) {
-        if (feature.type != "city") continue;
-
-        int population = feature.properties.value("population", 0).toInt();
-        if (population < minPopulation) continue;
-
-        QPointF screenPos = m_camera->geoToScreen(feature.centroid.x(), feature.centroid.y(), viewW, viewH);
-
-        // Skip if off screen
-        if (screenPos.x() < -20 || screenPos.x() > viewW + 20 ||
-            screenPos.y() < -20 || screenPos.y() > viewH + 20) continue;
-
-        bool isSelected = (m_selectedFeatureType == "city" && feature.name == m_selectedFeatureName);
-
-        // Draw marker circle
-        double markerSize = isSelected ? 8 : 5;
-        painter->setPen(Qt::NoPen);
-        painter->setBrush(isSelected ? selectedMarkerColor : markerColor);
-        painter->drawEllipse(screenPos, markerSize, markerSize);
-
-        // Draw city name
-        if (zoom >= 6) {
-            QString name = feature.name;
-            QFontMetrics fm(cityFont);
-            QRect textRect = fm.boundingRect(name);
-            textRect.moveCenter(QPoint(static_cast<int>(screenPos.x()), static_cast<int>(screenPos.y()) - 15));
-
-            // Text outline
-            painter->setPen(QPen(QColor(0, 0, 0, 180), 2));
-            painter->drawText(textRect.translated(1, 1), Qt::AlignCenter, name);
+void MapRenderer::setShowCountryBorders(bool show) {
+    if (m_painter.settings().showCountryBorders != show) {
+        m_painter.settings().showCountryBorders = show;
+        emit showCountryBordersChanged();
+        contentChanged(MapPainter::BaseLayer);
+    }
+}
 
-            // Text
-            painter->setPen(isSelected ? selectedMarkerColor : textColor);
-            painter->drawText(textRect, Qt::AlignCenter, name);
-        }
+void MapRenderer::setShowCityMarkers(bool show) {
+    if (m_painter.settings().showCityMarkers != show) {
+        m_painter.settings().showCityMarkers = show;
+        emit showCityMarkersChanged();
+        contentChanged(MapPainter::TopLayer);
     }
 }
 
@@ -1043,8 +365,10 @@ QString MapRenderer::hitTestCountry(double screenX, double screenY) {
     for (const auto& feature : m_geojson->features()) {
         if (feature.type != "country") continue;
 
-        for (const QPolygonF& poly : feature.polygons) {
-            if (pointInPolygon(poly, lat, lon)) {
+        if (!feature.bounds.contains(lat, lon)) continue;
+        for (int i = 0; i < feature.polygons.size(); ++i) {
+            if (!feature.polygonBounds[i].contains(lat, lon)) continue;
+            if (pointInPolygon(feature.polygons[i], lat, lon)) {
                 return feature.code;
             }
         }
@@ -1089,12 +413,12 @@ void MapRenderer::selectFeatureAt(double screenX, double screenY) {
         // Find the city feature
         for (const auto& feature : m_geojson->features()) {
             if (feature.type == "city" && feature.name == cityName) {
-                m_selectedFeatureCode = feature.code;
-                m_selectedFeatureName = feature.name;
-                m_selectedFeatureType = "city";
+                m_painter.settings().selectedFeatureCode = feature.code;
+                m_painter.settings().selectedFeatureName = feature.name;
+                m_painter.settings().selectedFeatureType = "city";
                 emit selectedFeatureChanged();
                 emit featureClicked(feature.code, feature.name, "city");
-                update();
+                contentChanged(MapPainter::AllLayers);
                 return;
             }
         }
@@ -1105,12 +429,12 @@ void MapRenderer::selectFeatureAt(double screenX, double screenY) {
     if (!countryCode.isEmpty()) {
         const GeoFeature* feature = m_geojson->findByCode(countryCode);
         if (feature) {
-            m_selectedFeatureCode = countryCode;
-            m_selectedFeatureName = feature->name;
-            m_selectedFeatureType = "country";
+            m_painter.settings().selectedFeatureCode = countryCode;
+            m_painter.settings().selectedFeatureName = feature->name;
+            m_painter.settings().selectedFeatureType = "country";
             emit selectedFeatureChanged();
             emit featureClicked(countryCode, feature->name, "country");
-            update();
+            contentChanged(MapPainter::AllLayers);
             return;
         }
     }
@@ -1120,17 +444,17 @@ void MapRenderer::selectFeatureAt(double screenX, double screenY) {
 }
 
 void MapRenderer::clearSelection() {
-    if (!m_selectedFeatureCode.isEmpty() || !m_selectedFeatureName.isEmpty()) {
-        m_selectedFeatureCode.clear();
-        m_selectedFeatureName.clear();
-        m_selectedFeatureType.clear();
+    if (!m_painter.settings().selectedFeatureCode.isEmpty() || !m_painter.settings().selectedFeatureName.isEmpty()) {
+        m_painter.settings().selectedFeatureCode.clear();
+        m_painter.settings().selectedFeatureName.clear();
+        m_painter.settings().selectedFeatureType.clear();
         emit selectedFeatureChanged();
-        update();
+        contentChanged(MapPainter::AllLayers);
     }
 }
 
 void MapRenderer::toggleFeatureHighlight(const QString& code, const QColor& fillColor, const QColor& borderColor) {
-    if (m_highlights.contains(code)) {
+    if (m_painter.settings().highlights.contains(code)) {
         clearHighlight(code);
     } else {
         highlightRegion(code, fillColor, borderColor);
@@ -1138,24 +462,24 @@ void MapRenderer::toggleFeatureHighlight(const QString& code, const QColor& fill
 }
 
 void MapRenderer::frameSelectedFeature() {
-    if (!m_camera || !m_geojson || m_selectedFeatureName.isEmpty()) {
+    if (!m_camera || !m_geojson || m_painter.settings().selectedFeatureName.isEmpty()) {
         return;
     }
 
     // Find the feature
     const GeoFeature* feature = nullptr;
-    if (!m_selectedFeatureCode.isEmpty()) {
-        feature = m_geojson->findByCode(m_selectedFeatureCode);
+    if (!m_painter.settings().selectedFeatureCode.isEmpty()) {
+        feature = m_geojson->findByCode(m_painter.settings().selectedFeatureCode);
     }
     if (!feature) {
-        feature = m_geojson->findByName(m_selectedFeatureName);
+        feature = m_geojson->findByName(m_painter.settings().selectedFeatureName);
     }
     if (!feature) {
         return;
     }
 
     // For cities, just center on the point with a reasonable zoom
-    if (m_selectedFeatureType == "city") {
+    if (m_painter.settings().selectedFeatureType == "city") {
         m_camera->setPosition(feature->centroid.y(), feature->centroid.x(), 10.0,
                               m_camera->bearing(), m_camera->tilt());
         return;
@@ -1169,21 +493,13 @@ void MapRenderer::frameSelectedFeature() {
         return;
     }
 
-    // Calculate bounding box (polygons store lat in x, lon in y)
-    double minLat = 90.0, maxLat = -90.0;
-    double minLon = 180.0, maxLon = -180.0;
-
-    for (const auto& polygon : feature->polygons) {
-        for (const auto& point : polygon) {
-            // point.x() = lat, point.y() = lon (based on coordinate system used)
-            double lat = point.x();
-            double lon = point.y();
-            minLat = qMin(minLat, lat);
-            maxLat = qMax(maxLat, lat);
-            minLon = qMin(minLon, lon);
-            maxLon = qMax(maxLon, lon);
-        }
-    }
+    // Bounds of the main parts only, so overseas territories and small
+    // exclaves don't zoom the view out to half the globe (lat in x, lon in y)
+    const QRectF& bounds = feature->mainBounds;
+    double minLat = bounds.left();
+    double maxLat = bounds.right();
+    double minLon = bounds.top();
+    double maxLon = bounds.bottom();
 
     // Calculate center
     double centerLat = (minLat + maxLat) / 2.0;
@@ -4,6 +4,7 @@
 #include <QImage>
 #include <QHash>
 #include <QColor>
+#include "mappainter.h"
 
 class TileProvider;
 class TileCache;
@@ -13,7 +14,7 @@ class OverlayManager;
 class RegionTrackModel;
 class GeoOverlayModel;
 class FrameBuffer;
-struct GeoFeature;
+struct RenderSnapshot;
 
 class MapRenderer : public QQuickPaintedItem {
     Q_OBJECT
@@ -49,28 +50,28 @@ public:
     MapCamera* camera() const { return m_camera; }
     void setCamera(MapCamera* camera);
 
-    bool showCountryLabels() const { return m_showCountryLabels; }
+    bool showCountryLabels() const { return m_painter.settings().showCountryLabels; }
     void setShowCountryLabels(bool show);
 
-    bool showRegionLabels() const { return m_showRegionLabels; }
+    bool showRegionLabels() const { return m_painter.settings().showRegionLabels; }
     void setShowRegionLabels(bool show);
 
-    bool showCityLabels() const { return m_showCityLabels; }
+    bool showCityLabels() const { return m_painter.settings().showCityLabels; }
     void setShowCityLabels(bool show);
 
-    double labelOpacity() const { return m_labelOpacity; }
+    double labelOpacity() const { return m_painter.settings().labelOpacity; }
 
-    bool shadeNonHighlighted() const { return m_shadeNonHighlighted; }
+    bool shadeNonHighlighted() const { return m_painter.settings().shadeNonHighlighted; }
     void setShadeNonHighlighted(bool shade);
 
-    double nonHighlightedOpacity() const { return m_nonHighlightedOpacity; }
+    double nonHighlightedOpacity() const { return m_painter.settings().nonHighlightedOpacity; }
     void setNonHighlightedOpacity(double opacity);
 
     // Animation time for frame buffering
-    double currentAnimationTime() const { return m_currentAnimationTime; }
+    double currentAnimationTime() const { return m_painter.currentTime(); }
     void setCurrentAnimationTime(double timeMs);
 
-    double totalDuration() const { return m_totalDuration; }
+    double totalDuration() const { return m_painter.totalDuration(); }
     void setTotalDuration(double durationMs);
 
     // Frame buffer for caching rendered frames
@@ -79,16 +80,28 @@ public:
     bool useFrameBuffer() const { return m_useFrameBuffer; }
     void setUseFrameBuffer(bool use);
 
+    // Buffered frames stand in for rendering only while the camera follows
+    // the timeline, never while the view is moved by hand
+    void setTimelinePlaying(bool playing);
+
+    // Renderer state for offscreen rendering on a worker thread, applied
+    // there with MapPainter::applySnapshot(). The caller adds the timeline
+    // and model copies.
+    RenderSnapshot captureSnapshot() const;
+
+    // True when every tile the current view needs is in the memory or disk cache
+    bool visibleTilesCached() const;
+
     // Country/region highlighting
     Q_INVOKABLE void highlightRegion(const QString& regionCode, const QColor& fillColor, const QColor& borderColor = Qt::transparent);
     Q_INVOKABLE void clearHighlight(const QString& regionCode);
     Q_INVOKABLE void clearAllHighlights();
 
     // Interactive overlays
-    bool showCountryBorders() const { return m_showCountryBorders; }
+    bool showCountryBorders() const { return m_painter.settings().showCountryBorders; }
     void setShowCountryBorders(bool show);
 
-    bool showCityMarkers() const { return m_showCityMarkers; }
+    bool showCityMarkers() const { return m_painter.settings().showCityMarkers; }
     void setShowCityMarkers(bool show);
 
     // Hit testing and selection
@@ -99,13 +112,23 @@ public:
     Q_INVOKABLE void toggleFeatureHighlight(const QString& code, const QColor& fillColor, const QColor& borderColor);
     Q_INVOKABLE void frameSelectedFeature();
 
-    QString selectedFeatureCode() const { return m_selectedFeatureCode; }
-    QString selectedFeatureName() const { return m_selectedFeatureName; }
-    QString selectedFeatureType() const { return m_selectedFeatureType; }
+    QString selectedFeatureCode() const { return m_painter.settings().selectedFeatureCode; }
+    QString selectedFeatureName() const { return m_painter.settings().selectedFeatureName; }
+    QString selectedFeatureType() const { return m_painter.settings().selectedFeatureType; }
 
     // Render to image for export
     QImage renderToImage(int width, int height);
 
+    // Hash of every input that affects renderToImage() at the current time.
+    // Equal signatures mean identical frames, so exports can reuse them.
+    QByteArray frameSignature(int width, int height) const;
+
+    // Styling every frame depends on; see MapPainter::settingsSignature()
+    QByteArray settingsSignature() const { return m_painter.settingsSignature(); }
+
+    // Request any uncached tiles for the current view (used to prefetch before export)
+    void requestVisibleTiles();
+
 signals:
     void cameraChanged();
     void showCountryLabelsChanged();
@@ -130,21 +153,24 @@ public slots:
 private slots:
     void onMovementSpeedChanged();
 
+protected:
+    void geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry) override;
+
 private:
-    void renderTiles(QPainter* painter);
-    bool tryRenderFallbackTile(QPainter* painter, int tx, int ty, int targetZoom,
-                               double screenX, double screenY, double tileSize, int source);
-    void renderHighlights(QPainter* painter);
-    void renderRegionTracks(QPainter* painter, double currentTime, double totalDuration);
-    void renderGeoOverlays(QPainter* painter, double currentTime, double totalDuration);
-    void renderCountryBorders(QPainter* painter);
-    void renderCityMarkers(QPainter* painter);
-    void renderOverlays(QPainter* painter, double currentTime);
-    void renderLabels(QPainter* painter);
-    void applyTransforms(QPainter* painter);
-    void resetTransforms(QPainter* painter);
+    // paint() keeps one cached surface per layer and redraws a layer only
+    // when something it depends on changed; the rest is compositing
+    static constexpr int LAYER_COUNT = 3;
+
+    void markDirty(int layers);
+    void contentChanged(int layers);
     bool pointInPolygon(const QPolygonF& polygon, double lat, double lon) const;
 
+    // Draws the view and exports; owns the label and overlay caches
+    MapPainter m_painter;
+
+    QImage m_layerImages[LAYER_COUNT];
+    int m_dirtyLayers = MapPainter::AllLayers;
+
     TileProvider* m_tileProvider = nullptr;
     TileCache* m_tileCache = nullptr;
     MapCamera* m_camera = nullptr;
@@ -154,30 +180,10 @@ private:
     GeoOverlayModel* m_geoOverlays = nullptr;
     FrameBuffer* m_frameBuffer = nullptr;
 
-    bool m_showCountryLabels = false;
-    bool m_showRegionLabels = false;
-    bool m_showCityLabels = false;
-    double m_labelOpacity = 1.0;
-    bool m_shadeNonHighlighted = false;
-    double m_nonHighlightedOpacity = 0.3;
-    double m_currentAnimationTime = 0.0;
-    double m_totalDuration = 0.0;
     bool m_useFrameBuffer = true;
-    bool m_showCountryBorders = false;
-    bool m_showCityMarkers = false;
-    QString m_selectedFeatureCode;
-    QString m_selectedFeatureName;
-    QString m_selectedFeatureType;
+    bool m_timelinePlaying = false;
 
     // Speed thresholds for label fading
     static constexpr double SPEED_FADE_START = 5.0;   // Start fading at this speed
     static constexpr double SPEED_FADE_END = 50.0;    // Fully faded at this speed
-
-    struct HighlightStyle {
-        QColor fillColor;
-        QColor borderColor;
-    };
-    QHash<QString, HighlightStyle> m_highlights;
-
-    static constexpr int TILE_SIZE = 256;
 };
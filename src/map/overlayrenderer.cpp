@@ -0,0 +1,490 @@
+#include "overlayrenderer.h"
+#include "mapcamera.h"
+#include "../overlays/overlay.h"
+#include "../overlays/arrowoverlay.h"
+#include "../overlays/markeroverlay.h"
+#include "../overlays/textoverlay.h"
+#include <QFont>
+#include <QImageReader>
+#include <QPainter>
+#include <QPainterPath>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+
+void OverlayRenderer::render(QPainter* painter, const QVector<Overlay*>& overlays, double timeMs,
+                             const MapCamera& camera, const QSizeF& viewSize, qreal pixelRatio) {
+    m_frame++;
+
+    if (!qFuzzyCompare(m_pixelRatio, pixelRatio)) {
+        m_pixelRatio = pixelRatio;
+        m_iconAtlas.clear();
+        m_iconSlots.clear();
+    }
+    if (m_iconAtlas.overBudget()) {
+        m_iconAtlas.clear();
+        m_iconSlots.clear();
+    }
+    m_text.setDevicePixelRatio(pixelRatio);
+
+    // Rotation and tilt are applied by the painter, so more of the map than
+    // the unrotated viewport can show
+    double margin = CULL_MARGIN;
+    if (camera.bearing() != 0.0 || camera.tilt() > 0.0) {
+        margin += qMax(viewSize.width(), viewSize.height());
+    }
+    const QRectF visible = QRectF(QPointF(0, 0), viewSize).adjusted(-margin, -margin, margin, margin);
+
+    // World to screen is a scale and an offset
+    const double worldScale = camera.worldScale();
+    const QPointF origin = camera.worldToScreen(QPointF(0, 0), viewSize.width(), viewSize.height());
+    const QTransform worldToScreen(worldScale, 0, 0, worldScale, origin.x(), origin.y());
+    const QRectF visibleWorld = worldToScreen.inverted().mapRect(visible);
+
+    // Arrows are flattened for the deepest zoom of the integer level, so
+    // the polyline stays within tolerance until the next level is reached
+    ArrowView arrowView;
+    arrowView.visibleWorld = visibleWorld;
+    arrowView.worldScale = worldScale;
+    arrowView.zoomBucket = static_cast<int>(std::floor(camera.zoom()));
+    arrowView.tolerance = FLATTEN_TOLERANCE_PX / (worldScale * std::pow(2.0, arrowView.zoomBucket + 1 - camera.zoom()));
+
+    QVector<Stroke> strokes;
+    QVector<Icon> icons;
+    QVector<LabelEngine::Candidate> texts;
+    QVector<LabelEngine::Style> textStyles;
+    int arrowCount = 0;
+
+    for (int i = 0; i < overlays.size(); ++i) {
+        const Overlay* overlay = overlays[i];
+        if (overlay->opacity() <= 0.0) continue;
+
+        switch (overlay->type()) {
+        case OverlayType::Arrow:
+            addArrow(static_cast<const ArrowOverlay*>(overlay), timeMs, arrowView, strokes);
+            arrowCount++;
+            break;
+
+        case OverlayType::Marker: {
+            auto* marker = static_cast<const MarkerOverlay*>(overlay);
+            QPointF pos = camera.geoToScreen(marker->latitude(), marker->longitude(),
+                                             viewSize.width(), viewSize.height());
+            if (!visible.contains(pos)) break;
+
+            const double side = MARKER_ICON_SIZE * marker->iconScale();
+            QSize pixels(qCeil(side * m_pixelRatio), qCeil(side * m_pixelRatio));
+            icons.append({iconSlot(marker, pixels), QSizeF(side, side), overlay->opacity(), pos});
+
+            if (!marker->label().isEmpty()) {
+                LabelEngine::Style style;
+                style.pixelSize = 13;
+                style.weight = QFont::Bold;
+                textStyles.append(style);
+                QSizeF size = m_text.labelSize(marker->label(), style);
+                texts.append({static_cast<quint64>(i), marker->label(), textStyles.size() - 1, pos,
+                              QPointF(0, -side - size.height() / 2.0), 0.0, overlay->opacity(), true});
+            }
+            break;
+        }
+
+        case OverlayType::Text: {
+            auto* text = static_cast<const TextOverlay*>(overlay);
+            if (text->text().isEmpty()) break;
+            QPointF pos = camera.geoToScreen(text->latitude(), text->longitude(),
+                                             viewSize.width(), viewSize.height());
+            if (!visible.contains(pos)) break;
+
+            LabelEngine::Style style;
+            style.pixelSize = qRound(text->fontSize() * 4.0 / 3.0);
+            style.weight = text->isBold() ? QFont::Bold : QFont::Normal;
+            style.color = text->color();
+            style.background = text->backgroundColor();
+            if (style.background.alpha() > 0) style.outlineWidth = 0;
+            textStyles.append(style);
+
+            // Alignment is relative to the anchor: "left" starts the text there
+            QPointF offset;
+            QSizeF size = m_text.labelSize(text->text(), style);
+            if (text->alignment() == "left") offset.setX(size.width() / 2.0);
+            else if (text->alignment() == "right") offset.setX(-size.width() / 2.0);
+
+            texts.append({static_cast<quint64>(i), text->text(), textStyles.size() - 1, pos, offset,
+                          0.0, overlay->opacity(), true});
+            break;
+        }
+
+        case OverlayType::RegionHighlight:
+            break;  // Drawn with the highlights in renderHighlights()
+        }
+    }
+
+    // Arrows under markers under text
+    drawStrokes(painter, strokes, worldToScreen);
+
+    std::stable_sort(icons.begin(), icons.end(), [](const Icon& a, const Icon& b) {
+        return a.slot.page < b.slot.page;
+    });
+    const double baseOpacity = painter->opacity();
+    for (const Icon& icon : icons) {
+        painter->setOpacity(baseOpacity * icon.opacity);
+        QRectF target(icon.anchor.x() - icon.size.width() / 2.0, icon.anchor.y() - icon.size.height(),
+                      icon.size.width(), icon.size.height());
+        painter->drawImage(target, m_iconAtlas.page(icon.slot.page), QRectF(icon.slot.rect));
+    }
+    painter->setOpacity(baseOpacity);
+
+    // Text overlays are always placed, so the engine draws them in list
+    // order with later ones on top
+    LabelEngine::View view;
+    view.size = viewSize;
+    view.allowReuse = false;
+    m_text.layout(texts, textStyles, view);
+    m_text.draw(painter);
+
+    // Forget curves of overlays that left the view or were edited away
+    if (m_arrowPaths.size() > arrowCount + PATH_CACHE_SLACK) {
+        for (auto it = m_arrowPaths.begin(); it != m_arrowPaths.end();) {
+            if (it->lastUse != m_frame) it = m_arrowPaths.erase(it);
+            else ++it;
+        }
+    }
+}
+
+size_t OverlayRenderer::arrowKey(const ArrowOverlay* arrow) {
+    size_t key = qHashMulti(0, arrow->startLat(), arrow->startLon(), arrow->endLat(), arrow->endLon(),
+                            arrow->pathType());
+    for (const BezierControlPoint& cp : arrow->bezierPoints()) {
+        key = qHashMulti(key, cp.latitude, cp.longitude);
+    }
+    return key;
+}
+
+QPointF OverlayRenderer::worldAt(const ArrowOverlay* arrow, double t, double referenceX) {
+    // Shifted by whole worlds to within half a world of the reference, so
+    // a curve crossing the antimeridian stays continuous
+    const QPointF p = arrow->pointAtT(t);
+    QPointF world = MapCamera::geoToWorld(qBound(-MAX_LATITUDE, p.x(), MAX_LATITUDE), p.y());
+    world.rx() += std::round(referenceX - world.x());
+    return world;
+}
+
+void OverlayRenderer::flatten(const ArrowOverlay* arrow, double t0, const QPointF& p0, double t1,
+                              const QPointF& p1, double tolerance, int depth, QVector<QPointF>& out) {
+    // Split while the curve midpoint strays from the chord; flat stretches
+    // stay one segment, tight bends get as many as they need
+    const double tm = (t0 + t1) / 2.0;
+    const QPointF pm = worldAt(arrow, tm, p0.x());
+    const QPointF chordMid = (p0 + p1) / 2.0;
+    const double deviation = std::hypot(pm.x() - chordMid.x(), pm.y() - chordMid.y());
+
+    if (depth < FLATTEN_MAX_DEPTH && deviation > tolerance) {
+        flatten(arrow, t0, p0, tm, pm, tolerance, depth + 1, out);
+        flatten(arrow, tm, pm, t1, p1, tolerance, depth + 1, out);
+        return;
+    }
+    out.append(p1);
+}
+
+OverlayRenderer::ArrowPath& OverlayRenderer::arrowPath(const ArrowOverlay* arrow, const ArrowView& view) {
+    const size_t key = qHashMulti(arrowKey(arrow), view.zoomBucket);
+    ArrowPath& path = m_arrowPaths[arrow->id()];
+    path.lastUse = m_frame;
+    if (path.key == key && !path.points.isEmpty()) return path;
+
+    path = ArrowPath();
+    path.key = key;
+    path.lastUse = m_frame;
+
+    if (!arrow->isGeodesic() && arrow->bezierPoints().isEmpty()) {
+        // Plain lat/lon line from one end to the other, the long way round
+        // if that's what the coordinates say
+        path.points << MapCamera::geoToWorld(arrow->startLat(), arrow->startLon())
+                    << MapCamera::geoToWorld(arrow->endLat(), arrow->endLon());
+    } else {
+        // Screen-space tolerance, so a continental route and a city-scale
+        // arrow are equally smooth and neither has more vertices than the
+        // zoom can show
+        QPointF previous = worldAt(arrow, 0.0, 0.5);
+        path.points.append(previous);
+        for (int i = 1; i <= FLATTEN_SEGMENTS; ++i) {
+            const double t = static_cast<double>(i) / FLATTEN_SEGMENTS;
+            const QPointF next = worldAt(arrow, t, previous.x());
+            flatten(arrow, static_cast<double>(i - 1) / FLATTEN_SEGMENTS, previous, t, next,
+                    view.tolerance, 0, path.points);
+            previous = next;
+        }
+    }
+
+    // Arc length in world units is proportional to on-screen length, so the
+    // reveal moves at constant speed whatever the curve's parametrisation
+    path.lengths.reserve(path.points.size());
+    path.lengths.append(0.0);
+    for (int i = 1; i < path.points.size(); ++i) {
+        const QPointF d = path.points[i] - path.points[i - 1];
+        path.lengths.append(path.lengths.last() + std::hypot(d.x(), d.y()));
+    }
+    // Padded so a straight east-west or north-south arrow isn't an empty
+    // rectangle that intersects nothing
+    path.bounds = path.points.boundingRect().adjusted(-1e-9, -1e-9, 1e-9, 1e-9);
+    return path;
+}
+
+void OverlayRenderer::appendWrapped(const QPolygonF& line, QVector<QPolygonF>& out) {
+    if (line.isEmpty()) return;
+
+    // The map shows one world, x in [0, 1). Each stretch of the unwrapped
+    // line is moved into it, and a segment leaving through an edge ends
+    // there and continues from the opposite edge.
+    double copy = std::floor(line.first().x());
+    QPolygonF piece;
+    piece.append(line.first() - QPointF(copy, 0.0));
+    for (int i = 1; i < line.size(); ++i) {
+        const QPointF& a = line[i - 1];
+        const QPointF& b = line[i];
+        const double target = std::floor(b.x());
+        while (copy != target) {
+            const bool east = target > copy;
+            const double edge = east ? copy + 1.0 : copy;
+            const double y = a.y() + (b.y() - a.y()) * (edge - a.x()) / (b.x() - a.x());
+            piece.append(QPointF(edge - copy, y));
+            out.append(piece);
+            piece.clear();
+            copy += east ? 1.0 : -1.0;
+            piece.append(QPointF(edge - copy, y));
+        }
+        piece.append(b - QPointF(copy, 0.0));
+    }
+    out.append(piece);
+}
+
+QPointF OverlayRenderer::pointAtLength(const ArrowPath& path, double s) {
+    if (s <= 0.0) return path.points.first();
+    if (s >= path.length()) return path.points.last();
+
+    // First vertex past s; the point lies on the segment leading to it
+    auto it = std::upper_bound(path.lengths.begin(), path.lengths.end(), s);
+    const int i = static_cast<int>(it - path.lengths.begin());
+    const double segment = path.lengths[i] - path.lengths[i - 1];
+    const double f = segment > 0.0 ? (s - path.lengths[i - 1]) / segment : 0.0;
+    return path.points[i - 1] + (path.points[i] - path.points[i - 1]) * f;
+}
+
+void OverlayRenderer::appendSpan(const ArrowPath& path, double from, double to, QPolygonF& out) {
+    out.append(pointAtLength(path, from));
+    auto it = std::upper_bound(path.lengths.begin(), path.lengths.end(), from);
+    for (int i = static_cast<int>(it - path.lengths.begin()); i < path.points.size() && path.lengths[i] < to; ++i) {
+        out.append(path.points[i]);
+    }
+    out.append(pointAtLength(path, to));
+}
+
+const QVector<OverlayRenderer::Dash>& OverlayRenderer::dashes(ArrowPath& path, double on, double off) {
+    // Same pattern as last frame unless the zoom or stroke width changed
+    if (!path.dashes.isEmpty() && qFuzzyCompare(path.dashOn, on) && qFuzzyCompare(path.dashOff, off)) {
+        return path.dashes;
+    }
+
+    path.dashOn = on;
+    path.dashOff = off;
+    path.dashes.clear();
+    const double period = on + off;
+    if (period <= 0.0 || path.length() / period > MAX_DASHES) return path.dashes;
+
+    // Anchored at the arrow's start, so dashes stay put while it grows
+    for (double start = 0.0; start < path.length(); start += period) {
+        Dash dash{start, qMin(start + on, path.length()), QPolygonF()};
+        appendSpan(path, dash.start, dash.end, dash.points);
+        path.dashes.append(dash);
+    }
+    return path.dashes;
+}
+
+void OverlayRenderer::addArrow(const ArrowOverlay* arrow, double timeMs, const ArrowView& view,
+                               QVector<Stroke>& strokes) {
+    const double progress = arrow->animationProgress(timeMs);
+    if (progress <= 0.0) return;
+
+    ArrowPath& path = arrowPath(arrow, view);
+    if (path.points.size() < 2) return;
+
+    // A path reaching past the antimeridian shows partly at the other side
+    const bool wraps = path.bounds.left() < 0.0 || path.bounds.right() > 1.0;
+    if (!path.bounds.intersects(view.visibleWorld) &&
+        !(wraps && (path.bounds.translated(-1.0, 0.0).intersects(view.visibleWorld) ||
+                    path.bounds.translated(1.0, 0.0).intersects(view.visibleWorld)))) {
+        return;
+    }
+    const double worldScale = view.worldScale;
+
+    QColor color = arrow->color();
+    color.setAlphaF(color.alphaF() * arrow->opacity());
+    const double width = arrow->strokeWidth();
+
+    int style = SolidStroke;
+    if (arrow->arrowStyle() == "dashed" || arrow->arrowStyle() == "troops") style = DashedStroke;
+    else if (arrow->arrowStyle() == "dotted") style = DottedStroke;
+
+    // Revealed arc length; the line stops inside the arrowhead so its end
+    // doesn't show at the tip
+    const double reveal = progress * path.length();
+    double lineEnd = reveal;
+
+    QPolygonF head;
+    if (arrow->showArrowhead() && reveal > 0.0) {
+        // Direction over one head length, so a short final segment of the
+        // polyline doesn't swing the head around
+        const double headLength = qMax(10.0, width * 3.5) / worldScale;
+        const QPointF tip = pointAtLength(path, reveal);
+        const QPointF back = pointAtLength(path, reveal - headLength);
+        QPointF dir = tip - back;
+        const double len = std::hypot(dir.x(), dir.y());
+        if (len > 0.0) {
+            dir /= len;
+            const QPointF normal(-dir.y(), dir.x());
+            const QPointF base = tip - dir * headLength;
+            const double halfWidth = headLength * 0.5;
+            head << tip << base + normal * halfWidth << base - normal * halfWidth;
+            head.translate(-std::floor(tip.x()), 0.0);
+            lineEnd = qMax(0.0, reveal - headLength * 0.7);
+        }
+    }
+
+    QVector<QPolygonF> lines;
+    bool dashed = false;
+    if (style != SolidStroke) {
+        // Cut from the cached pattern: whole dashes before the reveal, the
+        // one it falls in trimmed. Dots are dashes of almost no length
+        // drawn with round caps.
+        const double on = (style == DottedStroke ? 0.01 : DASH_ON) * width / worldScale;
+        const double off = (style == DottedStroke ? DOT_OFF : DASH_OFF) * width / worldScale;
+        const QVector<Dash>& pattern = dashes(path, on, off);
+        dashed = !pattern.isEmpty();
+        for (const Dash& dash : pattern) {
+            if (dash.start > lineEnd) break;
+            if (dash.end <= lineEnd) {
+                lines.append(dash.points);
+            } else {
+                QPolygonF partial;
+                appendSpan(path, dash.start, lineEnd, partial);
+                lines.append(partial);
+            }
+        }
+    }
+    if (!dashed) {
+        // Solid, or too many dashes to cache at this zoom: the pen dashes it
+        QPolygonF line;
+        appendSpan(path, 0.0, lineEnd, line);
+        lines.append(line);
+    }
+    if (wraps) {
+        QVector<QPolygonF> wrapped;
+        for (const QPolygonF& line : lines) {
+            appendWrapped(line, wrapped);
+        }
+        lines = wrapped;
+    }
+
+    // Troop movements: a wide translucent band under the line
+    if (arrow->arrowStyle() == "troops") {
+        QColor band = color;
+        band.setAlphaF(color.alphaF() * 0.35);
+        QPolygonF line;
+        appendSpan(path, 0.0, lineEnd, line);
+        QVector<QPolygonF> bandLines;
+        if (wraps) appendWrapped(line, bandLines);
+        else bandLines.append(line);
+        strokes.append({band.rgba(), width * 3.0, SolidStroke, true, bandLines, QPolygonF()});
+    }
+    strokes.append({color.rgba(), width, style, dashed || style == SolidStroke, lines, head});
+}
+
+void OverlayRenderer::drawStrokes(QPainter* painter, const QVector<Stroke>& strokes,
+                                  const QTransform& worldToScreen) const {
+    // Runs of equal pens become one path and one draw call. Strokes keep
+    // the overlay list order, so a later arrow always draws over an earlier
+    // one and a band stays under its own line.
+    for (int start = 0; start < strokes.size();) {
+        const Stroke& first = strokes[start];
+        int end = start + 1;
+        while (end < strokes.size() && strokes[end].color == first.color &&
+               strokes[end].width == first.width && strokes[end].style == first.style &&
+               strokes[end].solidPen == first.solidPen) {
+            end++;
+        }
+
+        QPainterPath lines;
+        QPainterPath heads;
+        for (int i = start; i < end; ++i) {
+            for (const QPolygonF& line : strokes[i].lines) {
+                lines.addPolygon(worldToScreen.map(line));
+            }
+            if (!strokes[i].head.isEmpty()) {
+                heads.addPolygon(worldToScreen.map(strokes[i].head));
+                heads.closeSubpath();
+            }
+        }
+
+        // Cached dashes are separate subpaths already and stroke solid
+        const QColor color = QColor::fromRgba(first.color);
+        QPen pen(color, first.width, Qt::SolidLine,
+                 first.style == DottedStroke ? Qt::RoundCap : Qt::FlatCap, Qt::RoundJoin);
+        if (!first.solidPen) {
+            pen.setStyle(first.style == DottedStroke ? Qt::DotLine : Qt::DashLine);
+        }
+        painter->strokePath(lines, pen);
+        if (!heads.isEmpty()) {
+            painter->fillPath(heads, color);
+        }
+        start = end;
+    }
+}
+
+LabelAtlas::Slot OverlayRenderer::iconSlot(const MarkerOverlay* marker, const QSize& pixels) {
+    const QString key = QString("%1|%2x%3|%4").arg(marker->iconUrl()).arg(pixels.width())
+                            .arg(pixels.height()).arg(marker->color().rgba());
+    auto it = m_iconSlots.constFind(key);
+    if (it != m_iconSlots.constEnd()) return it.value();
+
+    LabelAtlas::Slot slot = m_iconAtlas.allocate(pixels);
+    QPainter painter(&m_iconAtlas.page(slot.page));
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawImage(slot.rect.topLeft(), renderIcon(marker, pixels));
+    m_iconSlots.insert(key, slot);
+    return slot;
+}
+
+QImage OverlayRenderer::renderIcon(const MarkerOverlay* marker, const QSize& pixels) const {
+    QImage icon(pixels, QImage::Format_ARGB32_Premultiplied);
+    icon.fill(Qt::transparent);
+
+    QString path = marker->iconUrl();
+    if (path.startsWith("qrc:")) path = path.mid(3);
+    else if (path.startsWith("file://")) path = path.mid(7);
+
+    QImageReader reader(path);
+    reader.setScaledSize(pixels);
+    QImage loaded = reader.read();
+
+    QPainter painter(&icon);
+    painter.setRenderHint(QPainter::Antialiasing);
+    if (!loaded.isNull()) {
+        painter.drawImage(QRect(QPoint(0, 0), pixels), loaded);
+    } else {
+        // No image plugin for the icon: the default pin as a path
+        QPainterPath pin;
+        const double w = pixels.width();
+        const double h = pixels.height();
+        pin.moveTo(w / 2.0, h);
+        pin.cubicTo(w * 0.5, h * 0.8, w * 0.2, h * 0.55, w * 0.2, h * 0.38);
+        pin.arcTo(QRectF(w * 0.2, h * 0.08, w * 0.6, h * 0.6), 180, -180);
+        pin.cubicTo(w * 0.8, h * 0.55, w * 0.5, h * 0.8, w / 2.0, h);
+        pin.addEllipse(QPointF(w / 2.0, h * 0.38), w * 0.1, w * 0.1);
+        pin.setFillRule(Qt::OddEvenFill);
+        painter.fillPath(pin, Qt::white);
+    }
+
+    // Tint to the marker colour, keeping the icon's shape
+    painter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+    painter.fillRect(icon.rect(), marker->color());
+    return icon;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <QColor>
+#include <QHash>
+#include <QPolygonF>
+#include <QTransform>
+#include <QSizeF>
+#include <QString>
+#include <QVector>
+#include "labelatlas.h"
+#include "labelengine.h"
+
+class QPainter;
+class MapCamera;
+class Overlay;
+class ArrowOverlay;
+class MarkerOverlay;
+class TextOverlay;
+
+// Draws the timeline overlays (arrows, markers, text) for MapRenderer.
+// Arrow curves are flattened once per shape and zoom level into world-space
+// polylines with an arc-length table, so the animated reveal is a binary
+// search and a prefix, and projecting is one transform. Geodesic arrows are
+// unwrapped across the antimeridian and cut into pieces on each side of it
+// when drawn. Dashes are cut from the same table instead of by the stroker
+// each frame. Consecutive strokes sharing colour, width and style are merged
+// into one path. Marker icons are rasterised once into an atlas and text
+// goes through a LabelEngine, so every overlay is a blit or part of a
+// batched path.
+class OverlayRenderer {
+public:
+    void render(QPainter* painter, const QVector<Overlay*>& overlays, double timeMs,
+                const MapCamera& camera, const QSizeF& viewSize, qreal pixelRatio);
+
+private:
+    // One dash of the cached pattern, as arc-length span and polyline
+    struct Dash {
+        double start;
+        double end;
+        QPolygonF points;
+    };
+
+    // Flattened curve in world coordinates (MapCamera::geoToWorld) with the
+    // arc length up to each vertex. x continues past 0 and 1 where the curve
+    // crosses the antimeridian. Rebuilt only when the arrow's shape or the
+    // integer zoom changes; the dashes only when the on-screen dash length
+    // does.
+    struct ArrowPath {
+        size_t key = 0;           // Shape and zoom bucket
+        QPolygonF points;
+        QVector<double> lengths;  // lengths[i]: arc length from points[0] to points[i]
+        QRectF bounds;
+        quint64 lastUse = 0;
+
+        double dashOn = 0.0;      // Pattern the dashes were cut with, world units
+        double dashOff = 0.0;
+        QVector<Dash> dashes;
+
+        double length() const { return lengths.isEmpty() ? 0.0 : lengths.last(); }
+    };
+
+    enum StrokeStyle { SolidStroke, DashedStroke, DottedStroke };
+
+    struct Stroke {
+        QRgb color;
+        double width;
+        int style;
+        bool solidPen;             // Lines are solid or already cut into dashes
+        QVector<QPolygonF> lines;  // World coordinates
+        QPolygonF head;            // World coordinates, empty when there is no arrowhead
+    };
+
+    struct Icon {
+        LabelAtlas::Slot slot;
+        QSizeF size;
+        double opacity;
+        QPointF anchor;  // Bottom centre of the pin
+    };
+
+    // Where this frame's arrows are flattened and culled
+    struct ArrowView {
+        QRectF visibleWorld;
+        double worldScale;
+        int zoomBucket;
+        double tolerance;  // World units, FLATTEN_TOLERANCE_PX at the bucket's deepest zoom
+    };
+
+    ArrowPath& arrowPath(const ArrowOverlay* arrow, const ArrowView& view);
+    static size_t arrowKey(const ArrowOverlay* arrow);
+    static QPointF worldAt(const ArrowOverlay* arrow, double t, double referenceX);
+    static void flatten(const ArrowOverlay* arrow, double t0, const QPointF& p0, double t1,
+                        const QPointF& p1, double tolerance, int depth, QVector<QPointF>& out);
+    static void appendWrapped(const QPolygonF& line, QVector<QPolygonF>& out);
+    static QPointF pointAtLength(const ArrowPath& path, double s);
+    static void appendSpan(const ArrowPath& path, double from, double to, QPolygonF& out);
+    static const QVector<Dash>& dashes(ArrowPath& path, double on, double off);
+
+    void addArrow(const ArrowOverlay* arrow, double timeMs, const ArrowView& view,
+                  QVector<Stroke>& strokes);
+    void drawStrokes(QPainter* painter, const QVector<Stroke>& strokes, const QTransform& worldToScreen) const;
+
+    LabelAtlas::Slot iconSlot(const MarkerOverlay* marker, const QSize& pixels);
+    QImage renderIcon(const MarkerOverlay* marker, const QSize& pixels) const;
+
+    QHash<QString, ArrowPath> m_arrowPaths;  // By overlay id
+    quint64 m_frame = 0;
+
+    LabelAtlas m_iconAtlas;
+    QHash<QString, LabelAtlas::Slot> m_iconSlots;
+    qreal m_pixelRatio = 1.0;
+
+    LabelEngine m_text;
+
+    static constexpr int FLATTEN_SEGMENTS = 8;       // Uniform split before adaptive refinement
+    static constexpr int FLATTEN_MAX_DEPTH = 10;
+    static constexpr double FLATTEN_TOLERANCE_PX = 0.25; // Curve to polyline distance on screen
+    static constexpr int PATH_CACHE_SLACK = 64;        // Unused paths kept before pruning
+    static constexpr double MARKER_ICON_SIZE = 32.0;
+    // Dash patterns in stroke widths, as Qt's DashLine and DotLine
+    static constexpr double DASH_ON = 4.0;
+    static constexpr double DASH_OFF = 2.0;
+    static constexpr double DOT_OFF = 2.0;
+    static constexpr int MAX_DASHES = 4096;           // Per arrow; beyond that the pen dashes
+    static constexpr double CULL_MARGIN = 64.0;
+    static constexpr double MAX_LATITUDE = 85.05112878;  // Edge of the Mercator world
+};
@@ -0,0 +1,136 @@
+#include "polygonclip.h"
+#include "geodesic.h"
+#include <cmath>
+
+namespace PolygonClip {
+
+namespace {
+
+constexpr double MAX_MERCATOR_LAT = 85.05112878;
+
+enum Edge { Left, Right, Top, Bottom };
+
+bool inside(const QPointF& p, Edge edge, double value) {
+    switch (edge) {
+    case Left: return p.x() >= value;
+    case Right: return p.x() <= value;
+    case Top: return p.y() >= value;
+    case Bottom: return p.y() <= value;
+    }
+    return true;
+}
+
+QPointF intersect(const QPointF& a, const QPointF& b, Edge edge, double value) {
+    if (edge == Left || edge == Right) {
+        const double f = (value - a.x()) / (b.x() - a.x());
+        return QPointF(value, a.y() + (b.y() - a.y()) * f);
+    }
+    const double f = (value - a.y()) / (b.y() - a.y());
+    return QPointF(a.x() + (b.x() - a.x()) * f, value);
+}
+
+// One Sutherland-Hodgman stage: keep the part of the polygon on the inner
+// side of a single edge
+QPolygonF clipEdge(const QPolygonF& polygon, Edge edge, double value) {
+    QPolygonF out;
+    if (polygon.isEmpty()) return out;
+    out.reserve(polygon.size() + 4);
+
+    QPointF previous = polygon.last();
+    bool previousInside = inside(previous, edge, value);
+    for (const QPointF& current : polygon) {
+        const bool currentInside = inside(current, edge, value);
+        if (currentInside != previousInside) {
+            out.append(intersect(previous, current, edge, value));
+        }
+        if (currentInside) {
+            out.append(current);
+        }
+        previous = current;
+        previousInside = currentInside;
+    }
+    return out;
+}
+
+// Drops repeated vertices and the out-and-back spikes that clipping leaves
+// where a ring ran along the clip edge, so borders don't draw over them
+QPolygonF tidy(const QPolygonF& polygon) {
+    QPolygonF out;
+    out.reserve(polygon.size());
+    for (const QPointF& p : polygon) {
+        if (!out.isEmpty() && out.last() == p) continue;
+        if (out.size() >= 2 && out[out.size() - 2] == p) {
+            out.removeLast();
+            continue;
+        }
+        out.append(p);
+    }
+    while (out.size() > 1 && out.first() == out.last()) out.removeLast();
+    return out;
+}
+
+}
+
+QPolygonF clip(const QPolygonF& polygon, const QRectF& rect) {
+    QPolygonF out = clipEdge(polygon, Left, rect.left());
+    out = clipEdge(out, Right, rect.right());
+    out = clipEdge(out, Top, rect.top());
+    out = clipEdge(out, Bottom, rect.bottom());
+    return out;
+}
+
+QVector<QPolygonF> splitGeoRing(const QPolygonF& ring) {
+    if (ring.size() < 3) return {ring};
+
+    // (lon, lat) with each longitude unwrapped against the previous one, so
+    // the ring is continuous and a crossing shows as x past +-180
+    QPolygonF unwrapped;
+    unwrapped.reserve(ring.size() + 3);
+    double lon = ring.first().y();
+    double latSum = 0.0;
+    for (const QPointF& p : ring) {
+        lon = Geodesic::unwrapLongitude(p.y(), lon);
+        unwrapped.append(QPointF(lon, p.x()));
+        latSum += p.x();
+    }
+
+    // A ring that comes back a whole turn away from where it started goes
+    // around a pole; close it along the pole's latitude
+    const double closeLon = Geodesic::unwrapLongitude(ring.first().y(), lon);
+    if (std::abs(closeLon - unwrapped.first().x()) > 180.0) {
+        const double poleLat = latSum >= 0.0 ? 90.0 : -90.0;
+        if (unwrapped.last() != QPointF(closeLon, ring.first().x())) {
+            unwrapped.append(QPointF(closeLon, ring.first().x()));
+        }
+        unwrapped.append(QPointF(closeLon, poleLat));
+        unwrapped.append(QPointF(unwrapped.first().x(), poleLat));
+    }
+
+    const QRectF box = unwrapped.boundingRect();
+    if (box.left() >= -180.0 && box.right() <= 180.0 &&
+        box.top() >= -MAX_MERCATOR_LAT && box.bottom() <= MAX_MERCATOR_LAT) {
+        return {ring};
+    }
+
+    // Clip against each copy of the world the ring reaches into, shifting
+    // the pieces back into [-180, 180]
+    QVector<QPolygonF> parts;
+    const int first = static_cast<int>(std::floor((box.left() + 180.0) / 360.0));
+    const int last = static_cast<int>(std::ceil((box.right() + 180.0) / 360.0)) - 1;
+    for (int copy = first; copy <= last; ++copy) {
+        const double west = -180.0 + copy * 360.0;
+        const QRectF window(west, -MAX_MERCATOR_LAT, 360.0, 2.0 * MAX_MERCATOR_LAT);
+        const QPolygonF piece = tidy(clip(unwrapped, window));
+        if (piece.size() < 3) continue;
+
+        QPolygonF part;
+        part.reserve(piece.size());
+        for (const QPointF& p : piece) {
+            part.append(QPointF(p.y(), p.x() - copy * 360.0));
+        }
+        parts.append(part);
+    }
+    return parts;
+}
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QPolygonF>
+#include <QRectF>
+#include <QVector>
+
+// Polygon clipping for drawing. Geographic rings are prepared once so they
+// project cleanly to Web Mercator; screen polygons are clipped per frame so
+// QPainter only rasterises edges near the viewport.
+namespace PolygonClip {
+
+// Sutherland-Hodgman clip of a polygon to a rectangle. The result has the
+// same orientation; a polygon entirely outside comes back empty.
+QPolygonF clip(const QPolygonF& polygon, const QRectF& rect);
+
+// Splits a (lat, lon) ring into parts that each lie within [-180, 180]
+// longitude, cutting it where it crosses the antimeridian, and clips them
+// to the Mercator latitude limit. A ring around a pole is closed along the
+// pole first. Rings that need neither come back unchanged.
+QVector<QPolygonF> splitGeoRing(const QPolygonF& ring);
+
+}
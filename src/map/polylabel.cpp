@@ -0,0 +1,134 @@
+#include "polylabel.h"
+#include <QRectF>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <vector>
+
+namespace PolyLabel {
+
+namespace {
+
+// Distance from p to the ring outline, negative when p is outside
+double signedDistance(const QPolygonF& ring, const QPointF& p) {
+    bool inside = false;
+    double minDistSq = std::numeric_limits<double>::infinity();
+
+    const int n = ring.size();
+    for (int i = 0, j = n - 1; i < n; j = i++) {
+        const QPointF& a = ring[i];
+        const QPointF& b = ring[j];
+
+        if ((a.y() > p.y()) != (b.y() > p.y()) &&
+            p.x() < (b.x() - a.x()) * (p.y() - a.y()) / (b.y() - a.y()) + a.x()) {
+            inside = !inside;
+        }
+
+        // Squared distance to segment ab
+        double x = a.x();
+        double y = a.y();
+        double dx = b.x() - x;
+        double dy = b.y() - y;
+        if (dx != 0 || dy != 0) {
+            double t = ((p.x() - x) * dx + (p.y() - y) * dy) / (dx * dx + dy * dy);
+            if (t > 1) {
+                x = b.x();
+                y = b.y();
+            } else if (t > 0) {
+                x += dx * t;
+                y += dy * t;
+            }
+        }
+        dx = p.x() - x;
+        dy = p.y() - y;
+        minDistSq = std::min(minDistSq, dx * dx + dy * dy);
+    }
+
+    return (inside ? 1.0 : -1.0) * std::sqrt(minDistSq);
+}
+
+struct Cell {
+    QPointF center;
+    double half;      // Half the cell size
+    double distance;  // From the center to the ring
+    double potential; // Best distance any point in the cell can have
+
+    Cell(const QPointF& c, double h, const QPolygonF& ring)
+        : center(c), half(h), distance(signedDistance(ring, c)),
+          potential(distance + h * M_SQRT2) {}
+
+    bool operator<(const Cell& other) const { return potential < other.potential; }
+};
+
+}
+
+double signedArea(const QPolygonF& ring) {
+    double sum = 0.0;
+    const int n = ring.size();
+    for (int i = 0, j = n - 1; i < n; j = i++) {
+        sum += ring[j].x() * ring[i].y() - ring[i].x() * ring[j].y();
+    }
+    return sum / 2.0;
+}
+
+QPointF centroid(const QPolygonF& ring) {
+    if (ring.isEmpty()) return QPointF();
+
+    double area = 0.0;
+    double cx = 0.0;
+    double cy = 0.0;
+    const int n = ring.size();
+    for (int i = 0, j = n - 1; i < n; j = i++) {
+        double cross = ring[j].x() * ring[i].y() - ring[i].x() * ring[j].y();
+        area += cross;
+        cx += (ring[j].x() + ring[i].x()) * cross;
+        cy += (ring[j].y() + ring[i].y()) * cross;
+    }
+
+    if (std::abs(area) < 1e-12) {
+        QPointF mean;
+        for (const QPointF& p : ring) mean += p;
+        return mean / n;
+    }
+    return QPointF(cx / (3.0 * area), cy / (3.0 * area));
+}
+
+QPointF poleOfInaccessibility(const QPolygonF& ring, double precision) {
+    const QRectF bounds = ring.boundingRect();
+    const double cellSize = std::min(bounds.width(), bounds.height());
+    if (ring.size() < 3 || cellSize <= 0) return bounds.center();
+
+    std::priority_queue<Cell> queue;
+    const double half = cellSize / 2.0;
+    for (double x = bounds.left(); x < bounds.right(); x += cellSize) {
+        for (double y = bounds.top(); y < bounds.bottom(); y += cellSize) {
+            queue.push(Cell(QPointF(x + half, y + half), half, ring));
+        }
+    }
+
+    // Start from the centroid, or the bbox centre if that is better
+    Cell best(centroid(ring), 0, ring);
+    Cell boxCell(bounds.center(), 0, ring);
+    if (boxCell.distance > best.distance) best = boxCell;
+
+    while (!queue.empty()) {
+        Cell cell = queue.top();
+        queue.pop();
+
+        if (cell.distance > best.distance) best = cell;
+
+        // No point in this cell can beat the best by more than precision
+        if (cell.potential - best.distance <= precision) continue;
+
+        const double h = cell.half / 2.0;
+        queue.push(Cell(cell.center + QPointF(-h, -h), h, ring));
+        queue.push(Cell(cell.center + QPointF(h, -h), h, ring));
+        queue.push(Cell(cell.center + QPointF(-h, h), h, ring));
+        queue.push(Cell(cell.center + QPointF(h, h), h, ring));
+    }
+
+    return best.center;
+}
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QPointF>
+#include <QPolygonF>
+
+// Planar polygon measures used to anchor labels. Coordinates are whatever
+// the caller projected into; GeoJsonParser passes Web Mercator degrees so
+// results match what the map shows.
+namespace PolyLabel {
+
+// Signed area (positive for counter-clockwise rings)
+double signedArea(const QPolygonF& ring);
+
+// Area-weighted centroid of the ring; the vertex mean for degenerate rings
+QPointF centroid(const QPolygonF& ring);
+
+// Point inside the ring farthest from its edges (pole of inaccessibility),
+// found to within precision by quadtree refinement. Unlike the centroid it
+// always lies inside, even for crescents and U-shapes.
+QPointF poleOfInaccessibility(const QPolygonF& ring, double precision);
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QHash>
+#include <QColor>
+#include <QPair>
+#include <QVector>
+#include <QJsonArray>
+#include "geojsonparser.h"
+#include "../animation/timelinesnapshot.h"
+#include "../animation/regiontrack.h"
+#include "../animation/geooverlay.h"
+
+// Copy of everything MapRenderer draws over the timeline, taken on the GUI
+// thread. An offscreen renderer applies it on a worker thread and renders any
+// frame from it without touching the live models.
+struct RenderSnapshot {
+    TimelineSnapshot timeline;        // Camera per animation time
+    QVector<RegionTrack> regionTracks;
+    QVector<GeoOverlay> geoOverlays;
+    QJsonArray overlays;              // Legacy overlays, rebuilt from JSON by the worker
+    QVector<GeoFeature> features;     // Shares GeoJsonParser's data; a reload detaches it
+
+    int width = 0;
+    int height = 0;
+    double totalDuration = 0.0;
+    int tileSource = 0;
+
+    bool showCountryLabels = false;
+    bool showRegionLabels = false;
+    bool showCityLabels = false;
+    bool showCountryBorders = false;
+    bool showCityMarkers = false;
+    bool shadeNonHighlighted = false;
+    double nonHighlightedOpacity = 0.3;
+    double labelOpacity = 1.0;
+
+    QHash<QString, QPair<QColor, QColor>> highlights;  // Region code -> fill, border
+    QString selectedFeatureCode;
+    QString selectedFeatureName;
+    QString selectedFeatureType;
+};
@@ -16,21 +16,31 @@ TileCache::TileCache(int maxMemoryMB, QObject* parent)
 
 bool TileCache::contains(int source, int x, int y, int zoom) const {
     QString key = tileKey(source, x, y, zoom);
+    QMutexLocker locker(&m_memoryMutex);
     return m_memoryCache.contains(key);
 }
 
+bool TileCache::isCached(int source, int x, int y, int zoom) const {
+    if (contains(source, x, y, zoom)) return true;
+    return m_diskCacheEnabled && QFile::exists(diskPath(source, x, y, zoom));
+}
+
 QImage TileCache::get(int source, int x, int y, int zoom) {
     QString key = tileKey(source, x, y, zoom);
 
     // Try memory cache first
-    if (m_memoryCache.contains(key)) {
-        return *m_memoryCache.object(key);
+    {
+        QMutexLocker locker(&m_memoryMutex);
+        if (const QImage* cached = m_memoryCache.object(key)) {
+            return *cached;
+        }
     }
 
     // Try disk cache
     QImage image;
     if (m_diskCacheEnabled && loadFromDisk(source, x, y, zoom, image)) {
         // Add to memory cache
+        QMutexLocker locker(&m_memoryMutex);
         m_memoryCache.insert(key, new QImage(image), 1);
         return image;
     }
@@ -42,7 +52,10 @@ void TileCache::insert(int source, int x, int y, int zoom, const QImage& image)
     QString key = tileKey(source, x, y, zoom);
 
     // Add to memory cache
-    m_memoryCache.insert(key, new QImage(image), 1);
+    {
+        QMutexLocker locker(&m_memoryMutex);
+        m_memoryCache.insert(key, new QImage(image), 1);
+    }
     emit memoryUsageChanged();
 
     // Save to disk cache
@@ -52,7 +65,10 @@ void TileCache::insert(int source, int x, int y, int zoom, const QImage& image)
 }
 
 void TileCache::clear() {
-    m_memoryCache.clear();
+    {
+        QMutexLocker locker(&m_memoryMutex);
+        m_memoryCache.clear();
+    }
     emit memoryUsageChanged();
 }
 
@@ -70,7 +86,10 @@ void TileCache::clearDiskCache() {
 
 void TileCache::setMaxMemorySize(int megabytes) {
     m_maxMemoryMB = megabytes;
-    m_memoryCache.setMaxCost(megabytes * 4);
+    {
+        QMutexLocker locker(&m_memoryMutex);
+        m_memoryCache.setMaxCost(megabytes * 4);
+    }
     emit memoryUsageChanged();
 }
 
@@ -102,6 +121,7 @@ void TileCache::enableDiskCache(const QString& path) {
 }
 
 int TileCache::memoryUsageMB() const {
+    QMutexLocker locker(&m_memoryMutex);
     return m_memoryCache.totalCost() / 4;
 }
 
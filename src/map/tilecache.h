@@ -18,6 +18,7 @@ public:
     explicit TileCache(int maxMemoryMB = 256, QObject* parent = nullptr);
 
     bool contains(int source, int x, int y, int zoom) const;
+    bool isCached(int source, int x, int y, int zoom) const;  // Memory or disk
     QImage get(int source, int x, int y, int zoom);
     void insert(int source, int x, int y, int zoom, const QImage& image);
 
@@ -45,6 +46,7 @@ private:
     void updateDiskUsageCache();
 
     QCache<QString, QImage> m_memoryCache;
+    mutable QMutex m_memoryMutex;   // Frame buffer workers read tiles off the GUI thread
     QString m_diskCachePath;
     bool m_diskCacheEnabled = false;
     int m_maxMemoryMB = 256;
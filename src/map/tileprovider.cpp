@@ -18,6 +18,10 @@ TileProvider::TileProvider(QObject* parent)
 }
 
 void TileProvider::requestTile(int x, int y, int zoom) {
+    if (m_offline) {
+        return;
+    }
+
     QString key = tileKey(x, y, zoom);
 
     // Don't request same tile twice
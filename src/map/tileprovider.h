@@ -32,6 +32,10 @@ public:
     bool isLoading() const { return m_pendingRequests > 0; }
     int pendingCount() const { return m_pendingRequests; }
 
+    // Offline: never hit the network, render from cached tiles only
+    bool isOffline() const { return m_offline; }
+    void setOffline(bool offline) { m_offline = offline; }
+
 signals:
     void tileReady(int x, int y, int zoom, const QImage& image);
     void tileFailed(int x, int y, int zoom, const QString& error);
@@ -49,6 +53,7 @@ private:
     QNetworkAccessManager* m_networkManager;
     TileSource m_currentSource = TileSource::EsriSatellite;
     int m_pendingRequests = 0;
+    bool m_offline = false;
     QSet<QString> m_requestedTiles;
 
     static const QHash<TileSource, QString> s_urlTemplates;
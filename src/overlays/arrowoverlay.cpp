@@ -1,4 +1,5 @@
 #include "arrowoverlay.h"
+#include "../map/geodesic.h"
 #include <QtMath>
 
 ArrowOverlay::ArrowOverlay(QObject* parent)
@@ -97,6 +98,14 @@ void ArrowOverlay::setShowArrowhead(bool show) {
     }
 }
 
+void ArrowOverlay::setPathType(const QString& type) {
+    if (m_pathType != type) {
+        m_pathType = type;
+        emit pathChanged();
+        emit modified();
+    }
+}
+
 void ArrowOverlay::addControlPoint(double lat, double lon) {
     m_controlPoints.append({lat, lon});
     emit controlPointsChanged();
@@ -160,6 +169,18 @@ double ArrowOverlay::animationProgress(double timeMs) const {
 QPointF ArrowOverlay::pointAtT(double t) const {
     t = qBound(0.0, t, 1.0);
 
+    if (isGeodesic()) {
+        QVector<QPointF> control;
+        control.reserve(m_controlPoints.size() + 2);
+        control.append(QPointF(m_startLat, m_startLon));
+        for (const auto& cp : m_controlPoints) {
+            control.append(QPointF(cp.latitude, cp.longitude));
+        }
+        control.append(QPointF(m_endLat, m_endLon));
+        return m_pathType == "rhumb" ? Geodesic::rhumbBezier(control, t)
+                                     : Geodesic::greatCircleBezier(control, t);
+    }
+
     if (m_controlPoints.isEmpty()) {
         // Simple linear interpolation
         double lat = m_startLat + (m_endLat - m_startLat) * t;
@@ -203,6 +224,7 @@ QJsonObject ArrowOverlay::toJson() const {
     obj["animationDuration"] = m_animationDuration;
     obj["arrowStyle"] = m_arrowStyle;
     obj["showArrowhead"] = m_showArrowhead;
+    obj["pathType"] = m_pathType;
 
     QJsonArray cpArray;
     for (const auto& cp : m_controlPoints) {
@@ -226,6 +248,7 @@ void ArrowOverlay::fromJson(const QJsonObject& obj) {
     m_animationDuration = obj["animationDuration"].toDouble(2000.0);
     m_arrowStyle = obj["arrowStyle"].toString("solid");
     m_showArrowhead = obj["showArrowhead"].toBool(true);
+    m_pathType = obj["pathType"].toString("straight");
 
     m_controlPoints.clear();
     QJsonArray cpArray = obj["controlPoints"].toArray();
@@ -36,6 +36,7 @@ class ArrowOverlay : public Overlay {
     Q_PROPERTY(double animationDuration READ animationDuration WRITE setAnimationDuration NOTIFY animationDurationChanged)
     Q_PROPERTY(QString arrowStyle READ arrowStyle WRITE setArrowStyle NOTIFY arrowStyleChanged)
     Q_PROPERTY(bool showArrowhead READ showArrowhead WRITE setShowArrowhead NOTIFY showArrowheadChanged)
+    Q_PROPERTY(QString pathType READ pathType WRITE setPathType NOTIFY pathChanged)
 
 public:
     explicit ArrowOverlay(QObject* parent = nullptr);
@@ -71,6 +72,13 @@ public:
     bool showArrowhead() const { return m_showArrowhead; }
     void setShowArrowhead(bool show);
 
+    // How the route between the points is interpolated: "straight" in plain
+    // lat/lon, "greatCircle" along the shortest route on the globe, "rhumb"
+    // at constant compass bearing. Geodesic routes cross the antimeridian.
+    QString pathType() const { return m_pathType; }
+    void setPathType(const QString& type);
+    bool isGeodesic() const { return m_pathType != "straight"; }
+
     // Bezier control points for curved arrows
     Q_INVOKABLE void addControlPoint(double lat, double lon);
     Q_INVOKABLE void removeControlPoint(int index);
@@ -78,11 +86,13 @@ public:
     Q_INVOKABLE QVariantList controlPoints() const;
     Q_INVOKABLE void clearControlPoints();
     Q_INVOKABLE int controlPointCount() const { return m_controlPoints.size(); }
+    const QVector<BezierControlPoint>& bezierPoints() const { return m_controlPoints; }
 
     // Get animation progress at specific time (0.0 to 1.0)
     double animationProgress(double timeMs) const;
 
-    // Get point along bezier curve at parameter t (0.0 to 1.0)
+    // Get point along bezier curve at parameter t (0.0 to 1.0); longitudes
+    // of geodesic paths are normalised to [-180, 180]
     QPointF pointAtT(double t) const;
 
     QJsonObject toJson() const override;
@@ -111,5 +121,6 @@ private:
     double m_animationDuration = 2000.0;  // ms for full animation
     QString m_arrowStyle = "solid";
     bool m_showArrowhead = true;
+    QString m_pathType = "straight";
     QVector<BezierControlPoint> m_controlPoints;
 };
@@ -4,6 +4,14 @@
 OverlayManager::OverlayManager(QObject* parent)
     : QAbstractListModel(parent)
 {
+    // Any structural or content change outdates the active-window index
+    auto staleIndex = [this]() { m_activeIndexDirty = true; };
+    connect(this, &OverlayManager::dataModified, this, staleIndex);
+    connect(this, &QAbstractListModel::dataChanged, this, staleIndex);
+    connect(this, &QAbstractListModel::rowsInserted, this, staleIndex);
+    connect(this, &QAbstractListModel::rowsRemoved, this, staleIndex);
+    connect(this, &QAbstractListModel::rowsMoved, this, staleIndex);
+    connect(this, &QAbstractListModel::modelReset, this, staleIndex);
 }
 
 int OverlayManager::rowCount(const QModelIndex& parent) const {
@@ -247,11 +255,26 @@ RegionHighlight* OverlayManager::getRegionHighlight(int index) const {
     return nullptr;
 }
 
+const IntervalIndex& OverlayManager::activeIndex() const {
+    if (m_activeIndexDirty || m_activeIndex.itemCount() != static_cast<int>(m_overlays.size())) {
+        m_activeIndex.clear();
+        for (const auto& overlay : m_overlays) {
+            double end = overlay->endTime() >= 0 ? overlay->endTime() : IntervalIndex::OPEN_END;
+            m_activeIndex.add(overlay->startTime(), end);
+        }
+        m_activeIndex.build();
+        m_activeIndexDirty = false;
+    }
+    return m_activeIndex;
+}
+
 QVector<Overlay*> OverlayManager::visibleOverlaysAtTime(double timeMs) const {
     QVector<Overlay*> result;
-    for (const auto& overlay : m_overlays) {
+    activeIndex().query(timeMs, m_activeItems);
+    for (int index : m_activeItems) {
+        Overlay* overlay = m_overlays[index].get();
         if (overlay->isVisibleAtTime(timeMs)) {
-            result.append(overlay.get());
+            result.append(overlay);
         }
     }
     return result;
@@ -9,6 +9,7 @@
 #include "arrowoverlay.h"
 #include "textoverlay.h"
 #include "regionhighlight.h"
+#include "../animation/intervalindex.h"
 
 class OverlayManager : public QAbstractListModel {
     Q_OBJECT
@@ -57,7 +58,7 @@ public:
     Q_INVOKABLE TextOverlay* getText(int index) const;
     Q_INVOKABLE RegionHighlight* getRegionHighlight(int index) const;
 
-    // Visibility at time
+    // Visibility at time; only overlays whose window covers timeMs are checked
     QVector<Overlay*> visibleOverlaysAtTime(double timeMs) const;
 
     // Serialization
@@ -73,7 +74,11 @@ signals:
 
 private:
     void addOverlay(Overlay* overlay);
+    const IntervalIndex& activeIndex() const;
 
     std::vector<std::unique_ptr<Overlay>> m_overlays;
+    mutable IntervalIndex m_activeIndex;
+    mutable QVector<int> m_activeItems;
+    mutable bool m_activeIndexDirty = true;
     int m_selectedIndex = -1;
 };